@@ -0,0 +1,346 @@
+#!/bin/sh
+#
+# Generate SRC and PDM decimation coefficient tables with only the
+# coefficient sets needed for the given sample rates. Called by configure
+# for --with-src-rates and --with-dmic-rates, a size report of the kept and
+# dropped coefficients is printed to stdout.
+#
+# usage: gen-coef-tables.sh src <table.h> <in:out,...> <output.h>
+#        gen-coef-tables.sh dmic <table.h> <ioclk> <fs,...> <output.h>
+#
+
+usage()
+{
+	echo "usage: $0 src <table.h> <in:out,...> <output.h>" >&2
+	echo "       $0 dmic <table.h> <ioclk> <fs,...> <output.h>" >&2
+	exit 1
+}
+
+# SRC table - keep the stages used by the requested rate pairs, other
+# conversions point to the zero stage and are rejected by the SRC.
+gen_src()
+{
+	table=$1
+	rates=$2
+	output=$3
+
+	awk -v rates="$rates" -v dir="$(dirname "$table")" \
+		-v table="$(basename "$table")" '
+	function coef_bytes(name,	file, line, n, type) {
+		file = dir "/" hdr[name]
+		while ((getline line < file) > 0) {
+			if (line ~ /^const int(16|32)_t .*\[[0-9]+\]/) {
+				type = line
+				sub(/^const int/, "", type)
+				sub(/_t .*/, "", type)
+				n = line
+				sub(/^[^[]*\[/, "", n)
+				sub(/\].*/, "", n)
+				close(file)
+				return n * type / 8
+			}
+		}
+		close(file)
+		return 0
+	}
+
+	BEGIN {
+		npairs = split(rates, pairs, ",")
+		for (i = 1; i <= npairs; i++) {
+			if (split(pairs[i], r, ":") != 2) {
+				print "error: bad SRC rate pair " pairs[i] > "/dev/stderr"
+				exit 1
+			}
+			want[r[1] ":" r[2]] = 1
+		}
+	}
+
+	# coefficient headers, remember the stage each one defines
+	/^#include <sof\/audio\/coefficients\/src\/src_/ {
+		name = $2
+		sub(/^<sof\/audio\/coefficients\/src\//, "", name)
+		sub(/>$/, "", name)
+		file = name
+		sub(/(std|tiny)_/, "", name)
+		sub(/\.h$/, "", name)
+		hdr[name] = file
+		nhdr++
+		hdrs[nhdr] = name
+		next
+	}
+
+	# sample rate lists
+	/^int src_(in|out)_fs\[/ {
+		fs = ($0 ~ /src_in_fs/) ? "in" : "out"
+	}
+	fs != "" {
+		body = body $0 "\n"
+		line = $0
+		sub(/^.*=/, "", line)
+		gsub(/[{};]/, " ", line)
+		n = split(line, v, /[ ,\t]+/)
+		for (i = 1; i <= n; i++) {
+			if (v[i] == "")
+				continue
+			if (fs == "in")
+				in_fs[nin++] = v[i]
+			else
+				out_fs[nout++] = v[i]
+		}
+		if ($0 ~ /}/)
+			fs = ""
+		next
+	}
+
+	# tables are [out][in], replace stages of unused pairs
+	/^struct src_stage \*src_table[12]/ {
+		k = 0
+		intable = 1
+		body = body $0 "\n"
+		next
+	}
+	intable {
+		line = $0
+		out = ""
+		while (match(line, /&src_int(16|32)_[0-9_]+/)) {
+			stage = substr(line, RSTART + 1, RLENGTH - 1)
+			out = out substr(line, 1, RSTART - 1) "&"
+			line = substr(line, RSTART + RLENGTH)
+			o = out_fs[int(k / nin)]
+			i = in_fs[k % nin]
+			k++
+			if (stage !~ /_[01]_[01]_0_0$/) {
+				if ((i ":" o) in want) {
+					used[stage] = 1
+					found[i ":" o] = 1
+				} else {
+					match(stage, /^src_int(16|32)_/)
+					stage = substr(stage, 1, RLENGTH) "0_0_0_0"
+				}
+			}
+			out = out stage
+		}
+		body = body out line "\n"
+		if ($0 ~ /^};/)
+			intable = 0
+		next
+	}
+
+	{ body = body $0 "\n" }
+
+	END {
+		for (p in want) {
+			split(p, r, ":")
+			if (r[1] == r[2])
+				continue
+			if (!(p in found)) {
+				print "error: SRC rate pair " p " is not supported by " table > "/dev/stderr"
+				exit 1
+			}
+		}
+
+		print "/* Generated by gen-coef-tables.sh from " table " for SRC rates"
+		print " * " rates
+		print " * Do not edit."
+		print " */"
+		print ""
+		print "/* SRC conversions */"
+		for (n = 1; n <= nhdr; n++) {
+			name = hdrs[n]
+			bytes = coef_bytes(name)
+			if (name in used) {
+				print "#include <sof/audio/coefficients/src/" hdr[name] ">"
+				kept += bytes
+			} else {
+				dropped += bytes
+				ndrop++
+				report = report sprintf("  dropped %-32s %6d bytes\n", name, bytes)
+			}
+		}
+		print ""
+		printf "%s", body
+
+		printf "SRC %s: kept %d bytes, dropped %d sets %d bytes\n%s", \
+			table, kept, ndrop, dropped, report > "/dev/stderr"
+	}
+	' "$table" > "$output.tmp" 2> "$output.log" || {
+		cat "$output.log" >&2
+		rm -f "$output.tmp" "$output.log"
+		exit 1
+	}
+
+	mv "$output.tmp" "$output"
+	cat "$output.log"
+	rm -f "$output.log"
+}
+
+# PDM decimation FIR list - keep for each DMIC rate and FIR decimation
+# factor the filter the DMIC driver would select, see find_modes() and
+# get_fir() in src/drivers/dmic.c.
+gen_dmic()
+{
+	table=$1
+	ioclk=$2
+	rates=$3
+	output=$4
+
+	awk -v rates="$rates" -v ioclk="$ioclk" -v dir="$(dirname "$table")" \
+		-v table="$(basename "$table")" '
+	# DMIC HW and driver constraints, keep in sync with dmic.c and dmic.h
+	BEGIN {
+		CIC_DECIM_MIN = 5
+		CIC_DECIM_MAX = 31
+		FIR_DECIM_MIN = 2
+		FIR_DECIM_MAX = 20
+		FIR_LENGTH_MAX = 250
+		FIR_PIPELINE_OVERHEAD = 5
+		PDM_CLK_MIN = 100000
+		DUTY_MIN = 20
+		DUTY_MAX = 80
+		MIN_OSR = 50
+		HIGH_RATE_MIN_FS = 64000
+		HIGH_RATE_OSR_MIN = 40
+	}
+
+	function filter_info(name,	file, line, n, v) {
+		file = dir "/" name ".h"
+		while ((getline line < file) > 0) {
+			if (line ~ /^const int32_t .*\[[0-9]+\]/) {
+				n = line
+				sub(/^[^[]*\[/, "", n)
+				sub(/\].*/, "", n)
+				bytes[name] = n * 4
+			}
+			if (line ~ /^struct pdm_decim /) {
+				getline line < file
+				split(line, v, /[ ,\t]+/)
+				factor[name] = v[2]
+				length_[name] = v[3]
+			}
+		}
+		close(file)
+	}
+
+	/^#include "pdm_decim_int32_/ {
+		next
+	}
+
+	/^struct pdm_decim \*fir_list/ {
+		inlist = 1
+		next
+	}
+	inlist && /&pdm_decim_/ {
+		name = $1
+		sub(/^&/, "", name)
+		sub(/,$/, "", name)
+		nfir++
+		fir[nfir] = name
+		filter_info(name)
+		next
+	}
+	inlist && /^};/ {
+		inlist = 0
+		next
+	}
+
+	END {
+		nrates = split(rates, fs, ",")
+		for (r = 1; r <= nrates; r++) {
+			osr_min = fs[r] >= HIGH_RATE_MIN_FS ? HIGH_RATE_OSR_MIN : MIN_OSR
+			fir_max = int(ioclk / fs[r] / 2) - FIR_PIPELINE_OVERHEAD
+			if (fir_max > FIR_LENGTH_MAX)
+				fir_max = FIR_LENGTH_MAX
+			clkdiv_max = int(ioclk / PDM_CLK_MIN)
+			nmodes = 0
+
+			for (clkdiv = CIC_DECIM_MIN; clkdiv <= clkdiv_max; clkdiv++) {
+				du_min = int(100 * int(clkdiv / 2) / clkdiv)
+				osr = int(int(ioclk / clkdiv) / fs[r])
+				if (osr < osr_min || du_min < DUTY_MIN ||
+					100 - du_min > DUTY_MAX)
+					continue
+
+				for (mfir = FIR_DECIM_MIN; mfir <= FIR_DECIM_MAX; mfir++) {
+					mcic = int(osr / mfir)
+					if (fs[r] * mfir * mcic * clkdiv != ioclk ||
+						mcic < CIC_DECIM_MIN || mcic > CIC_DECIM_MAX)
+						continue
+
+					nmodes++
+					for (n = 1; n <= nfir; n++) {
+						if (factor[fir[n]] == mfir &&
+							length_[fir[n]] <= fir_max) {
+							used[fir[n]] = 1
+							break
+						}
+					}
+				}
+			}
+
+			if (nmodes == 0) {
+				print "error: DMIC rate " fs[r] " is not possible with " ioclk " Hz clock" > "/dev/stderr"
+				exit 1
+			}
+		}
+
+		for (n = 1; n <= nfir; n++) {
+			if (fir[n] in used) {
+				keep[++nkeep] = fir[n]
+				kept += bytes[fir[n]]
+			} else {
+				dropped += bytes[fir[n]]
+				ndrop++
+				report = report sprintf("  dropped %-32s %6d bytes\n", fir[n], bytes[fir[n]])
+			}
+		}
+
+		if (nkeep == 0) {
+			print "error: no PDM decimation filter for DMIC rates " rates > "/dev/stderr"
+			exit 1
+		}
+
+		print "/* Generated by gen-coef-tables.sh from " table " for DMIC rates"
+		print " * " rates " with " ioclk " Hz IO clock"
+		print " * Do not edit."
+		print " */"
+		print ""
+		print "/* PDM decimation FIR filters */"
+		print ""
+		print "#include <sof/audio/coefficients/pdm_decim/pdm_decim_fir.h>"
+		for (n = 1; n <= nkeep; n++)
+			print "#include <sof/audio/coefficients/pdm_decim/" keep[n] ".h>"
+		print ""
+		print "#define DMIC_FIR_LIST_LENGTH " nkeep
+		print ""
+		print "struct pdm_decim *fir_list[DMIC_FIR_LIST_LENGTH] = {"
+		for (n = 1; n <= nkeep; n++)
+			print "\t&" keep[n] ","
+		print "};"
+
+		printf "DMIC %s: kept %d bytes, dropped %d sets %d bytes\n%s", \
+			table, kept, ndrop, dropped, report > "/dev/stderr"
+	}
+	' "$table" > "$output.tmp" 2> "$output.log" || {
+		cat "$output.log" >&2
+		rm -f "$output.tmp" "$output.log"
+		exit 1
+	}
+
+	mv "$output.tmp" "$output"
+	cat "$output.log"
+	rm -f "$output.log"
+}
+
+case "$1" in
+src)
+	[ $# -eq 4 ] || usage
+	gen_src "$2" "$3" "$4"
+	;;
+dmic)
+	[ $# -eq 5 ] || usage
+	gen_dmic "$2" "$3" "$4" "$5"
+	;;
+*)
+	usage
+	;;
+esac
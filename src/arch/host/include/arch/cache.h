@@ -34,6 +34,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#define DCACHE_LINE_SIZE	64
+
 static inline void dcache_writeback_region(void *addr, size_t size) {}
 static inline void dcache_invalidate_region(void *addr, size_t size) {}
 static inline void icache_invalidate_region(void *addr, size_t size) {}
@@ -36,11 +36,38 @@
 #include <errno.h>
 #include <pthread.h>
 
+/*
+ * Host locks are recursive mutexes so pipelines can run on several threads.
+ * Pipeline code can retake a lock it already holds, e.g. during XRUN
+ * recovery, so the mutex must be recursive.
+ */
 typedef struct {
+	pthread_mutex_t mutex;
 } spinlock_t;
 
-static inline void arch_spinlock_init(spinlock_t *lock) {}
-static inline void arch_spin_lock(spinlock_t *lock) {}
-static inline void arch_spin_unlock(spinlock_t *lock) {}
+static inline void arch_spinlock_init(spinlock_t *lock)
+{
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&lock->mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+static inline void arch_spin_lock(spinlock_t *lock)
+{
+	pthread_mutex_lock(&lock->mutex);
+}
+
+static inline int arch_try_lock(spinlock_t *lock)
+{
+	return pthread_mutex_trylock(&lock->mutex) == 0;
+}
+
+static inline void arch_spin_unlock(spinlock_t *lock)
+{
+	pthread_mutex_unlock(&lock->mutex);
+}
 
 #endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* HiFi2 EP intrinsics emulation, see xt_hifi_emu.h */
+
+#ifndef __INCLUDE_ARCH_XT_HIFI2__
+#define __INCLUDE_ARCH_XT_HIFI2__
+
+#include <arch/xt_hifi_emu.h>
+
+/* memory types */
+typedef int32_t ae_q32s;
+typedef int32_t ae_p24f;
+typedef struct {
+	int16_t d[2];
+} ae_p16x2s;
+
+/* register types, Q registers are 56 bit as Q9.47 */
+typedef struct hifi_32x2 ae_p24x2f;
+typedef int64_t ae_q56s;
+
+/* loads, C circularly post increments the address */
+
+static inline ae_p24x2f AE_LP24X2F_I(const void *p, int off)
+{
+	return hifi_f24x2(hifi_ld32x2(hifi_addr(p, off)));
+}
+
+/* 16 bit fractions are loaded to the upper bits of the 24 bit lanes */
+static inline ae_p24x2f AE_LP16X2F_I(const void *p, int off)
+{
+	ae_p16x2s v;
+	ae_p24x2f r;
+
+	memcpy(&v, hifi_align(hifi_addr(p, off), sizeof(v)), sizeof(v));
+	r.d[0] = (int32_t)v.d[0] << 16;
+	r.d[1] = (int32_t)v.d[1] << 16;
+	return r;
+}
+
+static inline ae_q56s AE_LQ32F_I(const void *p, int off)
+{
+	return (int64_t)hifi_ld32(hifi_addr(p, off)) * 65536;
+}
+
+#define AE_LP24F_C(v, p, inc) \
+	do { (v) = hifi_f24x2(hifi_rep32(hifi_ld32(p))); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+#define AE_LP24X2F_C(v, p, inc) \
+	do { (v) = AE_LP24X2F_I((p), 0); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+#define AE_LQ32F_C(v, p, inc) \
+	do { (v) = AE_LQ32F_I((p), 0); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+/* stores of Q register bits 47..16 */
+
+static inline void AE_SQ32F_I(ae_q56s d, void *p, int off)
+{
+	hifi_st32(hifi_addr(p, off), (int32_t)(d >> 16));
+}
+
+#define AE_SQ32F_C(v, p, inc) \
+	do { AE_SQ32F_I((v), (p), 0); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+/* 56 bit accumulator */
+
+static inline ae_q56s AE_ZEROQ56(void)
+{
+	return 0;
+}
+
+static inline ae_q56s AE_SLLIQ56(ae_q56s a, int sh)
+{
+	return hifi_wrap((int64_t)((uint64_t)a << sh), 56);
+}
+
+static inline ae_q56s AE_SRAIQ56(ae_q56s a, int sh)
+{
+	return a >> sh;
+}
+
+/* saturates left shifts */
+static inline ae_q56s AE_SRAAQ56(ae_q56s a, int sh)
+{
+	if (sh >= 0)
+		return a >> sh;
+
+	if (sh < -55 || hifi_sat(a, 56 + sh) != a)
+		return hifi_sat(a < 0 ? INT64_MIN : INT64_MAX, 56);
+
+	return (int64_t)((uint64_t)a << -sh);
+}
+
+/* round Q9.47 to Q1.31 half away from zero and saturate, the result stays
+ * in Q9.47 with the 16 LSBs cleared
+ */
+static inline ae_q56s AE_ROUNDSQ32SYM(ae_q56s a)
+{
+	return (int64_t)hifi_sat32(hifi_round_sym(a, 16)) * 65536;
+}
+
+/* Q1.23 x Q1.23 dual multiply accumulate to Q9.47, saturates to 56 bits */
+#define AE_MULAAFP24S_HH_LL(acc, a, b) \
+	((acc) = hifi_sat(hifi_add64((acc), hifi_mulfd24((a), (b))), 56))
+
+#endif
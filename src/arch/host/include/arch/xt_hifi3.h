@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* HiFi3 intrinsics emulation, see xt_hifi_emu.h */
+
+#ifndef __INCLUDE_ARCH_XT_HIFI3__
+#define __INCLUDE_ARCH_XT_HIFI3__
+
+#include <arch/xt_hifi_emu.h>
+
+/* memory types */
+typedef int16_t ae_int16;
+typedef int32_t ae_int32;
+typedef int32_t ae_f32;
+typedef int32_t ae_f24;
+
+/* register types */
+typedef struct hifi_16x4 ae_int16x4;
+typedef struct hifi_16x4 ae_f16x4;
+typedef struct hifi_32x2 ae_int32x2;
+typedef struct hifi_32x2 ae_f32x2;
+typedef struct hifi_32x2 ae_f24x2;
+typedef int64_t ae_int64;
+typedef int64_t ae_f64;
+typedef int64_t ae_valign;
+
+/* loads, XP post increments and XC circularly post increments the address */
+
+#define AE_L16_XP(v, p, inc) \
+	do { (v) = hifi_rep16(hifi_ld16(p)); \
+		(p) = hifi_addr((p), (int)(inc)); } while (0)
+
+#define AE_L32_XP(v, p, inc) \
+	do { (v) = hifi_rep32(hifi_ld32(p)); \
+		(p) = hifi_addr((p), (int)(inc)); } while (0)
+
+#define AE_L32_XC(v, p, inc) \
+	do { (v) = hifi_rep32(hifi_ld32(p)); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+#define AE_L32X2_XC(v, p, inc) \
+	do { (v) = hifi_ld32x2(p); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+#define AE_L32F24_XC(v, p, inc) \
+	do { (v) = hifi_f24x2(hifi_rep32(hifi_ld32(p))); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+#define AE_L32X2F24_XC(v, p, inc) \
+	do { (v) = hifi_f24x2(hifi_ld32x2(p)); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+#define AE_L32X2F24_IP(v, p, inc) \
+	do { (v) = hifi_f24x2(hifi_ld32x2(p)); \
+		(p) = hifi_addr((p), (int)(inc)); } while (0)
+
+/* unaligned load, the alignment register is not needed in C */
+#define AE_LA16X4_IP(v, u, p) \
+	do { (void)&(u); memcpy(&(v), (p), sizeof(ae_int16x4)); \
+		(p) = hifi_addr((p), sizeof(ae_int16x4)); } while (0)
+
+/* stores */
+
+#define AE_S16_0_XP(v, p, inc) \
+	do { hifi_st16((p), (v).d[3]); \
+		(p) = hifi_addr((p), (int)(inc)); } while (0)
+
+#define AE_S32_L_XP(v, p, inc) \
+	do { hifi_st32((p), (v).d[1]); \
+		(p) = hifi_addr((p), (int)(inc)); } while (0)
+
+#define AE_S32_L_XC(v, p, inc) \
+	do { hifi_st32((p), (v).d[1]); \
+		(p) = hifi_addr_circ((p), (int)(inc)); } while (0)
+
+/* moves and selects */
+
+static inline ae_int32x2 AE_MOVDA32(int32_t a)
+{
+	return hifi_rep32(a);
+}
+
+static inline ae_f16x4 AE_MOVF16X4_FROMF32X2(ae_f32x2 a)
+{
+	ae_f16x4 r;
+
+	r.d[0] = a.d[0] >> 16;
+	r.d[1] = a.d[0];
+	r.d[2] = a.d[1] >> 16;
+	r.d[3] = a.d[1];
+	return r;
+}
+
+static inline ae_f32x2 AE_SEL32_LL(ae_f32x2 a, ae_f32x2 b)
+{
+	return hifi_set32x2(a.d[1], b.d[1]);
+}
+
+static inline ae_f32x2 AE_SEL32_HH(ae_f32x2 a, ae_f32x2 b)
+{
+	return hifi_set32x2(a.d[0], b.d[0]);
+}
+
+/* 32 bit shifts, a negative amount shifts to the other direction */
+
+static inline int32_t hifi_sla32(int32_t x, int sh)
+{
+	return sh < 0 ? x >> -sh : (int32_t)((uint32_t)x << sh);
+}
+
+static inline int32_t hifi_srl32(int32_t x, int sh)
+{
+	return sh < 0 ? (int32_t)((uint32_t)x << -sh) :
+		(int32_t)((uint32_t)x >> sh);
+}
+
+/* rounds half up, saturates */
+static inline int32_t hifi_sra32rs(int32_t x, int sh)
+{
+	if (sh > 0)
+		return hifi_sat32(hifi_round_asym(x, sh));
+
+	return hifi_sat32((int64_t)x * ((int64_t)1 << -sh));
+}
+
+static inline ae_f32x2 AE_SLAA32(ae_f32x2 a, int sh)
+{
+	return hifi_set32x2(hifi_sla32(a.d[0], sh), hifi_sla32(a.d[1], sh));
+}
+
+#define AE_SLAI32(a, sh)	AE_SLAA32(a, sh)
+
+static inline ae_f32x2 AE_SRAI32(ae_f32x2 a, int sh)
+{
+	return hifi_set32x2(a.d[0] >> sh, a.d[1] >> sh);
+}
+
+static inline ae_f32x2 AE_SRLA32(ae_f32x2 a, int sh)
+{
+	return hifi_set32x2(hifi_srl32(a.d[0], sh), hifi_srl32(a.d[1], sh));
+}
+
+static inline ae_f32x2 AE_SRAA32RS(ae_f32x2 a, int sh)
+{
+	return hifi_set32x2(hifi_sra32rs(a.d[0], sh), hifi_sra32rs(a.d[1], sh));
+}
+
+/* 64 bit accumulator */
+
+static inline ae_f64 AE_ZERO64(void)
+{
+	return 0;
+}
+
+/* saturates left shifts */
+static inline ae_f64 AE_SRAA64(ae_f64 a, int sh)
+{
+	if (sh >= 0)
+		return a >> sh;
+
+	if (sh < -63 || hifi_sat(a, 64 + sh) != a)
+		return a < 0 ? INT64_MIN : INT64_MAX;
+
+	return (int64_t)((uint64_t)a << -sh);
+}
+
+/* round Q17.47 to Q1.31 half away from zero and saturate */
+static inline ae_f32x2 AE_ROUND32F48SSYM(ae_f64 a)
+{
+	return hifi_rep32(hifi_sat32(hifi_round_sym(hifi_sat(a, 48), 16)));
+}
+
+/* multiplies, F is fractional with doubling, RS rounds half away from zero
+ * and saturates
+ */
+
+/* Q1.31 x Q1.31 -> Q1.31 */
+static inline int32_t hifi_mulf32rs(int32_t a, int32_t b)
+{
+	return hifi_sat32(hifi_round_sym((int64_t)a * b, 31));
+}
+
+/* Q1.31 x Q1.15 -> Q1.31 */
+static inline int32_t hifi_mulf32x16rs(int32_t a, int16_t b)
+{
+	return hifi_sat32(hifi_round_sym((int64_t)a * b, 15));
+}
+
+static inline ae_f32x2 AE_MULFP32X2RS(ae_f32x2 a, ae_f32x2 b)
+{
+	return hifi_set32x2(hifi_mulf32rs(a.d[0], b.d[0]),
+			    hifi_mulf32rs(a.d[1], b.d[1]));
+}
+
+/* H lane with 16 bit lane 1 and L lane with lane 0 */
+static inline ae_f32x2 AE_MULFP32X16X2RS_L(ae_f32x2 a, ae_f16x4 b)
+{
+	return hifi_set32x2(hifi_mulf32x16rs(a.d[0], b.d[2]),
+			    hifi_mulf32x16rs(a.d[1], b.d[3]));
+}
+
+/* multiply accumulates to Q17.47, the 64 bit accumulation wraps unless
+ * the operation saturates (S)
+ */
+
+#define AE_MULAAFD32X16_H3_L2(acc, a, b) \
+	((acc) = hifi_add64((acc), \
+		(((int64_t)(a).d[0] * (b).d[0]) + \
+		 ((int64_t)(a).d[1] * (b).d[1])) * 2))
+
+#define AE_MULAAFD32X16_H1_L0(acc, a, b) \
+	((acc) = hifi_add64((acc), \
+		(((int64_t)(a).d[0] * (b).d[2]) + \
+		 ((int64_t)(a).d[1] * (b).d[3])) * 2))
+
+#define AE_MULAAFD24_HH_LL(acc, a, b) \
+	((acc) = hifi_add64((acc), hifi_mulfd24((a), (b))))
+
+#define AE_MULAAFP24S_HH_LL(acc, a, b) \
+	((acc) = hifi_add_sat64((acc), hifi_mulfd24((a), (b))))
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Portable C emulation of the HiFi audio engine register types and
+ * intrinsics, used by host builds configured with --with-hifi-emu to run
+ * the HiFi optimised audio kernels bit exact on the host. Only the
+ * intrinsics used by the kernels are emulated, see xt_hifi2.h and
+ * xt_hifi3.h.
+ *
+ * Vector registers are kept in memory order so element 0, loaded from the
+ * lowest address, is the H lane of a 32x2 register and lane 3 of a 16x4
+ * register. 24 bit fractional lanes hold the value in the upper 24 bits of
+ * a 32 bit word as loaded from memory.
+ */
+
+#ifndef __INCLUDE_ARCH_XT_HIFI_EMU__
+#define __INCLUDE_ARCH_XT_HIFI_EMU__
+
+#include <stdint.h>
+#include <string.h>
+
+/* 32x2 register, d[0] is the H lane */
+struct hifi_32x2 {
+	int32_t d[2];
+};
+
+/* 16x4 register, d[0] is lane 3 */
+struct hifi_16x4 {
+	int16_t d[4];
+};
+
+/* circular buffer set by AE_SETCBEGIN0() and AE_SETCEND0() */
+struct hifi_circ {
+	char *begin;
+	char *end;
+};
+
+static inline struct hifi_circ *hifi_circ0(void)
+{
+	static struct hifi_circ circ;
+
+	return &circ;
+}
+
+#define AE_SETCBEGIN0(p)	(hifi_circ0()->begin = (char *)(p))
+#define AE_SETCEND0(p)		(hifi_circ0()->end = (char *)(p))
+
+/* address post increment, inc is in bytes */
+static inline void *hifi_addr(const void *p, int inc)
+{
+	return (char *)p + inc;
+}
+
+/* circular address post increment within the buffer begin and end */
+static inline void *hifi_addr_circ(const void *p, int inc)
+{
+	struct hifi_circ *c = hifi_circ0();
+	char *a = (char *)p + inc;
+
+	if (a >= c->end)
+		a -= c->end - c->begin;
+	else if (a < c->begin)
+		a += c->end - c->begin;
+
+	return a;
+}
+
+/* loads and stores ignore the low address bits like the hardware does */
+static inline void *hifi_align(const void *p, int bytes)
+{
+	return (void *)((uintptr_t)p & ~(uintptr_t)(bytes - 1));
+}
+
+static inline int16_t hifi_ld16(const void *p)
+{
+	int16_t v;
+
+	memcpy(&v, hifi_align(p, sizeof(v)), sizeof(v));
+	return v;
+}
+
+static inline int32_t hifi_ld32(const void *p)
+{
+	int32_t v;
+
+	memcpy(&v, hifi_align(p, sizeof(v)), sizeof(v));
+	return v;
+}
+
+static inline void hifi_st16(void *p, int16_t v)
+{
+	memcpy(hifi_align(p, sizeof(v)), &v, sizeof(v));
+}
+
+static inline void hifi_st32(void *p, int32_t v)
+{
+	memcpy(hifi_align(p, sizeof(v)), &v, sizeof(v));
+}
+
+static inline struct hifi_32x2 hifi_set32x2(int32_t h, int32_t l)
+{
+	struct hifi_32x2 r;
+
+	r.d[0] = h;
+	r.d[1] = l;
+	return r;
+}
+
+static inline struct hifi_32x2 hifi_rep32(int32_t v)
+{
+	return hifi_set32x2(v, v);
+}
+
+static inline struct hifi_16x4 hifi_rep16(int16_t v)
+{
+	struct hifi_16x4 r;
+
+	r.d[0] = v;
+	r.d[1] = v;
+	r.d[2] = v;
+	r.d[3] = v;
+	return r;
+}
+
+/* aligned 64 bit load of two 32 bit words */
+static inline struct hifi_32x2 hifi_ld32x2(const void *p)
+{
+	struct hifi_32x2 r;
+
+	memcpy(&r, hifi_align(p, sizeof(r)), sizeof(r));
+	return r;
+}
+
+/* the 8 LSBs of a word are dropped when it is loaded as 24 bit fraction */
+static inline struct hifi_32x2 hifi_f24x2(struct hifi_32x2 a)
+{
+	a.d[0] &= ~0xff;
+	a.d[1] &= ~0xff;
+	return a;
+}
+
+/* saturate to a signed integer of bits width */
+static inline int64_t hifi_sat(int64_t x, int bits)
+{
+	int64_t max = ((int64_t)1 << (bits - 1)) - 1;
+
+	if (x > max)
+		return max;
+	if (x < -max - 1)
+		return -max - 1;
+	return x;
+}
+
+static inline int32_t hifi_sat32(int64_t x)
+{
+	return (int32_t)hifi_sat(x, 32);
+}
+
+/* wrap to a signed integer of bits width */
+static inline int64_t hifi_wrap(int64_t x, int bits)
+{
+	return (int64_t)((uint64_t)x << (64 - bits)) >> (64 - bits);
+}
+
+/* round symmetrically (half away from zero) by shift bits */
+static inline int64_t hifi_round_sym(int64_t x, int shift)
+{
+	int64_t half = (int64_t)1 << (shift - 1);
+
+	return x < 0 ? -((half - x) >> shift) : (x + half) >> shift;
+}
+
+/* round asymmetrically (half up) by shift bits */
+static inline int64_t hifi_round_asym(int64_t x, int shift)
+{
+	return (x + ((int64_t)1 << (shift - 1))) >> shift;
+}
+
+/* saturating add of 64 bit accumulators */
+static inline int64_t hifi_add_sat64(int64_t a, int64_t b)
+{
+	if (b > 0 && a > INT64_MAX - b)
+		return INT64_MAX;
+	if (b < 0 && a < INT64_MIN - b)
+		return INT64_MIN;
+	return a + b;
+}
+
+/* wrapping add of 64 bit accumulators */
+static inline int64_t hifi_add64(int64_t a, int64_t b)
+{
+	return (int64_t)((uint64_t)a + (uint64_t)b);
+}
+
+/* 24x24 fractional dual multiply with doubling, Q1.23 x Q1.23 -> Q17.47 */
+static inline int64_t hifi_mulfd24(struct hifi_32x2 a, struct hifi_32x2 b)
+{
+	return (((int64_t)(a.d[0] >> 8) * (b.d[0] >> 8)) +
+		((int64_t)(a.d[1] >> 8) * (b.d[1] >> 8))) * 2;
+}
+
+/* 24 bit lane selects common to HiFi2 and HiFi3 */
+static inline struct hifi_32x2 AE_SELP24_LL(struct hifi_32x2 a,
+					     struct hifi_32x2 b)
+{
+	return hifi_set32x2(a.d[1], b.d[1]);
+}
+
+static inline struct hifi_32x2 AE_SELP24_HH(struct hifi_32x2 a,
+					     struct hifi_32x2 b)
+{
+	return hifi_set32x2(a.d[0], b.d[0]);
+}
+
+static inline struct hifi_32x2 AE_SELP24_LH(struct hifi_32x2 a,
+					     struct hifi_32x2 b)
+{
+	return hifi_set32x2(a.d[1], b.d[0]);
+}
+
+#endif
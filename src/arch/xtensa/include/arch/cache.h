@@ -35,6 +35,8 @@
 #include <stddef.h>
 #include <xtensa/hal.h>
 
+#define DCACHE_LINE_SIZE	XCHAL_DCACHE_LINESIZE
+
 #if defined CONFIG_BAYTRAIL || defined CONFIG_CHERRYTRAIL ||\
 	defined CONFIG_HASWELL || defined CONFIG_BROADWELL
 
@@ -59,14 +59,18 @@ struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc)
 		return NULL;
 	}
 
-	/* allocate new buffer */
+	/* allocate new buffer, moved by buffer_share() if it's shared */
 	buffer = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*buffer));
 	if (buffer == NULL) {
 		trace_buffer_error("ebN");
 		return NULL;
 	}
 
-	buffer->addr = rballoc(RZONE_RUNTIME, desc->caps, desc->size);
+	/* data is in whole cache lines so cache maintenance on this buffer
+	 * never touches data of other buffers
+	 */
+	buffer->addr = rballoc(RZONE_BUFFER, desc->caps,
+		buffer_data_size(desc->size));
 	if (buffer->addr == NULL) {
 		rfree(buffer);
 		trace_buffer_error("ebm");
@@ -84,11 +88,50 @@ struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc)
 	buffer->avail = 0;
 	buffer->connected = 0;
 
+	/* buffer can be freed before it is connected */
+	list_init(&buffer->source_list);
+	list_init(&buffer->sink_list);
 	spinlock_init(&buffer->lock);
 
 	return buffer;
 }
 
+/* relink list item that was copied to new from its old location */
+static void buffer_list_move(struct list_item *new, struct list_item *old)
+{
+	if (old->next == old) {
+		list_init(new);
+		return;
+	}
+
+	new->next->prev = new;
+	new->prev->next = new;
+}
+
+/* move buffer that becomes shared between cores to a cache line aligned
+ * header, so cache maintenance of its runtime data never touches other
+ * allocations. Returns the new buffer, the old one is freed.
+ */
+struct comp_buffer *buffer_share(struct comp_buffer *buffer)
+{
+	struct comp_buffer *shared;
+
+	shared = rballoc(RZONE_BUFFER, SOF_MEM_CAPS_RAM, sizeof(*shared));
+	if (shared == NULL) {
+		trace_buffer_error("ebS");
+		return NULL;
+	}
+
+	*shared = *buffer;
+	buffer_list_move(&shared->source_list, &buffer->source_list);
+	buffer_list_move(&shared->sink_list, &buffer->sink_list);
+	spinlock_init(&shared->lock);
+	shared->shared = 1;
+
+	rfree(buffer);
+	return shared;
+}
+
 /* free component in the pipeline */
 void buffer_free(struct comp_buffer *buffer)
 {
@@ -96,20 +139,136 @@ void buffer_free(struct comp_buffer *buffer)
 
 	list_item_del(&buffer->source_list);
 	list_item_del(&buffer->sink_list);
-	rfree(buffer->addr);
+
+	/* arena data is released with the pipeline */
+	if (!buffer->arena)
+		rfree(buffer->addr);
 	rfree(buffer);
 }
 
+/* move buffer data out of the SRAM banks used by another buffer so both can
+ * be accessed in parallel. The buffer must not carry any data yet, so the
+ * current data is freed first and its blocks are available to the new
+ * placement.
+ */
+int buffer_place_bank(struct comp_buffer *buffer, struct comp_buffer *other)
+{
+	uint32_t bytes = buffer_data_size(buffer->alloc_size);
+
+	if (buffer->arena || !sram_bank_overlap(buffer->addr, bytes,
+		other->addr, other->alloc_size))
+		return 0;
+
+	rfree(buffer->addr);
+
+	/* falls back to any placement if other banks have no room */
+	buffer->addr = rballoc_bank(RZONE_BUFFER, buffer->ipc_buffer.caps,
+		bytes, other->addr, other->alloc_size);
+	if (buffer->addr == NULL) {
+		buffer->end_addr = NULL;
+		buffer->r_ptr = NULL;
+		buffer->w_ptr = NULL;
+		trace_buffer_error("ebb");
+		return -ENOMEM;
+	}
+
+	trace_buffer("BPb");
+
+	buffer->end_addr = buffer->addr + buffer->size;
+	buffer_reset_pos(buffer);
+	return 0;
+}
+
+/*
+ * Buffers with a DMA connected source or sink only need the data cache
+ * maintained once per period, just before the consumer copy. Producers
+ * record the dirty (sink is DMA) or stale (source is DMA) bytes here as a
+ * single range that grows contiguously from cache_ptr and may wrap.
+ */
+static inline void buffer_cache_mark(struct comp_buffer *buffer,
+	uint32_t bytes)
+{
+	if (!buffer->cache_pending)
+		buffer->cache_ptr = buffer->w_ptr;
+
+	buffer->cache_pending += bytes;
+	if (buffer->cache_pending > buffer->size)
+		buffer->cache_pending = buffer->size;
+}
+
+static inline void buffer_cache_op(struct comp_buffer *buffer, void *start,
+	void *end)
+{
+	/* buffer data owns whole cache lines so align out to line bounds */
+	start = (void *)((uintptr_t)start & ~(DCACHE_LINE_SIZE - 1));
+	end = (void *)(((uintptr_t)end + DCACHE_LINE_SIZE - 1) &
+		~(DCACHE_LINE_SIZE - 1));
+
+	if (buffer->source->is_dma_connected)
+		dcache_invalidate_region(start, end - start);
+	else
+		dcache_writeback_region(start, end - start);
+}
+
+/*
+ * Perform the pending cache maintenance for this buffer in the minimum
+ * number of line aligned operations: one, or two when the range wraps.
+ */
+uint32_t buffer_cache_sync(struct comp_buffer *buffer)
+{
+	uint32_t flags;
+	uint32_t head;
+	uint32_t ops = 0;
+
+	if (!buffer->cache_pending)
+		return 0;
+
+	spin_lock_irq(&buffer->lock, flags);
+
+	if (buffer->cache_pending == buffer->size) {
+		/* whole buffer */
+		buffer_cache_op(buffer, buffer->addr, buffer->end_addr);
+		ops = 1;
+	} else if (buffer->cache_pending) {
+		head = buffer->end_addr - buffer->cache_ptr;
+
+		/* pending range may wrap */
+		if (buffer->cache_pending <= head) {
+			buffer_cache_op(buffer, buffer->cache_ptr,
+				buffer->cache_ptr + buffer->cache_pending);
+			ops = 1;
+		} else {
+			buffer_cache_op(buffer, buffer->cache_ptr,
+				buffer->end_addr);
+			buffer_cache_op(buffer, buffer->addr,
+				buffer->addr + buffer->cache_pending - head);
+			ops = 2;
+		}
+	}
+
+	buffer->cache_pending = 0;
+
+	spin_unlock_irq(&buffer->lock, flags);
+
+	return ops;
+}
+
 void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 {
 	uint32_t flags;
 
 	spin_lock_irq(&buffer->lock, flags);
 
+	if (buffer->shared)
+		dcache_invalidate_region(buffer, BUFFER_SHARED_SIZE);
+
+	/* DMA side cache maintenance is batched until the consumer copy */
 	if (buffer->source->is_dma_connected)
-		dcache_invalidate_region(buffer->w_ptr, bytes);
-	else if (buffer->sink->is_dma_connected)
+		buffer_cache_mark(buffer, bytes);
+	else if (buffer->shared)
 		dcache_writeback_region(buffer->w_ptr, bytes);
+	else if (buffer->sink->is_dma_connected)
+		buffer_cache_mark(buffer, bytes);
 
 	buffer->w_ptr += bytes;
 
@@ -128,6 +287,10 @@ void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 	/* calculate free bytes */
 	buffer->free = buffer->size - buffer->avail;
 
+	/* publish new pointers to the consumer core */
+	if (buffer->shared)
+		dcache_writeback_region(buffer, BUFFER_SHARED_SIZE);
+
 	spin_unlock_irq(&buffer->lock, flags);
 
 	tracev_buffer("pro");
@@ -142,6 +305,9 @@ void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
 
 	spin_lock_irq(&buffer->lock, flags);
 
+	if (buffer->shared)
+		dcache_invalidate_region(buffer, BUFFER_SHARED_SIZE);
+
 	buffer->r_ptr += bytes;
 
 	/* check for pointer wrap */
@@ -159,8 +325,9 @@ void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
 	/* calculate free bytes */
 	buffer->free = buffer->size - buffer->avail;
 
-	if (buffer->sink->is_dma_connected)
-		dcache_writeback_region(buffer->r_ptr, bytes);
+	/* publish new pointers to the producer core */
+	if (buffer->shared)
+		dcache_writeback_region(buffer, BUFFER_SHARED_SIZE);
 
 	spin_unlock_irq(&buffer->lock, flags);
 
@@ -169,3 +336,56 @@ void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
 	tracev_value((buffer->ipc_buffer.comp.id << 16) | buffer->size);
 	tracev_value((buffer->r_ptr - buffer->addr) << 16 | (buffer->w_ptr - buffer->addr));
 }
+
+/* produce silence at the write pointer e.g. for a missing span of data */
+void buffer_produce_silence(struct comp_buffer *buffer, uint32_t bytes)
+{
+	uint32_t head = buffer->end_addr - buffer->w_ptr;
+
+	if (bytes > buffer->free)
+		bytes = buffer->free;
+
+	/* silence may wrap */
+	if (bytes <= head) {
+		bzero(buffer->w_ptr, bytes);
+	} else {
+		bzero(buffer->w_ptr, head);
+		bzero(buffer->addr, bytes - head);
+	}
+
+	comp_update_buffer_produce(buffer, bytes);
+}
+
+/*
+ * Buffers joining pipeline stages on different cores are single producer,
+ * single consumer rings with no hardware cache coherency. Pointers are
+ * written back by the other core under the buffer lock, so invalidate them
+ * here before use. Consumer also invalidates any data it has not read yet.
+ */
+void buffer_stage_sync(struct comp_buffer *buffer, int consumer)
+{
+	uint32_t flags;
+	uint32_t head;
+
+	if (!buffer->shared)
+		return;
+
+	spin_lock_irq(&buffer->lock, flags);
+
+	dcache_invalidate_region(buffer, BUFFER_SHARED_SIZE);
+
+	if (consumer && buffer->avail) {
+		head = buffer->end_addr - buffer->r_ptr;
+
+		/* avail data may wrap */
+		if (buffer->avail <= head) {
+			dcache_invalidate_region(buffer->r_ptr, buffer->avail);
+		} else {
+			dcache_invalidate_region(buffer->r_ptr, head);
+			dcache_invalidate_region(buffer->addr,
+				buffer->avail - head);
+		}
+	}
+
+	spin_unlock_irq(&buffer->lock, flags);
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <sof/sof.h>
+#include <sof/lock.h>
+#include <sof/list.h>
+#include <sof/alloc.h>
+#include <sof/trace.h>
+#include <sof/audio/coef_cache.h>
+
+#define trace_coef(__e)	trace_event(TRACE_CLASS_COMP, __e)
+#define tracev_coef(__e)	tracev_event(TRACE_CLASS_COMP, __e)
+#define trace_coef_error(__e)	trace_error(TRACE_CLASS_COMP, __e)
+
+/* FNV-1a 32 bit */
+#define COEF_HASH_BASIS		2166136261u
+#define COEF_HASH_PRIME		16777619u
+
+/* cached coefficient blob */
+struct coef_blob {
+	struct list_item list;	/* in coef_cache list */
+	uint32_t hash;
+	uint32_t size;
+	uint32_t refs;
+	uint32_t data[0];	/* coefficients follow */
+};
+
+struct coef_cache {
+	struct list_item list;	/* list of cached blobs */
+	spinlock_t lock;
+};
+
+static struct coef_cache *cache;
+
+static inline struct coef_blob *coef_to_blob(void *coef)
+{
+	return container_of(coef, struct coef_blob, data);
+}
+
+static uint32_t coef_hash(const void *data, uint32_t size)
+{
+	const uint8_t *d = data;
+	uint32_t hash = COEF_HASH_BASIS;
+	uint32_t i;
+
+	for (i = 0; i < size; i++) {
+		hash ^= d[i];
+		hash *= COEF_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+/* find an identical cached blob, cache lock must be held */
+static struct coef_blob *coef_find(const void *data, uint32_t size,
+	uint32_t hash, struct coef_blob *skip)
+{
+	struct list_item *clist;
+	struct coef_blob *blob;
+
+	list_for_item(clist, &cache->list) {
+		blob = container_of(clist, struct coef_blob, list);
+		if (blob == skip || blob->hash != hash || blob->size != size)
+			continue;
+		if (!memcmp(blob->data, data, size))
+			return blob;
+	}
+
+	return NULL;
+}
+
+static struct coef_blob *coef_blob_new(const void *data, uint32_t size,
+	uint32_t hash)
+{
+	struct coef_blob *blob;
+
+	blob = rmalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*blob) + size);
+	if (blob == NULL) {
+		trace_coef_error("eCn");
+		return NULL;
+	}
+
+	memcpy(blob->data, data, size);
+	blob->hash = hash;
+	blob->size = size;
+	blob->refs = 1;
+	return blob;
+}
+
+void *coef_get(const void *data, uint32_t size)
+{
+	struct coef_blob *blob;
+	struct coef_blob *new;
+	uint32_t hash = coef_hash(data, size);
+	uint32_t flags;
+
+	spin_lock_irq(&cache->lock, flags);
+	blob = coef_find(data, size, hash, NULL);
+	if (blob != NULL) {
+		blob->refs++;
+		spin_unlock_irq(&cache->lock, flags);
+		tracev_coef("CGh");
+		return blob->data;
+	}
+	spin_unlock_irq(&cache->lock, flags);
+
+	/* not cached, allocate outside the lock */
+	new = coef_blob_new(data, size, hash);
+	if (new == NULL)
+		return NULL;
+
+	/* another client may have added the same blob meanwhile */
+	spin_lock_irq(&cache->lock, flags);
+	blob = coef_find(data, size, hash, NULL);
+	if (blob != NULL) {
+		blob->refs++;
+	} else {
+		list_item_append(&new->list, &cache->list);
+		blob = new;
+		new = NULL;
+	}
+	spin_unlock_irq(&cache->lock, flags);
+
+	if (new != NULL)
+		rfree(new);
+
+	tracev_coef("CGn");
+	return blob->data;
+}
+
+void *coef_ref(void *coef)
+{
+	struct coef_blob *blob;
+	uint32_t flags;
+
+	if (coef == NULL)
+		return NULL;
+
+	blob = coef_to_blob(coef);
+
+	spin_lock_irq(&cache->lock, flags);
+	blob->refs++;
+	spin_unlock_irq(&cache->lock, flags);
+
+	return coef;
+}
+
+void coef_put(void *coef)
+{
+	struct coef_blob *blob;
+	uint32_t flags;
+
+	if (coef == NULL)
+		return;
+
+	blob = coef_to_blob(coef);
+
+	spin_lock_irq(&cache->lock, flags);
+	if (--blob->refs) {
+		spin_unlock_irq(&cache->lock, flags);
+		return;
+	}
+	list_item_del(&blob->list);
+	spin_unlock_irq(&cache->lock, flags);
+
+	rfree(blob);
+}
+
+void *coef_get_writable(void *coef)
+{
+	struct coef_blob *blob = coef_to_blob(coef);
+	struct coef_blob *new;
+	uint32_t flags;
+
+	spin_lock_irq(&cache->lock, flags);
+
+	/* sole user can modify in place, unlink it until coef_update() so no
+	 * lookup can share a blob that no longer matches its hash
+	 */
+	if (blob->refs == 1) {
+		list_item_del(&blob->list);
+		list_init(&blob->list);
+		spin_unlock_irq(&cache->lock, flags);
+		return coef;
+	}
+	spin_unlock_irq(&cache->lock, flags);
+
+	/* clone is private until coef_update() publishes it */
+	new = coef_blob_new(blob->data, blob->size, blob->hash);
+	if (new == NULL)
+		return NULL;
+
+	list_init(&new->list);
+	coef_put(coef);
+
+	return new->data;
+}
+
+void *coef_update(void *coef)
+{
+	struct coef_blob *blob = coef_to_blob(coef);
+	struct coef_blob *match;
+	uint32_t flags;
+
+	blob->hash = coef_hash(blob->data, blob->size);
+
+	spin_lock_irq(&cache->lock, flags);
+
+	/* merge with an identical blob so response switches share data */
+	match = coef_find(blob->data, blob->size, blob->hash, blob);
+	if (match == NULL) {
+		list_item_append(&blob->list, &cache->list);
+		spin_unlock_irq(&cache->lock, flags);
+		return coef;
+	}
+
+	match->refs++;
+	spin_unlock_irq(&cache->lock, flags);
+
+	rfree(blob);
+	return match->data;
+}
+
+void sys_coef_init(void)
+{
+	cache = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(*cache));
+	list_init(&cache->list);
+	spinlock_init(&cache->lock);
+}
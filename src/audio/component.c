@@ -38,11 +38,14 @@
 #include <sof/alloc.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
+#include <sof/audio/coef_cache.h>
 #include <uapi/ipc.h>
 
 struct comp_data {
 	struct list_item list;		/* list of components */
 	spinlock_t lock;
+	uint32_t delay_bytes;		/* delay lines held by components */
+	uint32_t delay_peak;		/* high water mark of delay_bytes */
 };
 
 static struct comp_data *cd;
@@ -187,9 +190,83 @@ int comp_set_state(struct comp_dev *dev, int cmd)
 	return ret;
 }
 
+/* account delay line memory, returns new total */
+static uint32_t comp_delay_account(int32_t bytes)
+{
+	uint32_t flags;
+	uint32_t total;
+
+	spin_lock_irq(&cd->lock, flags);
+	cd->delay_bytes += bytes;
+	if (cd->delay_bytes > cd->delay_peak)
+		cd->delay_peak = cd->delay_bytes;
+	total = cd->delay_bytes;
+	spin_unlock_irq(&cd->lock, flags);
+
+	return total;
+}
+
+/*
+ * Delay lines and similar processing state are allocated when a component
+ * is prepared with the actual channels and filter lengths, and freed on
+ * reset or suspend so idle pipelines don't hold them.
+ */
+int comp_delay_alloc(struct comp_delay *delay, uint32_t bytes)
+{
+	delay->data = NULL;
+	delay->size = 0;
+
+	if (bytes == 0)
+		return 0;
+
+	delay->data = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bytes);
+	if (!delay->data) {
+		trace_comp_error("eDa");
+		trace_error_value(bytes);
+		return -ENOMEM;
+	}
+
+	bzero(delay->data, bytes);
+	delay->size = bytes;
+
+	trace_comp("DLa");
+	trace_value(comp_delay_account(bytes));
+	return 0;
+}
+
+/* keep delay lines of the same size over a new prepare, e.g. in XRUN
+ * recovery, and only clear them
+ */
+int comp_delay_resize(struct comp_delay *delay, uint32_t bytes)
+{
+	if (delay->data && delay->size == bytes) {
+		bzero(delay->data, bytes);
+		return 0;
+	}
+
+	comp_delay_free(delay);
+	return comp_delay_alloc(delay, bytes);
+}
+
+void comp_delay_free(struct comp_delay *delay)
+{
+	if (!delay->data)
+		return;
+
+	rfree(delay->data);
+
+	trace_comp("DLf");
+	trace_value(comp_delay_account(-(int32_t)delay->size));
+
+	delay->data = NULL;
+	delay->size = 0;
+}
+
 void sys_comp_init(void)
 {
 	cd = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(*cd));
 	list_init(&cd->list);
 	spinlock_init(&cd->lock);
+
+	sys_coef_init();
 }
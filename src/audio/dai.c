@@ -42,6 +42,7 @@
 #include <sof/stream.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
+#include <sof/ipc.h>
 #include <platform/dma.h>
 #include <arch/cache.h>
 
@@ -79,6 +80,9 @@ static void dai_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 	struct dai_data *dd = comp_get_drvdata(dev);
 	struct comp_buffer *dma_buffer;
 	uint32_t copied_size;
+	uint32_t batch_bytes;
+	uint32_t silence_bytes;
+	void *silence;
 
 	tracev_dai("irq");
 
@@ -104,12 +108,21 @@ static void dai_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 			dma_buffer = list_first_item(&dev->bsource_list,
 				struct comp_buffer, sink_list);
 
-			/* fill buffer with silence */
-			bzero(dma_buffer->addr, dma_buffer->size);
+			/* DMA is stopping so only the next period will be
+			 * played. r_ptr is still at the period that has just
+			 * completed, fill the one after it with silence */
+			silence = dma_buffer->r_ptr + dd->period_bytes;
+			if (silence >= dma_buffer->end_addr)
+				silence = dma_buffer->addr +
+					(silence - dma_buffer->end_addr);
+
+			silence_bytes = dma_buffer->end_addr - silence;
+			if (silence_bytes > dd->period_bytes)
+				silence_bytes = dd->period_bytes;
+			bzero(silence, silence_bytes);
 
 			/* writeback buffer contents from cache */
-			dcache_writeback_region(dma_buffer->addr,
-				dma_buffer->size);
+			dcache_writeback_region(silence, silence_bytes);
 		}
 		return;
 	}
@@ -159,6 +172,18 @@ static void dai_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 		}
 	}
 
+	/* publish position for hosts polling the stream status */
+	ipc_stream_status_dai(dev, dev->position);
+
+	/* batched pipelines sleep until DAI has room for a full batch */
+	if (dev->pipeline->batch_periods > 1) {
+		batch_bytes = dev->pipeline->batch_periods * dd->period_bytes;
+		if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK ?
+		    dma_buffer->free < batch_bytes :
+		    dma_buffer->avail < batch_bytes)
+			return;
+	}
+
 	/* notify pipeline that DAI needs its buffer processed */
 	if (dev->state == COMP_STATE_ACTIVE)
 		pipeline_schedule_copy(dev->pipeline, 0);
@@ -44,6 +44,7 @@
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/audio/format.h>
+#include <sof/audio/coef_cache.h>
 #include <uapi/ipc.h>
 #include <uapi/eq.h>
 #include "fir.h"
@@ -59,9 +60,17 @@
 
 /* src component private data */
 struct comp_data {
-	struct sof_eq_fir_config *config;
+	struct sof_eq_fir_config *config;	/* active response */
+	struct sof_eq_fir_config *config_new;	/* staged, swapped in copy */
+	struct sof_eq_fir_config *config_old;	/* retired, freed on IPC */
 	uint32_t period_bytes;
+	struct comp_delay delay;	/* two banks of delay lines */
+	uint32_t delay_bank_size;	/* bytes per bank */
+	int delay_bank;		/* bank used by active response */
+	int delay_ready;	/* prepared, responses are staged to copy */
+	int xfade;		/* crossfade from fir_old in progress */
 	struct fir_state_32x16 fir[PLATFORM_MAX_CHANNELS];
+	struct fir_state_32x16 fir_old[PLATFORM_MAX_CHANNELS];
 	void (*eq_fir_func)(struct comp_dev *dev,
 		struct comp_buffer *source,
 		struct comp_buffer *sink,
@@ -126,41 +135,66 @@ static void eq_fir_s32_default(struct comp_dev *dev,
 	}
 }
 
-static void eq_fir_free_parameters(struct sof_eq_fir_config **config)
+/* Crossfade from the retired response to the new one during one period */
+static void eq_fir_s32_xfade(struct comp_dev *dev,
+	struct comp_buffer *source, struct comp_buffer *sink, uint32_t frames)
 {
-	if (*config != NULL)
-		rfree(*config);
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t *src = (int32_t *) source->r_ptr;
+	int32_t *snk = (int32_t *) sink->w_ptr;
+	int32_t *x;
+	int32_t *y;
+	int nch = dev->params.channels;
+	int64_t step = (1 << 30) / frames; /* Q2.30 */
+	int64_t gain;
+	int32_t y_old;
+	int32_t y_new;
+	uint32_t i;
+	int ch;
 
-	*config = NULL;
+	for (ch = 0; ch < nch; ch++) {
+		x = src++;
+		y = snk++;
+		gain = 0;
+		for (i = 0; i < frames; i++) {
+			gain += step;
+			y_old = fir_32x16(&cd->fir_old[ch], *x);
+			y_new = fir_32x16(&cd->fir[ch], *x);
+			*y = y_old + (int32_t)
+				((((int64_t) y_new - y_old) * gain) >> 30);
+			x += nch;
+			y += nch;
+
+			/* Check both source and destination for wrap */
+			if (x >= (int32_t *) source->end_addr)
+				x = (int32_t *) ((size_t) x - source->size);
+			if (y >= (int32_t *) sink->end_addr)
+				y = (int32_t *) ((size_t) y - sink->size);
+		}
+	}
+
+	cd->xfade = 0;
+	cd->eq_fir_func = eq_fir_s32_default;
 }
 
-static void eq_fir_free_delaylines(struct fir_state_32x16 fir[])
+static void eq_fir_free_parameters(struct sof_eq_fir_config **config)
 {
-	int i = 0;
-	int32_t *data = NULL;
-
-	/* 1st active EQ data is at beginning of the single allocated buffer */
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
-		if ((fir[i].delay != NULL) && (data == NULL))
-			data = fir[i].delay;
-
-		/* Set all to NULL to avoid duplicated free later */
-		fir[i].delay = NULL;
-	}
-
-	if (data != NULL)
-		rfree(data);
+	coef_put(*config);
+	*config = NULL;
 }
 
+/* Set up FIR channels to config. The delay lines are not touched
+ * when fir_data is NULL so this can also be used to validate a config.
+ * Returns the size in bytes of the delay lines needed by config.
+ */
 static int eq_fir_setup(struct fir_state_32x16 fir[],
-	struct sof_eq_fir_config *config, int nch)
+	struct sof_eq_fir_config *config, int nch, int32_t *fir_data)
 {
 	int i;
 	int j;
 	int idx;
 	int length;
 	int resp;
-	int32_t *fir_data;
 	int16_t *coef_data, *assign_response;
 	int response_index[PLATFORM_MAX_CHANNELS];
 	int length_sum = 0;
@@ -182,9 +216,6 @@ static int eq_fir_setup(struct fir_state_32x16 fir[],
 		}
 	}
 
-	/* Free existing FIR channels data if it was allocated */
-	eq_fir_free_delaylines(fir);
-
 	/* Initialize 1st phase */
 	for (i = 0; i < nch; i++) {
 		resp = assign_response[i];
@@ -200,16 +231,16 @@ static int eq_fir_setup(struct fir_state_32x16 fir[],
 			length = fir_init_coef(&fir[i], &coef_data[idx]);
 			if (length > 0)
 				length_sum += length;
+			else
+				return -EINVAL;
 		}
 
 	}
 
-	/* Allocate all FIR channels data in a big chunk and clear it */
-	fir_data = rballoc(RZONE_SYS, SOF_MEM_CAPS_RAM,
-		length_sum * sizeof(int32_t));
 	if (fir_data == NULL)
-		return -ENOMEM;
+		return length_sum * sizeof(int32_t);
 
+	/* Clear the bank, it may hold the state of an earlier response */
 	memset(fir_data, 0, length_sum * sizeof(int32_t));
 
 	/* Initialize 2nd phase to set EQ delay lines pointers */
@@ -220,22 +251,215 @@ static int eq_fir_setup(struct fir_state_32x16 fir[],
 		}
 	}
 
+	return length_sum * sizeof(int32_t);
+}
+
+/* Delay lines of bank. A new response is set up in the idle bank while
+ * the active response keeps running.
+ */
+static int32_t *eq_fir_bank(struct comp_data *cd, int bank)
+{
+	return cd->delay.data + bank * cd->delay_bank_size;
+}
+
+/* Apply a new response. Once the EQ is prepared the response is only
+ * staged here and swapped in by copy() at a period boundary, the idle
+ * delay line bank is already allocated for it.
+ */
+static int eq_fir_apply(struct comp_dev *dev,
+	struct sof_eq_fir_config *config)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct fir_state_32x16 fir[PLATFORM_MAX_CHANNELS];
+	struct sof_eq_fir_config *staged;
+	struct sof_eq_fir_config *retired = NULL;
+	uint32_t flags;
+	int ret;
+
+	if (!cd->delay_ready) {
+		/* Not prepared, check and use the new config directly */
+		ret = eq_fir_setup(cd->fir, config, PLATFORM_MAX_CHANNELS,
+			NULL);
+		if (ret < 0) {
+			coef_put(config);
+			return ret;
+		}
+
+		eq_fir_free_parameters(&cd->config);
+		cd->config = config;
+		return 0;
+	}
+
+	/* Check the config without touching the running filters */
+	ret = eq_fir_setup(fir, config, dev->params.channels, NULL);
+	if (ret < 0) {
+		coef_put(config);
+		return ret;
+	}
+
+	/* Any valid response fits in a bank */
+	if ((uint32_t)ret > cd->delay_bank_size) {
+		trace_eq_error("eDs");
+		coef_put(config);
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&dev->lock, flags);
+	staged = cd->config_new;
+	cd->config_new = config;
+	if (!cd->xfade) {
+		retired = cd->config_old;
+		cd->config_old = NULL;
+	}
+	spin_unlock_irq(&dev->lock, flags);
+
+	coef_put(staged);
+	coef_put(retired);
 	return 0;
 }
 
-static int eq_fir_switch_response(struct fir_state_32x16 fir[],
-	struct sof_eq_fir_config *config, uint32_t ch, int32_t response)
+/* Swap in the staged response, called from copy() between periods */
+static void eq_fir_swap(struct comp_dev *dev)
 {
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_fir_config *config;
+	struct sof_eq_fir_config *retired;
+	int nch = dev->params.channels;
+	int bank = !cd->delay_bank;
+	uint32_t flags;
 	int ret;
+	int i;
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	spin_unlock_irq(&dev->lock, flags);
 
-	/* Copy assign response from update and re-initilize EQ */
-	if ((config == NULL) || (ch >= PLATFORM_MAX_CHANNELS))
+	memcpy(cd->fir_old, cd->fir, sizeof(cd->fir));
+	ret = eq_fir_setup(cd->fir, config, nch, eq_fir_bank(cd, bank));
+	if (ret < 0) {
+		/* Keep running the old response */
+		trace_eq_error("eSw");
+		memcpy(cd->fir, cd->fir_old, sizeof(cd->fir));
+		retired = config;
+	} else {
+		/* Keep channel mute settings over the switch */
+		for (i = 0; i < nch; i++) {
+			if (cd->fir[i].coef != NULL &&
+				cd->fir_old[i].coef != NULL)
+				cd->fir[i].mute = cd->fir_old[i].mute;
+		}
+
+		retired = cd->config;
+		cd->config = config;
+		cd->delay_bank = bank;
+		cd->eq_fir_func = eq_fir_s32_xfade;
+	}
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_old;
+	cd->config_old = retired;
+	cd->xfade = ret < 0 ? 0 : 1;
+	spin_unlock_irq(&dev->lock, flags);
+
+	/* Only when updates come in faster than periods */
+	coef_put(config);
+}
+
+/* Allocate two delay line banks that fit any response for the actual
+ * channels and initialize the EQ, runtime updates only swap banks.
+ */
+static int eq_fir_start(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int nch = dev->params.channels;
+	int ret;
+
+	ret = eq_fir_setup(cd->fir, cd->config, nch, NULL);
+	if (ret < 0)
+		return ret;
+
+	cd->delay_bank_size = nch * MAX_FIR_LENGTH * sizeof(int32_t);
+	ret = comp_delay_resize(&cd->delay, 2 * cd->delay_bank_size);
+	if (ret < 0) {
+		trace_eq_error("eDl");
+		return ret;
+	}
+
+	cd->delay_bank = 0;
+	ret = eq_fir_setup(cd->fir, cd->config, nch, eq_fir_bank(cd, 0));
+	if (ret < 0) {
+		comp_delay_free(&cd->delay);
+		return ret;
+	}
+
+	cd->eq_fir_func = eq_fir_s32_default;
+	cd->delay_ready = 1;
+	return 0;
+}
+
+/* A staged response becomes the active config */
+static void eq_fir_unstage(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (cd->config_new != NULL) {
+		eq_fir_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
+	eq_fir_free_parameters(&cd->config_old);
+
+	cd->xfade = 0;
+	cd->eq_fir_func = eq_fir_s32_default;
+}
+
+/* Release all delay lines, a staged response becomes the active config */
+static void eq_fir_stop(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int i;
+
+	/* Set all to NULL to avoid use of freed data later */
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
+		cd->fir[i].delay = NULL;
+		cd->fir_old[i].delay = NULL;
+	}
+
+	comp_delay_free(&cd->delay);
+	cd->delay_ready = 0;
+
+	eq_fir_unstage(dev);
+}
+
+static int eq_fir_switch_response(struct comp_dev *dev, uint32_t ch,
+	int32_t response)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_fir_config *config;
+	struct sof_eq_fir_config *cfg;
+	uint32_t flags;
+
+	if (ch >= PLATFORM_MAX_CHANNELS)
 		return -EINVAL;
 
-	config->data[ch] = response;
-	ret = eq_fir_setup(fir, config, PLATFORM_MAX_CHANNELS);
+	/* Start from the latest response, staged or active */
+	spin_lock_irq(&dev->lock, flags);
+	config = coef_ref(cd->config_new ? cd->config_new : cd->config);
+	spin_unlock_irq(&dev->lock, flags);
 
-	return ret;
+	if (config == NULL)
+		return -EINVAL;
+
+	/* Copy assign response from update and re-initialize EQ */
+	cfg = coef_get_writable(config);
+	if (cfg == NULL) {
+		coef_put(config);
+		return -ENOMEM;
+	}
+
+	cfg->data[ch] = response;
+	return eq_fir_apply(dev, coef_update(cfg));
 }
 
 /*
@@ -271,6 +495,8 @@ static struct comp_dev *eq_fir_new(struct sof_ipc_comp *comp)
 
 	cd->eq_fir_func = eq_fir_s32_default;
 	cd->config = NULL;
+	cd->config_new = NULL;
+	cd->config_old = NULL;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		fir_reset(&cd->fir[i]);
 
@@ -284,7 +510,7 @@ static void eq_fir_free(struct comp_dev *dev)
 
 	trace_eq("fre");
 
-	eq_fir_free_delaylines(cd->fir);
+	eq_fir_stop(dev);
 	eq_fir_free_parameters(&cd->config);
 
 	rfree(cd);
@@ -356,14 +582,15 @@ static int fir_cmd_set_value(struct comp_dev *dev, struct sof_ipc_ctrl_data *cda
 
 static int fir_cmd_set_data(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdata)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	struct sof_ipc_ctrl_value_comp *compv;
+	struct sof_eq_fir_config *config;
 	size_t bs;
 	int i;
 	int ret = 0;
 
-	/* TODO: determine if data is DMAed or appended to cdata */
-
+	/* data is in cdata for both mailbox and host buffer transfers,
+	 * the ABI header has been checked by the IPC layer.
+	 */
 	/* Check version from ABI header */
 	if (cdata->data->comp_abi != SOF_EQ_FIR_ABI_VERSION)
 		return -EINVAL;
@@ -377,7 +604,7 @@ static int fir_cmd_set_data(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdat
 			for (i = 0; i < (int) cdata->num_elems; i++) {
 				tracev_value(compv[i].index);
 				tracev_value(compv[i].svalue);
-				ret = eq_fir_switch_response(cd->fir, cd->config,
+				ret = eq_fir_switch_response(dev,
 					compv[i].index, compv[i].svalue);
 				if (ret < 0) {
 					trace_eq_error("swe");
@@ -393,20 +620,17 @@ static int fir_cmd_set_data(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdat
 	case SOF_CTRL_CMD_BINARY:
 		trace_eq("EFc");
 
-		/* Check and free old config */
-		eq_fir_free_parameters(&cd->config);
-
-		/* Copy new config, need to decode data to know the size */
+		/* Check new config, need to decode data to know the size */
 		bs = cdata->data->size;
 		if ((bs > SOF_EQ_FIR_MAX_SIZE) || (bs < 1))
 			return -EINVAL;
 
-		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
-		if (cd->config == NULL)
+		/* Share cached copy of the blob */
+		config = coef_get(cdata->data->data, bs);
+		if (config == NULL)
 			return -EINVAL;
 
-		memcpy(cd->config, cdata->data->data, bs);
-		ret = eq_fir_setup(cd->fir, cd->config, PLATFORM_MAX_CHANNELS);
+		ret = eq_fir_apply(dev, config);
 		break;
 	default:
 		trace_eq_error("ec1");
@@ -439,8 +663,28 @@ static int eq_fir_cmd(struct comp_dev *dev, int cmd, void *data)
 
 static int eq_fir_trigger(struct comp_dev *dev, int cmd)
 {
+	int ret;
+
 	trace_eq("trg");
 
+	/* delay lines are not kept over suspend */
+	switch (cmd) {
+	case COMP_TRIGGER_SUSPEND:
+		eq_fir_stop(dev);
+		break;
+	case COMP_TRIGGER_RESUME:
+		if (dev->state == COMP_STATE_PREPARE ||
+		    dev->state == COMP_STATE_PAUSED ||
+		    dev->state == COMP_STATE_ACTIVE) {
+			ret = eq_fir_start(dev);
+			if (ret < 0)
+				return ret;
+		}
+		break;
+	default:
+		break;
+	}
+
 	return comp_set_state(dev, cmd);
 }
 
@@ -469,6 +713,10 @@ static int eq_fir_copy(struct comp_dev *dev)
 		return -EIO;	/* xrun */
 	}
 
+	/* Swap in a new response at the period boundary */
+	if (sd->config_new != NULL)
+		eq_fir_swap(dev);
+
 	sd->eq_fir_func(dev, source, sink, dev->frames);
 
 	/* calc new free and available */
@@ -489,16 +737,20 @@ static int eq_fir_prepare(struct comp_dev *dev)
 	if (ret < 0)
 		return ret;
 
-	cd->eq_fir_func = eq_fir_s32_default;
+	/* delay lines of a previous prepare are kept if the channels match */
+	eq_fir_unstage(dev);
 
 	/* Initialize EQ */
 	if (cd->config == NULL) {
+		eq_fir_stop(dev);
 		comp_set_state(dev, COMP_TRIGGER_RESET);
 		return -EINVAL;
 	}
 
-	ret = eq_fir_setup(cd->fir, cd->config, dev->params.channels);
+	/* Delay lines are allocated for the active response */
+	ret = eq_fir_start(dev);
 	if (ret < 0) {
+		eq_fir_stop(dev);
 		comp_set_state(dev, COMP_TRIGGER_RESET);
 		return ret;
 	}
@@ -513,10 +765,9 @@ static int eq_fir_reset(struct comp_dev *dev)
 
 	trace_eq("ERe");
 
-	eq_fir_free_delaylines(cd->fir);
+	eq_fir_stop(dev);
 	eq_fir_free_parameters(&cd->config);
 
-	cd->eq_fir_func = eq_fir_s32_default;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		fir_reset(&cd->fir[i]);
 
@@ -44,6 +44,7 @@
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/audio/format.h>
+#include <sof/audio/coef_cache.h>
 #include <uapi/ipc.h>
 #include <uapi/eq.h>
 #include "eq_iir.h"
@@ -59,9 +60,17 @@
 
 /* src component private data */
 struct comp_data {
-	struct sof_eq_iir_config *config;
+	struct sof_eq_iir_config *config;	/* active response */
+	struct sof_eq_iir_config *config_new;	/* staged, swapped in copy */
+	struct sof_eq_iir_config *config_old;	/* retired, freed on IPC */
 	uint32_t period_bytes;
+	struct comp_delay delay;	/* two banks of delay lines */
+	uint32_t delay_bank_size;	/* bytes per bank */
+	int delay_bank;		/* bank used by active response */
+	int delay_ready;	/* prepared, responses are staged to copy */
+	int xfade;		/* crossfade from iir_old in progress */
 	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS];
+	struct iir_state_df2t iir_old[PLATFORM_MAX_CHANNELS];
 	void (*eq_iir_func)(struct comp_dev *dev,
 		struct comp_buffer *source,
 		struct comp_buffer *sink,
@@ -126,51 +135,70 @@ static void eq_iir_s32_default(struct comp_dev *dev,
 	}
 }
 
-static void eq_iir_free_parameters(struct sof_eq_iir_config **config)
-{
-	if (*config != NULL)
-		rfree(*config);
-
-	*config = NULL;
-}
-
-static void eq_iir_free_delaylines(struct iir_state_df2t *iir)
+/* Crossfade from the retired response to the new one during one period */
+static void eq_iir_s32_xfade(struct comp_dev *dev,
+	struct comp_buffer *source, struct comp_buffer *sink, uint32_t frames)
 {
-	int i = 0;
-	int64_t *delay = NULL; /* TODO should not need to know the type */
-
-	/* 1st active EQ delay line data is at beginning of the single
-	 * allocated buffer
-	 */
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
-		if ((iir[i].delay != NULL) && (delay == NULL))
-			delay = iir[i].delay;
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t *src = (int32_t *) source->r_ptr;
+	int32_t *snk = (int32_t *) sink->w_ptr;
+	int32_t *x;
+	int32_t *y;
+	int nch = dev->params.channels;
+	int64_t step = (1 << 30) / frames; /* Q2.30 */
+	int64_t gain;
+	int32_t y_old;
+	int32_t y_new;
+	uint32_t i;
+	int ch;
 
-		/* Point all delays to NULL to avoid duplicated free later */
-		iir[i].delay = NULL;
+	for (ch = 0; ch < nch; ch++) {
+		x = src++;
+		y = snk++;
+		gain = 0;
+		for (i = 0; i < frames; i++) {
+			gain += step;
+			y_old = iir_df2t(&cd->iir_old[ch], *x);
+			y_new = iir_df2t(&cd->iir[ch], *x);
+			*y = y_old + (int32_t)
+				((((int64_t) y_new - y_old) * gain) >> 30);
+			x += nch;
+			y += nch;
+
+			/* Check both source and destination for wrap */
+			if (x >= (int32_t *) source->end_addr)
+				x = (int32_t *) ((size_t) x - source->size);
+			if (y >= (int32_t *) sink->end_addr)
+				y = (int32_t *) ((size_t) y - sink->size);
+		}
 	}
 
-	if (delay != NULL)
-		rfree(delay);
+	cd->xfade = 0;
+	cd->eq_iir_func = eq_iir_s32_default;
+}
 
+static void eq_iir_free_parameters(struct sof_eq_iir_config **config)
+{
+	coef_put(*config);
+	*config = NULL;
 }
 
+/* Set up IIR channels to config. The delay lines are not touched
+ * when iir_delay is NULL so this can also be used to validate a config.
+ * Returns the size in bytes of the delay lines needed by config.
+ */
 static int eq_iir_setup(struct iir_state_df2t iir[],
-	struct sof_eq_iir_config *config, int nch)
+	struct sof_eq_iir_config *config, int nch, int64_t *iir_delay)
 {
 	int i;
 	int j;
 	int idx;
 	int resp;
-	size_t s;
+	int s;
 	size_t size_sum = 0;
-	int64_t *iir_delay; /* TODO should not need to know the type */
 	int32_t *coef_data, *assign_response;
 	int response_index[PLATFORM_MAX_CHANNELS];
 
-	/* Free existing IIR channels data if it was allocated */
-	eq_iir_free_delaylines(iir);
-
 	if ((nch > PLATFORM_MAX_CHANNELS)
 		|| (config->channels_in_config > PLATFORM_MAX_CHANNELS))
 		return -EINVAL;
@@ -210,11 +238,10 @@ static int eq_iir_setup(struct iir_state_df2t iir[],
 
 	}
 
-	/* Allocate all IIR channels data in a big chunk and clear it */
-	iir_delay = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, size_sum);
 	if (iir_delay == NULL)
-		return -ENOMEM;
+		return size_sum;
 
+	/* Clear the bank, it may hold the state of an earlier response */
 	memset(iir_delay, 0, size_sum);
 
 	/* Initialize 2nd phase to set EQ delay lines pointers */
@@ -226,22 +253,217 @@ static int eq_iir_setup(struct iir_state_df2t iir[],
 
 	}
 
+	return size_sum;
+}
+
+/* Delay lines of bank. A new response is set up in the idle bank while
+ * the active response keeps running.
+ */
+static int64_t *eq_iir_bank(struct comp_data *cd, int bank)
+{
+	return cd->delay.data + bank * cd->delay_bank_size;
+}
+
+/* Apply a new response. Once the EQ is prepared the response is only
+ * staged here and swapped in by copy() at a period boundary, the idle
+ * delay line bank is already allocated for it.
+ */
+static int eq_iir_apply(struct comp_dev *dev,
+	struct sof_eq_iir_config *config)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS];
+	struct sof_eq_iir_config *staged;
+	struct sof_eq_iir_config *retired = NULL;
+	uint32_t flags;
+	int ret;
+
+	if (!cd->delay_ready) {
+		/* Not prepared, check and use the new config directly. The
+		 * actual number of channels may not be set yet.
+		 */
+		ret = eq_iir_setup(cd->iir, config, PLATFORM_MAX_CHANNELS,
+			NULL);
+		if (ret < 0) {
+			coef_put(config);
+			return ret;
+		}
+
+		eq_iir_free_parameters(&cd->config);
+		cd->config = config;
+		return 0;
+	}
+
+	/* Check the config without touching the running filters */
+	ret = eq_iir_setup(iir, config, dev->params.channels, NULL);
+	if (ret < 0) {
+		coef_put(config);
+		return ret;
+	}
+
+	/* Any valid response fits in a bank */
+	if ((uint32_t)ret > cd->delay_bank_size) {
+		trace_eq_iir_error("eDs");
+		coef_put(config);
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&dev->lock, flags);
+	staged = cd->config_new;
+	cd->config_new = config;
+	if (!cd->xfade) {
+		retired = cd->config_old;
+		cd->config_old = NULL;
+	}
+	spin_unlock_irq(&dev->lock, flags);
+
+	coef_put(staged);
+	coef_put(retired);
 	return 0;
 }
 
-static int eq_iir_switch_response(struct iir_state_df2t iir[],
-	struct sof_eq_iir_config *config, uint32_t ch, int32_t response)
+/* Swap in the staged response, called from copy() between periods */
+static void eq_iir_swap(struct comp_dev *dev)
 {
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_iir_config *config;
+	struct sof_eq_iir_config *retired;
+	int nch = dev->params.channels;
+	int bank = !cd->delay_bank;
+	uint32_t flags;
 	int ret;
+	int i;
 
-	/* Copy assign response from update and re-initialize EQ */
-	if ((config == NULL) || (ch >= PLATFORM_MAX_CHANNELS))
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	spin_unlock_irq(&dev->lock, flags);
+
+	memcpy(cd->iir_old, cd->iir, sizeof(cd->iir));
+	ret = eq_iir_setup(cd->iir, config, nch, eq_iir_bank(cd, bank));
+	if (ret < 0) {
+		/* Keep running the old response */
+		trace_eq_iir_error("eSw");
+		memcpy(cd->iir, cd->iir_old, sizeof(cd->iir));
+		retired = config;
+	} else {
+		/* Keep channel mute settings over the switch */
+		for (i = 0; i < nch; i++) {
+			if (cd->iir[i].coef != NULL &&
+				cd->iir_old[i].coef != NULL)
+				cd->iir[i].mute = cd->iir_old[i].mute;
+		}
+
+		retired = cd->config;
+		cd->config = config;
+		cd->delay_bank = bank;
+		cd->eq_iir_func = eq_iir_s32_xfade;
+	}
+
+	spin_lock_irq(&dev->lock, flags);
+	config = cd->config_old;
+	cd->config_old = retired;
+	cd->xfade = ret < 0 ? 0 : 1;
+	spin_unlock_irq(&dev->lock, flags);
+
+	/* Only when updates come in faster than periods */
+	coef_put(config);
+}
+
+/* Allocate two delay line banks that fit any response for the actual
+ * channels and initialize the EQ, runtime updates only swap banks.
+ */
+static int eq_iir_start(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int nch = dev->params.channels;
+	int ret;
+
+	ret = eq_iir_setup(cd->iir, cd->config, nch, NULL);
+	if (ret < 0)
+		return ret;
+
+	cd->delay_bank_size = nch * 2 * IIR_DF2T_BIQUADS_MAX * sizeof(int64_t);
+	ret = comp_delay_resize(&cd->delay, 2 * cd->delay_bank_size);
+	if (ret < 0) {
+		trace_eq_iir_error("eDl");
+		return ret;
+	}
+
+	cd->delay_bank = 0;
+	ret = eq_iir_setup(cd->iir, cd->config, nch, eq_iir_bank(cd, 0));
+	if (ret < 0) {
+		comp_delay_free(&cd->delay);
+		return ret;
+	}
+
+	cd->eq_iir_func = eq_iir_s32_default;
+	cd->delay_ready = 1;
+	return 0;
+}
+
+/* A staged response becomes the active config */
+static void eq_iir_unstage(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (cd->config_new != NULL) {
+		eq_iir_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
+	eq_iir_free_parameters(&cd->config_old);
+
+	cd->xfade = 0;
+	cd->eq_iir_func = eq_iir_s32_default;
+}
+
+/* Release all delay lines, a staged response becomes the active config */
+static void eq_iir_stop(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int i;
+
+	/* Point all delays to NULL to avoid use of freed data later */
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
+		cd->iir[i].delay = NULL;
+		cd->iir_old[i].delay = NULL;
+	}
+
+	comp_delay_free(&cd->delay);
+	cd->delay_ready = 0;
+
+	eq_iir_unstage(dev);
+}
+
+static int eq_iir_switch_response(struct comp_dev *dev, uint32_t ch,
+	int32_t response)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_iir_config *config;
+	struct sof_eq_iir_config *cfg;
+	uint32_t flags;
+
+	if (ch >= PLATFORM_MAX_CHANNELS)
 		return -EINVAL;
 
-	config->data[ch] = response;
-	ret = eq_iir_setup(iir, config, PLATFORM_MAX_CHANNELS);
+	/* Start from the latest response, staged or active */
+	spin_lock_irq(&dev->lock, flags);
+	config = coef_ref(cd->config_new ? cd->config_new : cd->config);
+	spin_unlock_irq(&dev->lock, flags);
 
-	return ret;
+	if (config == NULL)
+		return -EINVAL;
+
+	/* Copy assign response from update and re-initialize EQ */
+	cfg = coef_get_writable(config);
+	if (cfg == NULL) {
+		coef_put(config);
+		return -ENOMEM;
+	}
+
+	cfg->data[ch] = response;
+	return eq_iir_apply(dev, coef_update(cfg));
 }
 
 /*
@@ -273,6 +495,8 @@ static struct comp_dev *eq_iir_new(struct sof_ipc_comp *comp)
 
 	cd->eq_iir_func = eq_iir_s32_default;
 	cd->config = NULL;
+	cd->config_new = NULL;
+	cd->config_old = NULL;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		iir_reset_df2t(&cd->iir[i]);
 
@@ -286,7 +510,7 @@ static void eq_iir_free(struct comp_dev *dev)
 
 	trace_eq_iir("fre");
 
-	eq_iir_free_delaylines(cd->iir);
+	eq_iir_stop(dev);
 	eq_iir_free_parameters(&cd->config);
 
 	rfree(cd);
@@ -358,8 +582,8 @@ static int iir_cmd_set_value(struct comp_dev *dev, struct sof_ipc_ctrl_data *cda
 
 static int iir_cmd_set_data(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdata)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	struct sof_ipc_ctrl_value_comp *compv;
+	struct sof_eq_iir_config *config;
 	int i;
 	int ret = 0;
 	size_t bs;
@@ -373,7 +597,7 @@ static int iir_cmd_set_data(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdat
 			for (i = 0; i < (int) cdata->num_elems; i++) {
 				tracev_value(compv[i].index);
 				tracev_value(compv[i].svalue);
-				ret = eq_iir_switch_response(cd->iir, cd->config,
+				ret = eq_iir_switch_response(dev,
 					compv[i].index, compv[i].svalue);
 				if (ret < 0) {
 					trace_eq_iir_error("swe");
@@ -388,24 +612,17 @@ static int iir_cmd_set_data(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdat
 		break;
 	case SOF_CTRL_CMD_BINARY:
 		trace_eq_iir("EIb");
-		/* Check and free old config */
-		eq_iir_free_parameters(&cd->config);
-
-		/* Copy new config, need to decode data to know the size */
+		/* Check new config, need to decode data to know the size */
 		bs = cdata->data->size;
 		if ((bs > SOF_EQ_IIR_MAX_SIZE) || (bs < 1))
 			return -EINVAL;
 
-		/* Allocate and make a copy of the blob and setup IIR */
-		cd->config = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, bs);
-		if (cd->config == NULL)
+		/* Share cached copy of the blob */
+		config = coef_get(cdata->data->data, bs);
+		if (config == NULL)
 			return -EINVAL;
 
-		memcpy(cd->config, cdata->data->data, bs);
-		/* Initialize all channels, the actual number of channels may
-		 * not be set yet.
-		 */
-		ret = eq_iir_setup(cd->iir, cd->config, PLATFORM_MAX_CHANNELS);
+		ret = eq_iir_apply(dev, config);
 		break;
 	default:
 		trace_eq_iir_error("ec1");
@@ -438,8 +655,28 @@ static int eq_iir_cmd(struct comp_dev *dev, int cmd, void *data)
 
 static int eq_iir_trigger(struct comp_dev *dev, int cmd)
 {
+	int ret;
+
 	trace_eq_iir("trg");
 
+	/* delay lines are not kept over suspend */
+	switch (cmd) {
+	case COMP_TRIGGER_SUSPEND:
+		eq_iir_stop(dev);
+		break;
+	case COMP_TRIGGER_RESUME:
+		if (dev->state == COMP_STATE_PREPARE ||
+		    dev->state == COMP_STATE_PAUSED ||
+		    dev->state == COMP_STATE_ACTIVE) {
+			ret = eq_iir_start(dev);
+			if (ret < 0)
+				return ret;
+		}
+		break;
+	default:
+		break;
+	}
+
 	return comp_set_state(dev, cmd);
 }
 
@@ -468,6 +705,10 @@ static int eq_iir_copy(struct comp_dev *dev)
 		return -EIO;	/* xrun */
 	}
 
+	/* Swap in a new response at the period boundary */
+	if (cd->config_new != NULL)
+		eq_iir_swap(dev);
+
 	cd->eq_iir_func(dev, source, sink, dev->frames);
 
 	/* calc new free and available */
@@ -488,19 +729,23 @@ static int eq_iir_prepare(struct comp_dev *dev)
 	if (ret < 0)
 		return ret;
 
-	cd->eq_iir_func = eq_iir_s32_default;
+	/* delay lines of a previous prepare are kept if the channels match */
+	eq_iir_unstage(dev);
 
 	/* Initialize EQ. Note that if EQ has not received command to
 	 * configure the response the EQ prepare returns an error that
 	 * interrupts pipeline prepare for downstream.
 	 */
 	if (cd->config == NULL) {
+		eq_iir_stop(dev);
 		comp_set_state(dev, COMP_TRIGGER_RESET);
 		return -EINVAL;
 	}
 
-	ret = eq_iir_setup(cd->iir, cd->config, dev->params.channels);
+	/* Delay lines are allocated for the active response */
+	ret = eq_iir_start(dev);
 	if (ret < 0) {
+		eq_iir_stop(dev);
 		comp_set_state(dev, COMP_TRIGGER_RESET);
 		return ret;
 	}
@@ -515,10 +760,9 @@ static int eq_iir_reset(struct comp_dev *dev)
 
 	trace_eq_iir("ERe");
 
-	eq_iir_free_delaylines(cd->iir);
+	eq_iir_stop(dev);
 	eq_iir_free_parameters(&cd->config);
 
-	cd->eq_iir_func = eq_iir_s32_default;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		iir_reset_df2t(&cd->iir[i]);
 
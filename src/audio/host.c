@@ -149,6 +149,9 @@ static void host_dma_cb(void *data, uint32_t type, struct dma_sg_elem *next)
 	hd->report_pos += local_elem->size;
 	hd->posn.host_posn += local_elem->size;
 
+	/* publish position for hosts polling the stream status */
+	ipc_stream_status_host(dev, hd->posn.host_posn);
+
 	/* NO_IRQ mode if host_period_size == 0 */
 	if (dev->params.host_period_bytes != 0 &&
 		hd->report_pos >= dev->params.host_period_bytes) {
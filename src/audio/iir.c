@@ -118,7 +118,7 @@ int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x)
 	return out;
 }
 
-size_t iir_init_coef_df2t(struct iir_state_df2t *iir, int32_t config[])
+int iir_init_coef_df2t(struct iir_state_df2t *iir, int32_t config[])
 {
 	iir->mute = 0;
 	iir->biquads = (int) config[0];
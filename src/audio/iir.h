@@ -64,7 +64,7 @@ struct iir_biquad_df2t {
 
 int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x);
 
-size_t iir_init_coef_df2t(struct iir_state_df2t *iir, int32_t config[]);
+int iir_init_coef_df2t(struct iir_state_df2t *iir, int32_t config[]);
 
 void iir_init_delay_df2t(struct iir_state_df2t *iir, int64_t **delay);
 
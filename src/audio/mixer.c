@@ -36,6 +36,7 @@
 #include <sof/stream.h>
 #include <sof/alloc.h>
 #include <sof/audio/component.h>
+#include "mixer.h"
 
 #define trace_mixer(__e)	trace_event(TRACE_CLASS_MIXER, __e)
 #define tracev_mixer(__e)	tracev_event(TRACE_CLASS_MIXER, __e)
@@ -48,36 +49,6 @@ struct mixer_data {
 		struct comp_buffer **sources, uint32_t count, uint32_t frames);
 };
 
-/* mix N PCM source streams to one sink stream */
-static void mix_n(struct comp_dev *dev, struct comp_buffer *sink,
-	struct comp_buffer **sources, uint32_t num_sources, uint32_t frames)
-{
-	int32_t *src;
-	int32_t *dest = sink->w_ptr;
-	int32_t count;
-	int64_t val[2];
-	int i;
-	int j;
-
-	count = frames * dev->params.channels;
-
-	for (i = 0; i < count; i += 2) {
-		val[0] = 0;
-		val[1] = 0;
-		for (j = 0; j < num_sources; j++) {
-			src = sources[j]->r_ptr;
-
-			/* TODO: clamp */
-			val[0] += src[i];
-			val[1] += src[i + 1];
-		}
-
-		/* TODO: best place for attenuation ? */
-		dest[i] = (val[0] >> (num_sources >> 1));
-		dest[i + 1] = (val[1] >> (num_sources >> 1));
-	}
-}
-
 static struct comp_dev *mixer_new(struct sof_ipc_comp *comp)
 {
 	struct comp_dev *dev;
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+#include <sof/audio/component.h>
+
+/* The mixing function is inlined to optimize execution speed */
+
+/* mix N PCM source streams to one sink stream */
+static inline void mix_n(struct comp_dev *dev, struct comp_buffer *sink,
+	struct comp_buffer **sources, uint32_t num_sources, uint32_t frames)
+{
+	int32_t *src;
+	int32_t *dest = sink->w_ptr;
+	int32_t count;
+	int64_t val[2];
+	int i;
+	int j;
+
+	count = frames * dev->params.channels;
+
+	for (i = 0; i < count; i += 2) {
+		val[0] = 0;
+		val[1] = 0;
+		for (j = 0; j < num_sources; j++) {
+			src = sources[j]->r_ptr;
+
+			/* TODO: clamp */
+			val[0] += src[i];
+			val[1] += src[i + 1];
+		}
+
+		/* TODO: best place for attenuation ? */
+		dest[i] = (val[0] >> (num_sources >> 1));
+		dest[i + 1] = (val[1] >> (num_sources >> 1));
+	}
+}
+
+#endif
@@ -44,6 +44,7 @@
 #include <platform/platform.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
+#include <sof/math/numbers.h>
 
 struct pipeline_data {
 	spinlock_t lock;
@@ -192,6 +193,187 @@ static void disconnect_downstream(struct pipeline *p, struct comp_dev *start,
 	spin_unlock(&current->lock);
 }
 
+/* call func on every buffer owned by pipeline reached from current, returns
+ * the last error from func
+ */
+static int pipeline_buffer_walk(struct pipeline *p, struct comp_dev *current,
+	int downstream, int (*func)(struct pipeline *p,
+	struct comp_buffer *buffer))
+{
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+	struct comp_dev *next;
+	int err = 0;
+	int ret;
+
+	list_for_item(clist, downstream ? &current->bsink_list :
+		&current->bsource_list) {
+
+		if (downstream) {
+			buffer = container_of(clist, struct comp_buffer,
+				source_list);
+			next = buffer->sink;
+		} else {
+			buffer = container_of(clist, struct comp_buffer,
+				sink_list);
+			next = buffer->source;
+		}
+
+		if (buffer->ipc_buffer.comp.pipeline_id ==
+			p->ipc_pipe.pipeline_id) {
+			ret = func(p, buffer);
+			if (ret < 0)
+				err = ret;
+		}
+
+		/* don't walk into other pipelines */
+		if (next->comp.pipeline_id == p->ipc_pipe.pipeline_id) {
+			ret = pipeline_buffer_walk(p, next, downstream, func);
+			if (ret < 0)
+				err = ret;
+		}
+	}
+
+	return err;
+}
+
+static int pipeline_buffers(struct pipeline *p,
+	int (*func)(struct pipeline *p, struct comp_buffer *buffer))
+{
+	int down;
+	int up;
+
+	down = pipeline_buffer_walk(p, p->sched_comp, 1, func);
+	up = pipeline_buffer_walk(p, p->sched_comp, 0, func);
+
+	return down < 0 ? down : up;
+}
+
+/* reserve arena space for buffer data, buffers joining pipelines can still
+ * be used by the other pipeline so they keep their own allocation
+ */
+static int buffer_arena_reserve(struct pipeline *p,
+	struct comp_buffer *buffer)
+{
+	if (buffer->arena ||
+		buffer->source->comp.pipeline_id != p->ipc_pipe.pipeline_id ||
+		buffer->sink->comp.pipeline_id != p->ipc_pipe.pipeline_id)
+		return 0;
+
+	buffer->arena = 1;
+	arena_reserve(&p->arena, buffer->ipc_buffer.caps, buffer->alloc_size);
+	return 0;
+}
+
+/* free the data buffer_new() allocated for a buffer going into the arena,
+ * buffers are not in use yet
+ */
+static int buffer_arena_unplace(struct pipeline *p,
+	struct comp_buffer *buffer)
+{
+	if (!buffer->arena || buffer->addr == NULL)
+		return 0;
+
+	rfree(buffer->addr);
+	buffer->addr = NULL;
+	buffer->end_addr = NULL;
+	buffer->r_ptr = NULL;
+	buffer->w_ptr = NULL;
+	return 0;
+}
+
+/* carve buffer data from the arena */
+static int buffer_arena_place(struct pipeline *p, struct comp_buffer *buffer)
+{
+	if (!buffer->arena || buffer->addr != NULL)
+		return 0;
+
+	buffer->addr = arena_alloc(&p->arena, buffer->alloc_size);
+	buffer->end_addr = buffer->addr + buffer->size;
+	buffer_reset_pos(buffer);
+	return 0;
+}
+
+/* no heap can fit the arena, give buffer its own allocation again */
+static int buffer_arena_fallback(struct pipeline *p,
+	struct comp_buffer *buffer)
+{
+	if (!buffer->arena)
+		return 0;
+
+	buffer->arena = 0;
+	buffer->addr = rballoc(RZONE_BUFFER, buffer->ipc_buffer.caps,
+		buffer_data_size(buffer->alloc_size));
+	if (buffer->addr == NULL) {
+		trace_pipe_error("eaf");
+		return -ENOMEM;
+	}
+
+	buffer->end_addr = buffer->addr + buffer->size;
+	buffer_reset_pos(buffer);
+	return 0;
+}
+
+/* detach buffer from the arena before it is freed */
+static int buffer_arena_release(struct pipeline *p,
+	struct comp_buffer *buffer)
+{
+	if (!buffer->arena)
+		return 0;
+
+	buffer->arena = 0;
+	if (arena_contains(&p->arena, buffer->addr)) {
+		buffer->addr = NULL;
+		buffer->end_addr = NULL;
+		buffer->r_ptr = NULL;
+		buffer->w_ptr = NULL;
+	}
+	return 0;
+}
+
+/* allocate all pipeline buffers from one arena so the period copy walks
+ * continuous memory and pipeline free leaves no holes in the buffer heap.
+ * The data buffer_new() allocated is freed before the arena is allocated,
+ * so heap use doesn't peak at twice the buffer size and the arena can use
+ * that space. Buffers get their own allocation back if no heap can fit the
+ * arena.
+ */
+static int pipeline_arena_init(struct pipeline *p)
+{
+	pipeline_buffers(p, buffer_arena_reserve);
+	if (p->arena.size == 0)
+		return 0;
+
+	pipeline_buffers(p, buffer_arena_unplace);
+
+	if (arena_init(&p->arena) < 0) {
+		trace_pipe("arf");
+		trace_value(p->arena.size);
+		arena_free(&p->arena);
+		return pipeline_buffers(p, buffer_arena_fallback);
+	}
+
+	return pipeline_buffers(p, buffer_arena_place);
+}
+
+/* keep buffers that are not in the arena out of the SRAM banks used by the
+ * input of the component producing them, so that DMA and the core or two
+ * cores can access both at the same time. Buffers in use are not moved.
+ */
+static int buffer_bank_place(struct pipeline *p, struct comp_buffer *buffer)
+{
+	struct comp_dev *comp = buffer->source;
+
+	if (buffer->arena || buffer->shared ||
+		list_is_empty(&comp->bsource_list) ||
+		comp->state > COMP_STATE_READY ||
+		buffer->sink->state > COMP_STATE_READY)
+		return 0;
+
+	return buffer_place_bank(buffer, list_first_item(&comp->bsource_list,
+		struct comp_buffer, sink_list));
+}
+
 /* update pipeline state based on cmd */
 static void pipeline_trigger_sched_comp(struct pipeline *p,
 					struct comp_dev *comp, int cmd)
@@ -257,6 +439,10 @@ struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 	spinlock_init(&p->lock);
 	memcpy(&p->ipc_pipe, pipe_desc, sizeof(*pipe_desc));
 
+	/* single period per wakeup unless topology asks for batching */
+	p->batch_periods = pipe_desc->periods_per_sched ?
+		pipe_desc->periods_per_sched : 1;
+
 	return p;
 }
 
@@ -272,8 +458,15 @@ int pipeline_free(struct pipeline *p)
 	}
 
 	/* remove from any scheduling */
+	schedule_task_depend_free(&p->pipe_task);
 	schedule_task_free(&p->pipe_task);
 
+	/* release all buffer data in one go */
+	if (p->arena.base) {
+		pipeline_buffers(p, buffer_arena_release);
+		arena_free(&p->arena);
+	}
+
 	/* disconnect components */
 	disconnect_downstream(p, p->sched_comp, p->sched_comp);
 	disconnect_upstream(p, p->sched_comp, p->sched_comp);
@@ -286,6 +479,8 @@ int pipeline_free(struct pipeline *p)
 
 int pipeline_complete(struct pipeline *p)
 {
+	int ret;
+
 	/* now walk downstream and upstream form "start" component and
 	  complete component task and pipeline init */
 
@@ -300,6 +495,19 @@ int pipeline_complete(struct pipeline *p)
 
 	connect_downstream(p, p->sched_comp, p->sched_comp);
 	connect_upstream(p, p->sched_comp, p->sched_comp);
+
+	ret = pipeline_arena_init(p);
+	if (ret < 0) {
+		trace_pipe_error("epa");
+		return ret;
+	}
+
+	ret = pipeline_buffers(p, buffer_bank_place);
+	if (ret < 0) {
+		trace_pipe_error("epp");
+		return ret;
+	}
+
 	p->status = COMP_STATE_READY;
 	return 0;
 }
@@ -505,6 +713,23 @@ static int component_op_upstream(struct op_data *op_data,
 	return err;
 }
 
+/* get period size in bytes for component */
+static inline uint32_t comp_period_bytes(struct comp_dev *dev)
+{
+	return dev->frames * comp_frame_bytes(dev);
+}
+
+/* reset buffer positions, stage buffers shared with another core are
+ * preloaded with a period of silence as the consumer runs a period behind */
+static void component_prepare_buffer(struct comp_buffer *buffer)
+{
+	buffer_reset_pos(buffer);
+
+	if (buffer->shared)
+		comp_update_buffer_produce(buffer,
+			comp_period_bytes(buffer->source));
+}
+
 /* walk the graph upstream from start component in any pipeline and prepare
  * the buffer context for each inactive component */
 static int component_prepare_buffers_upstream(struct comp_dev *start,
@@ -516,7 +741,7 @@ static int component_prepare_buffers_upstream(struct comp_dev *start,
 	/* component copy/process to downstream */
 	if (current != start && buffer != NULL) {
 
-		buffer_reset_pos(buffer);
+		component_prepare_buffer(buffer);
 
 		/* stop going downstream if we reach an end point in this pipeline */
 		if (current->is_endpoint)
@@ -556,7 +781,7 @@ static int component_prepare_buffers_downstream(struct comp_dev *start,
 	/* component copy/process to downstream */
 	if (current != start && buffer != NULL) {
 
-		buffer_reset_pos(buffer);
+		component_prepare_buffer(buffer);
 
 		/* stop going downstream if we reach an end point in this pipeline */
 		if (current->is_endpoint)
@@ -585,6 +810,115 @@ static int component_prepare_buffers_downstream(struct comp_dev *start,
 	return err;
 }
 
+/* can component copy be called again while its last period is still in
+ * flight ? Without a DMA gateway host_copy() reconfigures and starts the
+ * host DMA channel for every period, so it must wait for the completion. */
+static int comp_batch_capable(struct comp_dev *dev)
+{
+#if defined CONFIG_DMA_GW
+	return 1;
+#else
+	return dev->comp.type != SOF_COMP_HOST;
+#endif
+}
+
+/* get the number of periods buffer can hold in total (capacity) or can
+ * accept/provide now. Only buffers at DMA or pipeline boundaries are
+ * counted as all other buffers are drained on every period copy. */
+static uint32_t buffer_batch_periods(struct comp_buffer *buffer,
+	struct pipeline *p, int capacity, uint32_t periods)
+{
+	uint32_t period_bytes;
+	uint32_t bytes;
+
+	/* endpoint can only move one period per wakeup */
+	if (!comp_batch_capable(buffer->source) ||
+	    !comp_batch_capable(buffer->sink))
+		return MIN(periods, 1);
+
+	if (buffer->source->is_dma_connected ||
+	    buffer->source->pipeline != p) {
+		/* data arrives asynchronously from DMA or another pipeline */
+		period_bytes = comp_period_bytes(buffer->sink);
+		bytes = buffer->avail;
+	} else if (buffer->sink->is_dma_connected ||
+		   buffer->sink->pipeline != p) {
+		/* data is drained asynchronously by DMA or another pipeline */
+		period_bytes = comp_period_bytes(buffer->source);
+		bytes = buffer->free;
+	} else {
+		return periods;
+	}
+
+	if (period_bytes == 0)
+		return periods;
+
+	/* keep one period for the DMA in flight */
+	if (capacity)
+		return MIN(periods, MAX(buffer->size / period_bytes, 2) - 1);
+
+	return MIN(periods, bytes / period_bytes);
+}
+
+/* walk the pipeline downstream and get the number of periods that can be
+ * copied in a single wakeup */
+static uint32_t pipeline_batch_downstream(struct pipeline *p,
+	struct comp_dev *current, int capacity, uint32_t periods)
+{
+	struct list_item *clist;
+
+	list_for_item(clist, &current->bsink_list) {
+		struct comp_buffer *buffer;
+
+		buffer = container_of(clist, struct comp_buffer, source_list);
+
+		if (!buffer->connected)
+			continue;
+
+		periods = buffer_batch_periods(buffer, p, capacity, periods);
+
+		/* don't go downstream if this sink is from another pipeline */
+		if (buffer->sink->pipeline != p)
+			continue;
+
+		periods = pipeline_batch_downstream(p, buffer->sink, capacity,
+			periods);
+	}
+
+	return periods;
+}
+
+/* get the number of periods pipeline can copy now, or in total when
+ * capacity is set. Always at least 1 so single period pipelines and
+ * XRUN detection behave as before. */
+static uint32_t pipeline_batch_periods(struct pipeline *p, int capacity)
+{
+	struct comp_dev *source = p->source_comp;
+	struct list_item *clist;
+	uint32_t periods = p->ipc_pipe.periods_per_sched;
+
+	if (periods <= 1 || source == NULL)
+		return 1;
+
+	if (!capacity)
+		periods = p->batch_periods;
+
+	/* source endpoint may be joined to another pipeline */
+	list_for_item(clist, &source->bsource_list) {
+		struct comp_buffer *buffer;
+
+		buffer = container_of(clist, struct comp_buffer, sink_list);
+
+		if (buffer->connected)
+			periods = buffer_batch_periods(buffer, p, capacity,
+				periods);
+	}
+
+	periods = pipeline_batch_downstream(p, source, capacity, periods);
+
+	return periods ? periods : 1;
+}
+
 /* prepare the pipeline for usage - preload host buffers here */
 int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
 {
@@ -616,6 +950,14 @@ int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
 		component_prepare_buffers_upstream(dev, dev, NULL);
 	}
 
+	/* size batch to the periods the DMA and join buffers can hold */
+	p->batch_periods = pipeline_batch_periods(p, 1);
+	if (p->batch_periods != MAX(p->ipc_pipe.periods_per_sched, 1)) {
+		trace_pipe("Bat");
+		trace_value((p->ipc_pipe.periods_per_sched << 16) |
+			p->batch_periods);
+	}
+
 out:
 	spin_unlock(&p->lock);
 	return ret;
@@ -729,6 +1071,24 @@ int pipeline_reset(struct pipeline *p, struct comp_dev *host)
 	return ret;
 }
 
+/*
+ * Do the batched cache maintenance for all source buffers of this component
+ * before it consumes them i.e. once per period at the DMA boundary.
+ */
+static int pipeline_comp_copy(struct comp_dev *current)
+{
+	struct pipeline_cache_stats *stats = &current->pipeline->cache_stats;
+	struct comp_buffer *buffer;
+	struct list_item *clist;
+
+	list_for_item(clist, &current->bsource_list) {
+		buffer = container_of(clist, struct comp_buffer, sink_list);
+		stats->ops += buffer_cache_sync(buffer);
+	}
+
+	return comp_copy(current);
+}
+
 /*
  * Upstream Copy and Process.
  *
@@ -780,7 +1140,7 @@ static int pipeline_copy_from_upstream(struct comp_dev *start,
 
 copy:
 	/* we are at the upstream end point component so copy the buffers */
-	err = comp_copy(current);
+	err = pipeline_comp_copy(current);
 
 	/* return back downstream */
 	tracev_pipe("CD+");
@@ -811,7 +1171,7 @@ static int pipeline_copy_to_downstream(struct comp_dev *start,
 
 	/* component copy/process to downstream */
 	if (current != start) {
-		err = comp_copy(current);
+		err = pipeline_comp_copy(current);
 
 		/* stop going downstream if we reach an end point in this pipeline */
 		if (current->is_endpoint)
@@ -1035,8 +1395,12 @@ void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
 	if (dev->state != COMP_STATE_ACTIVE)
 		return;
 
+	/* count it in the stream status also when host doesn't get IPCs */
+	ipc_stream_status_xrun(dev, bytes);
+
 	memset(&posn, 0, sizeof(posn));
 	p->xrun_bytes = posn.xrun_size = bytes;
+	p->xrun_comp = dev;
 	posn.xrun_comp_id = dev->comp.id;
 
 	if (dev->params.direction == SOF_IPC_STREAM_PLAYBACK) {
@@ -1046,12 +1410,68 @@ void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
 	}
 }
 
-/* recover the pipeline from a XRUN condition */
-static int pipeline_xrun_recover(struct pipeline *p)
+/*
+ * Recover from XRUN by re-aligning the XRUN buffer only. Components are still
+ * active and their state is valid, so on underrun we insert silence for the
+ * missing span and on overrun we drop the oldest span. Only the pipeline end
+ * of the buffer is moved, so buffers feeding or drained by a DAI DMA can be
+ * re-aligned. The end that is moved must not be driven by DMA though, e.g.
+ * a host DMA buffer connected directly to a DAI, as the DMA has its own
+ * position for it.
+ */
+static int pipeline_xrun_recover_fast(struct pipeline *p)
 {
-	int ret;
+	struct comp_dev *dev = p->xrun_comp;
+	struct comp_buffer *buffer;
+	uint32_t bytes;
 
-	trace_pipe_error("pxr");
+	/* XRUN details are needed to re-align */
+	if (dev == NULL || p->xrun_bytes == 0 ||
+	    dev->state != COMP_STATE_ACTIVE)
+		return -EINVAL;
+
+	if (p->xrun_bytes < 0) {
+		/* underrun, insert silence for the missing span at the
+		 * producer end of the buffer the XRUN comp reads from
+		 */
+		if (list_is_empty(&dev->bsource_list))
+			return -EINVAL;
+
+		buffer = list_first_item(&dev->bsource_list,
+			struct comp_buffer, sink_list);
+		bytes = -p->xrun_bytes;
+
+		if (buffer->source->is_dma_connected || bytes > buffer->free)
+			return -EINVAL;
+
+		buffer_produce_silence(buffer, bytes);
+
+		/* sink may be a DAI DMA, write back the silence now */
+		p->cache_stats.ops += buffer_cache_sync(buffer);
+	} else {
+		/* overrun, drop the oldest span at the consumer end of the
+		 * buffer the XRUN comp writes to
+		 */
+		if (list_is_empty(&dev->bsink_list))
+			return -EINVAL;
+
+		buffer = list_first_item(&dev->bsink_list,
+			struct comp_buffer, source_list);
+		bytes = p->xrun_bytes;
+
+		if (buffer->sink->is_dma_connected || bytes > buffer->avail)
+			return -EINVAL;
+
+		comp_update_buffer_consume(buffer, bytes);
+	}
+
+	return 0;
+}
+
+/* recover from XRUN by stopping, preparing and restarting the pipeline */
+static int pipeline_xrun_recover_full(struct pipeline *p)
+{
+	int ret;
 
 	/* notify all pipeline comps we are in XRUN */
 	ret = pipeline_trigger(p, p->source_comp, COMP_TRIGGER_XRUN);
@@ -1078,6 +1498,46 @@ static int pipeline_xrun_recover(struct pipeline *p)
 	return 0;
 }
 
+/* recover the pipeline from a XRUN condition, returns 1 if the pipeline is
+ * still running after a lightweight recovery or 0 if it was restarted
+ */
+static int pipeline_xrun_recover(struct pipeline *p)
+{
+	struct pipeline_xrun_stats *stats = &p->xrun_stats;
+	uint64_t start = platform_timer_get(platform_timer);
+	uint64_t ticks;
+	int ret;
+
+	trace_pipe_error("pxr");
+
+	/* try lightweight recovery first */
+	ret = pipeline_xrun_recover_fast(p);
+	if (ret == 0) {
+		stats->fast_count++;
+		ret = 1;
+	} else {
+		ret = pipeline_xrun_recover_full(p);
+		if (ret < 0)
+			return ret;
+		stats->full_count++;
+	}
+
+	p->xrun_bytes = 0;
+	p->xrun_comp = NULL;
+
+	/* recovery time stats */
+	ticks = platform_timer_get(platform_timer) - start;
+	stats->total_ticks += ticks;
+	if (ticks > stats->max_ticks)
+		stats->max_ticks = ticks;
+	ipc_stream_status_recover(p);
+
+	tracev_pipe("pxt");
+	tracev_value(ticks);
+
+	return ret;
+}
+
 /* notify pipeline that this component requires buffers emptied/filled */
 void pipeline_schedule_copy(struct pipeline *p, uint64_t start)
 {
@@ -1098,10 +1558,66 @@ void pipeline_schedule_cancel(struct pipeline *p)
 	schedule_task_complete(&p->pipe_task);
 }
 
+static void pipeline_stage_sync_downstream(struct pipeline *p,
+	struct comp_dev *current)
+{
+	struct list_item *clist;
+
+	list_for_item(clist, &current->bsink_list) {
+		struct comp_buffer *buffer;
+
+		buffer = container_of(clist, struct comp_buffer, source_list);
+
+		if (!buffer->connected)
+			continue;
+
+		/* we produce into stages on other pipelines */
+		if (buffer->sink->pipeline != p) {
+			buffer_stage_sync(buffer, 0);
+			continue;
+		}
+
+		pipeline_stage_sync_downstream(p, buffer->sink);
+	}
+}
+
+/* refresh buffers shared with pipeline stages running on other cores */
+static void pipeline_stage_sync(struct pipeline *p)
+{
+	struct comp_dev *source = p->source_comp;
+	struct list_item *clist;
+
+	/* we consume from stages on other pipelines */
+	list_for_item(clist, &source->bsource_list) {
+		struct comp_buffer *buffer;
+
+		buffer = container_of(clist, struct comp_buffer, sink_list);
+
+		if (buffer->connected && buffer->source->pipeline != p)
+			buffer_stage_sync(buffer, 1);
+	}
+
+	pipeline_stage_sync_downstream(p, source);
+}
+
+/* copy one period from upstream source endpoints to downstream */
+static int pipeline_copy_period(struct comp_dev *dev)
+{
+	int err;
+
+	err = pipeline_copy_from_upstream(dev, dev);
+	if (err < 0)
+		return err;
+
+	return pipeline_copy_to_downstream(dev, dev);
+}
+
 static void pipeline_task(void *arg)
 {
 	struct pipeline *p = arg;
 	struct comp_dev *dev = p->sched_comp;
+	uint32_t periods;
+	uint32_t i;
 	int err;
 
 	tracev_pipe("PWs");
@@ -1111,24 +1627,48 @@ static void pipeline_task(void *arg)
 		err = pipeline_xrun_recover(p);
 		if (err < 0)
 			return;  /* failed - host will stop this pipeline */
-		goto sched;
-	}
 
-	/* copy data from upstream source endpoints to downstream endpoints */
-	err = pipeline_copy_from_upstream(dev, dev);
-	if (err < 0) {
-		err = pipeline_xrun_recover(p);
-		if (err < 0)
-			return;  /* failed - host will stop this pipeline */
-		goto sched;
+		/* pipeline was restarted, else buffer is re-aligned and we
+		 * copy the next period now to refill it
+		 */
+		if (err == 0)
+			goto sched;
 	}
 
-	err = pipeline_copy_to_downstream(dev, dev);
-	if (err < 0) {
-		err = pipeline_xrun_recover(p);
-		if (err < 0)
-			return;  /* failed - host will stop this pipeline */
-		goto sched;
+	/* get pointers and data from stages on other cores */
+	if (p->shared_buffers)
+		pipeline_stage_sync(p);
+
+	/* batched pipelines copy as many periods as endpoints allow */
+	periods = pipeline_batch_periods(p, 0);
+
+	for (i = 0; i < periods; i++) {
+
+		err = pipeline_copy_period(dev);
+		if (err < 0) {
+			err = pipeline_xrun_recover(p);
+			if (err < 0)
+				return;  /* failed - host will stop this pipeline */
+
+			/* pipeline was restarted, else buffer is re-aligned
+			 * and we copy the period again to refill it
+			 */
+			if (err == 0)
+				goto sched;
+
+			/* a further XRUN is left for the next run to recover */
+			err = pipeline_copy_period(dev);
+			if (err < 0)
+				goto sched;
+		}
+
+		/* period boundary - update cache maintenance stats */
+		p->cache_stats.period_ops = p->cache_stats.ops;
+		if (p->cache_stats.ops > p->cache_stats.max_ops)
+			p->cache_stats.max_ops = p->cache_stats.ops;
+		p->cache_stats.ops = 0;
+		tracev_pipe("PCo");
+		tracev_value(p->cache_stats.period_ops);
 	}
 
 sched:
@@ -1137,7 +1677,8 @@ sched:
 	/* now reschedule the task */
 	/* TODO: add in scheduling cost and any timer drift */
 	if (p->ipc_pipe.timer)
-		pipeline_schedule_copy(p, p->ipc_pipe.deadline);
+		pipeline_schedule_copy(p,
+			p->ipc_pipe.deadline * p->batch_periods);
 }
 
 /* init pipeline */
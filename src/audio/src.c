@@ -50,9 +50,16 @@
 
 #if SRC_SHORT
 #include <sof/audio/coefficients/src/src_tiny_int16_define.h>
-#include <sof/audio/coefficients/src/src_tiny_int16_table.h>
 #else
 #include <sof/audio/coefficients/src/src_std_int32_define.h>
+#endif
+
+/* table generated by configure --with-src-rates has only the needed sets */
+#if defined CONFIG_SRC_RATES
+#include <src_coef_select.h>
+#elif SRC_SHORT
+#include <sof/audio/coefficients/src/src_tiny_int16_table.h>
+#else
 #include <sof/audio/coefficients/src/src_std_int32_table.h>
 #endif
 
@@ -72,7 +79,7 @@
 struct comp_data {
 	struct polyphase_src src;
 	struct src_param param;
-	int32_t *delay_lines;
+	struct comp_delay delay;	/* stage buffer and delay lines */
 	uint32_t sink_rate;
 	uint32_t source_rate;
 	int32_t *sbuf_w_ptr;
@@ -367,8 +374,8 @@ static void src_2s_s32_default(struct comp_dev *dev,
 	struct comp_data *cd = comp_get_drvdata(dev);
 	int32_t *dest = (int32_t *)sink->w_ptr;
 	int32_t *src = (int32_t *)source->r_ptr;
-	int32_t *sbuf_addr = cd->delay_lines;
-	int32_t *sbuf_end_addr = &cd->delay_lines[cd->param.sbuf_length];
+	int32_t *sbuf_addr = cd->delay.data;
+	int32_t *sbuf_end_addr = sbuf_addr + cd->param.sbuf_length;
 	int32_t sbuf_size = cd->param.sbuf_length * sizeof(int32_t);
 	int nch = dev->params.channels;
 	int sbuf_free = cd->param.sbuf_length - cd->sbuf_avail;
@@ -566,7 +573,6 @@ static struct comp_dev *src_new(struct sof_ipc_comp *comp)
 
 	comp_set_drvdata(dev, cd);
 
-	cd->delay_lines = NULL;
 	cd->src_func = src_2s_s32_default;
 	cd->polyphase_func = src_polyphase_stage_cir;
 	src_polyphase_reset(&cd->src);
@@ -575,6 +581,69 @@ static struct comp_dev *src_new(struct sof_ipc_comp *comp)
 	return dev;
 }
 
+/* allocate delay lines for the active conversion and init the SRC, delay
+ * lines of a previous start are reused if the size matches
+ */
+static int src_start(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t *sbuf;
+	int n;
+	int ret;
+
+	ret = comp_delay_resize(&cd->delay, sizeof(int32_t) * cd->param.total);
+	if (ret < 0) {
+		trace_src_error("sr3");
+		return ret;
+	}
+
+	/* Initialize SRC for actual sample rate */
+	sbuf = cd->delay.data;
+	n = src_polyphase_init(&cd->src, &cd->param,
+		sbuf + cd->param.sbuf_length);
+
+	/* Reset stage buffer */
+	cd->sbuf_r_ptr = sbuf;
+	cd->sbuf_w_ptr = sbuf;
+	cd->sbuf_avail = 0;
+
+	switch (n) {
+	case 0:
+		cd->src_func = src_copy_s32_default; /* 1:1 fast copy */
+		break;
+	case 1:
+		cd->src_func = src_1s_s32_default; /* Simpler 1 stage SRC */
+		break;
+	case 2:
+		cd->src_func = src_2s_s32_default; /* Default 2 stage SRC */
+		break;
+	default:
+		/* This is possibly due to missing coefficients for
+		 * requested rates combination. Sink audio will be
+		 * muted if copy() is run.
+		 */
+		trace_src("SFa");
+		cd->src_func = src_fallback;
+		comp_delay_free(&cd->delay);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* release delay lines, SRC must be started again before copy */
+static void src_stop(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	comp_delay_free(&cd->delay);
+	src_polyphase_reset(&cd->src);
+	cd->src_func = src_2s_s32_default;
+	cd->sbuf_r_ptr = NULL;
+	cd->sbuf_w_ptr = NULL;
+	cd->sbuf_avail = 0;
+}
+
 static void src_free(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
@@ -582,8 +651,7 @@ static void src_free(struct comp_dev *dev)
 	trace_src("fre");
 
 	/* Free dynamically reserved buffers for SRC algorithm */
-	if (!cd->delay_lines)
-		rfree(cd->delay_lines);
+	src_stop(dev);
 
 	rfree(cd);
 	rfree(dev);
@@ -598,11 +666,8 @@ static int src_params(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *sink;
 	struct comp_buffer *source;
-	size_t delay_lines_size;
 	uint32_t source_rate;
 	uint32_t sink_rate;
-	int32_t *buffer_start;
-	int n = 0;
 	int err;
 	int frames_is_for_source;
 	int q;
@@ -641,7 +706,7 @@ static int src_params(struct comp_dev *dev)
 		frames_is_for_source = 1;
 	}
 
-	/* Allocate needed memory for delay lines */
+	/* Calculate needed memory for delay lines */
 	err = src_buffer_lengths(&cd->param, source_rate, sink_rate,
 		params->channels, dev->frames, frames_is_for_source);
 	if (err < 0) {
@@ -653,56 +718,12 @@ static int src_params(struct comp_dev *dev)
 		return err;
 	}
 
-	delay_lines_size = sizeof(int32_t) * cd->param.total;
-	if (delay_lines_size == 0) {
+	/* Delay lines are allocated in prepare, just check the size here */
+	if (cd->param.total == 0) {
 		trace_src_error("sr2");
 		return -EINVAL;
 	}
 
-	/* free any existing delay lines. TODO reuse if same size */
-	if (!cd->delay_lines)
-		rfree(cd->delay_lines);
-
-	cd->delay_lines = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
-		delay_lines_size);
-	if (!cd->delay_lines) {
-		trace_src_error("sr3");
-		trace_error_value(delay_lines_size);
-		return -EINVAL;
-	}
-
-	/* Clear all delay lines here */
-	memset(cd->delay_lines, 0, delay_lines_size);
-	buffer_start = cd->delay_lines + cd->param.sbuf_length;
-
-	/* Initialize SRC for actual sample rate */
-	n = src_polyphase_init(&cd->src, &cd->param, buffer_start);
-
-	/* Reset stage buffer */
-	cd->sbuf_r_ptr = cd->delay_lines;
-	cd->sbuf_w_ptr = cd->delay_lines;
-	cd->sbuf_avail = 0;
-
-	switch (n) {
-	case 0:
-		cd->src_func = src_copy_s32_default; /* 1:1 fast copy */
-		break;
-	case 1:
-		cd->src_func = src_1s_s32_default; /* Simpler 1 stage SRC */
-		break;
-	case 2:
-		cd->src_func = src_2s_s32_default; /* Default 2 stage SRC */
-		break;
-	default:
-		/* This is possibly due to missing coefficients for
-		 * requested rates combination. Sink audio will be
-		 * muted if copy() is run.
-		 */
-		trace_src("SFa");
-		cd->src_func = src_fallback;
-		return -EINVAL;
-	}
-
 	/* Calculate period size based on config. First make sure that
 	 * frame_bytes is set.
 	 */
@@ -760,8 +781,30 @@ static int src_cmd(struct comp_dev *dev, int cmd, void *data)
 
 static int src_trigger(struct comp_dev *dev, int cmd)
 {
+	int ret;
+
 	trace_src("trg");
 
+	/* don't hold the delay lines while suspended, the stream restarts
+	 * from a clean SRC state on resume.
+	 */
+	switch (cmd) {
+	case COMP_TRIGGER_SUSPEND:
+		src_stop(dev);
+		break;
+	case COMP_TRIGGER_RESUME:
+		if (dev->state == COMP_STATE_PREPARE ||
+		    dev->state == COMP_STATE_PAUSED ||
+		    dev->state == COMP_STATE_ACTIVE) {
+			ret = src_start(dev);
+			if (ret < 0)
+				return ret;
+		}
+		break;
+	default:
+		break;
+	}
+
 	return comp_set_state(dev, cmd);
 }
 
@@ -829,19 +872,28 @@ static int src_copy(struct comp_dev *dev)
 
 static int src_prepare(struct comp_dev *dev)
 {
+	int ret;
+
 	trace_src("pre");
 
-	return comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	ret = src_start(dev);
+	if (ret < 0) {
+		comp_set_state(dev, COMP_TRIGGER_RESET);
+		return ret;
+	}
+
+	return 0;
 }
 
 static int src_reset(struct comp_dev *dev)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-
 	trace_src("SRe");
 
-	cd->src_func = src_2s_s32_default;
-	src_polyphase_reset(&cd->src);
+	src_stop(dev);
 
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
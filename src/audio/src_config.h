@@ -79,6 +79,16 @@
 #define SRC_HIFI3	1
 #define SRC_HIFIEP	0
 #endif
+#elif defined CONFIG_HIFI3_EMU
+/* GCC with HiFi3 intrinsics emulation */
+#define SRC_GENERIC	0
+#define SRC_HIFIEP	0
+#define SRC_HIFI3	1
+#elif defined CONFIG_HIFI2EP_EMU
+/* GCC with HiFi EP intrinsics emulation */
+#define SRC_GENERIC	0
+#define SRC_HIFIEP	1
+#define SRC_HIFI3	0
 #else
 /* GCC */
 #define SRC_GENERIC	1
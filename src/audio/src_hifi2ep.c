@@ -41,8 +41,12 @@
 
 #if SRC_HIFIEP
 
+#if defined __XCC__
 #include <xtensa/config/defs.h>
 #include <xtensa/tie/xt_hifi2.h>
+#else
+#include <arch/xt_hifi2.h>
+#endif
 
 /* HiFi EP has
  * 4x 56 bit registers in register file Q
@@ -151,7 +155,8 @@ static inline void fir_filter(ae_q32s *rp, const void *cp, ae_q32s *wp0,
 		 */
 		for (i = 0; i < taps_div_4; i++) {
 			/* Load two coefficients */
-			coef2 = *coefp++;
+			coef2 = AE_LP16X2F_I(coefp, 0);
+			coefp++;
 
 			/* Load two data samples */
 			AE_LP24F_C(p0, dp0, inc);
@@ -164,7 +169,8 @@ static inline void fir_filter(ae_q32s *rp, const void *cp, ae_q32s *wp0,
 			AE_MULAAFP24S_HH_LL(a0, data2, coef2);
 
 			/* Repeat for next two filter taps */
-			coef2 = *coefp++;
+			coef2 = AE_LP16X2F_I(coefp, 0);
+			coefp++;
 			AE_LP24F_C(p0, dp0, inc);
 			AE_LP24F_C(p1, dp0, inc);
 			data2 = AE_SELP24_LL(p0, p1);
@@ -331,6 +337,8 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 	ae_q56s q;
 	ae_q32s *rp;
 	ae_q32s *wp;
+	ae_q32s *fir_wp;
+	ae_q32s *out_rp;
 	int i;
 	int n;
 	int m;
@@ -347,7 +355,7 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 	const int blk_in_words = nch * cfg->blk_in;
 	const int blk_out_words = nch * cfg->num_of_subfilters;
 	const int sz = sizeof(int32_t);
-	const int n_sz = -sizeof(int32_t);
+	const int n_sz = -(int)sizeof(int32_t);
 	const int rewind_sz = sz * (nch * (cfg->blk_in
 		+ (cfg->num_of_subfilters - 1) * cfg->idm) - nch);
 	const int nch_x_idm_sz = -nch * cfg->idm * sizeof(int32_t);
@@ -366,6 +374,7 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 		/* Setup circular buffer for FIR input data delay */
 		AE_SETCBEGIN0(fir->fir_delay);
 		AE_SETCEND0(fir_end);
+		fir_wp = (ae_q32s *)fir->fir_wp;
 
 		while (m > 0) {
 			/* Number of words until circular wrap */
@@ -377,21 +386,23 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 				q = AE_LQ32F_I((ae_q32s *)s->x_rptr++, 0);
 
 				/* Store to circular buffer, advance pointer */
-				AE_SQ32F_C(q, (ae_q32s *)fir->fir_wp, n_sz);
+				AE_SQ32F_C(q, fir_wp, n_sz);
 			}
 
 			/* Check for wrap */
 			src_circ_inc_wrap(&s->x_rptr, s->x_end_addr, s->x_size);
 		}
 
+		fir->fir_wp = (int32_t *)fir_wp;
+
 		/* Do filter */
 		cp = cfg->coefs; /* Reset to 1st coefficient */
-		rp = (ae_q32s *)fir->fir_wp;
+		rp = fir_wp;
 
 		/* Do circular modification to pointer rp by amount of
 		 * rewind to to data start. Loaded value q is discarded.
 		 */
-		AE_LQ32F_C(q, (ae_q32s *)rp, rewind_sz);
+		AE_LQ32F_C(q, rp, rewind_sz);
 
 		/* Reset FIR write pointer and compute all polyphase
 		 * sub-filters.
@@ -416,6 +427,7 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 		/* Setup circular buffer for SRC out delay access */
 		AE_SETCBEGIN0(fir->out_delay);
 		AE_SETCEND0(out_delay_end);
+		out_rp = (ae_q32s *)fir->out_rp;
 		m = blk_out_words;
 		while (m > 0) {
 			n_wrap_buf = s->y_end_addr - s->y_wptr;
@@ -423,13 +435,14 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 			m -= n_min;
 			for (i = 0; i < n_min; i++) {
 				/* Circular load followed by linear store */
-				AE_LQ32F_C(q, (ae_q32s *)fir->out_rp, sz);
+				AE_LQ32F_C(q, out_rp, sz);
 				AE_SQ32F_I(q, (ae_q32s *)s->y_wptr, 0);
 				s->y_wptr++;
 			}
 			/* Check wrap */
 			src_circ_inc_wrap(&s->y_wptr, s->y_end_addr, s->y_size);
 		}
+		fir->out_rp = (int32_t *)out_rp;
 	}
 }
 
@@ -444,6 +457,8 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 	ae_q56s q;
 	ae_q32s *rp;
 	ae_q32s *wp;
+	ae_q32s *fir_wp;
+	ae_q32s *out_rp;
 	int i;
 	int n;
 	int m;
@@ -460,7 +475,7 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 	const int blk_in_words = nch * cfg->blk_in;
 	const int blk_out_words = nch * cfg->num_of_subfilters;
 	const int sz = sizeof(int32_t);
-	const int n_sz = -sizeof(int32_t);
+	const int n_sz = -(int)sizeof(int32_t);
 	const int rewind_sz = sz * (nch * (cfg->blk_in
 		+ (cfg->num_of_subfilters - 1) * cfg->idm) - nch);
 	const int nch_x_idm_sz = -nch * cfg->idm * sizeof(int32_t);
@@ -479,6 +494,7 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 		/* Setup circular buffer for FIR input data delay */
 		AE_SETCBEGIN0(fir->fir_delay);
 		AE_SETCEND0(fir_end);
+		fir_wp = (ae_q32s *)fir->fir_wp;
 
 		while (m > 0) {
 			/* Number of words without circular wrap */
@@ -496,21 +512,23 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 				/* Store to circular buffer, advance
 				 * write pointer.
 				 */
-				AE_SQ32F_C(q, (ae_q32s *)fir->fir_wp, n_sz);
+				AE_SQ32F_C(q, fir_wp, n_sz);
 			}
 
 			/* Check for wrap */
 			src_circ_inc_wrap(&s->x_rptr, s->x_end_addr, s->x_size);
 		}
 
+		fir->fir_wp = (int32_t *)fir_wp;
+
 		/* Do filter */
 		cp = cfg->coefs; /* Reset to 1st coefficient */
-		rp = (ae_q32s *)fir->fir_wp;
+		rp = fir_wp;
 
 		/* Do circular modification to pointer rp by amount of
 		 * rewind to to data start. Loaded value q is discarded.
 		 */
-		AE_LQ32F_C(q, (ae_q32s *)rp, rewind_sz);
+		AE_LQ32F_C(q, rp, rewind_sz);
 
 		/* Reset FIR output write pointer and compute all polyphase
 		 * sub-filters.
@@ -535,6 +553,7 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 		/* Setup circular buffer for SRC out delay access */
 		AE_SETCBEGIN0(fir->out_delay);
 		AE_SETCEND0(out_delay_end);
+		out_rp = (ae_q32s *)fir->out_rp;
 		m = blk_out_words;
 		while (m > 0) {
 			n_wrap_buf = s->y_end_addr - s->y_wptr;
@@ -544,7 +563,7 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 				/* Circular load for 32 bit sample,
 				 * advance pointer.
 				 */
-				AE_LQ32F_C(q, (ae_q32s *)fir->out_rp, sz);
+				AE_LQ32F_C(q, out_rp, sz);
 
 				/* Store value as shifted right by 8 for
 				 * sign extended 24 bit value, advance pointer.
@@ -556,6 +575,7 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 			/* Check wrap */
 			src_circ_inc_wrap(&s->y_wptr, s->y_end_addr, s->y_size);
 		}
+		fir->out_rp = (int32_t *)out_rp;
 	}
 }
 
@@ -41,8 +41,12 @@
 
 #if SRC_HIFI3
 
+#if defined __XCC__
 #include <xtensa/config/defs.h>
 #include <xtensa/tie/xt_hifi3.h>
+#else
+#include <arch/xt_hifi3.h>
+#endif
 
 /* HiFi3 has
  * 16x 64 bit registers in register file AE_DR
@@ -78,8 +82,8 @@ static inline void fir_filter(ae_f32 *rp, const void *cp, ae_f32 *wp0,
 		/* Move data pointer back by one sample to start from right
 		 * channel sample. Discard read value p0.
 		 */
+		AE_L32_XC(d0, rp, -sizeof(ae_f32));
 		dp = (ae_f32x2 *)rp;
-		AE_L32_XC(d0, (ae_f32 *)dp, -sizeof(ae_f32));
 
 		/* Reset coefficient pointer and clear accumulator */
 		coefp = (ae_f16x4 *)cp;
@@ -216,8 +220,9 @@ static inline void fir_filter(ae_f32 *rp, const void *cp, ae_f32 *wp0,
 		/* Move data pointer back by one sample to start from right
 		 * channel sample. Discard read value p0.
 		 */
-		dp = (ae_f24x2 *)rp;
-		AE_L32F24_XC(d0, (ae_f24 *)dp, -sizeof(ae_f24));
+		dp1 = (ae_f24 *)rp;
+		AE_L32F24_XC(d0, dp1, -sizeof(ae_f24));
+		dp = (ae_f24x2 *)dp1;
 
 		/* Reset coefficient pointer and clear accumulator */
 		coefp = (ae_f24x2 *)cp;
@@ -333,6 +338,10 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 	 *  7x address pointers,
 	 */
 	ae_int32x2 q;
+	ae_int32 *x_rptr;
+	ae_int32 *y_wptr;
+	ae_int32 *fir_wp;
+	ae_int32 *out_rp;
 	ae_f32 *rp;
 	ae_f32 *wp;
 	int i;
@@ -351,7 +360,7 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 	const int blk_in_words = nch * cfg->blk_in;
 	const int blk_out_words = nch * cfg->num_of_subfilters;
 	const int sz = sizeof(int32_t);
-	const int n_sz = -sizeof(int32_t);
+	const int n_sz = -(int)sizeof(int32_t);
 	const int rewind_sz = sz * (nch * (cfg->blk_in
 		+ (cfg->num_of_subfilters - 1) * cfg->idm) - nch);
 	const int nch_x_idm_sz = -nch * cfg->idm * sizeof(int32_t);
@@ -370,29 +379,34 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 		/* Setup circular buffer for FIR input data delay */
 		AE_SETCBEGIN0(fir->fir_delay);
 		AE_SETCEND0(fir_end);
+		fir_wp = (ae_int32 *)fir->fir_wp;
 
 		while (m > 0) {
 			/* Number of words until circular wrap */
 			n_wrap_buf = s->x_end_addr - s->x_rptr;
 			n_min = (m < n_wrap_buf) ? m : n_wrap_buf;
 			m -= n_min;
+			x_rptr = (ae_int32 *)s->x_rptr;
 			for (i = 0; i < n_min; i++) {
 				/* Load 32 bits sample to accumulator,
 				 * advance pointer.
 				 */
-				AE_L32_XP(q, (ae_int32 *)s->x_rptr, sz);
+				AE_L32_XP(q, x_rptr, sz);
 
 				/* Store to circular buffer, advance pointer */
-				AE_S32_L_XC(q, (ae_int32 *)fir->fir_wp, n_sz);
+				AE_S32_L_XC(q, fir_wp, n_sz);
 			}
+			s->x_rptr = (int32_t *)x_rptr;
 
 			/* Check for wrap */
 			src_circ_inc_wrap(&s->x_rptr, s->x_end_addr, s->x_size);
 		}
 
+		fir->fir_wp = (int32_t *)fir_wp;
+
 		/* Do filter */
 		cp = cfg->coefs; /* Reset to 1st coefficient */
-		rp = (ae_f32 *)fir->fir_wp;
+		rp = (ae_f32 *)fir_wp;
 
 		/* Do circular modification to pointer rp by amount of
 		 * rewind to to data start. Loaded value q is discarded.
@@ -422,22 +436,26 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 		/* Setup circular buffer for SRC out delay access */
 		AE_SETCBEGIN0(fir->out_delay);
 		AE_SETCEND0(out_delay_end);
+		out_rp = (ae_int32 *)fir->out_rp;
 		m = blk_out_words;
 		while (m > 0) {
 			n_wrap_buf = s->y_end_addr - s->y_wptr;
 			n_min = (m < n_wrap_buf) ? m : n_wrap_buf;
 			m -= n_min;
+			y_wptr = (ae_int32 *)s->y_wptr;
 			for (i = 0; i < n_min; i++) {
 				/* Circular load followed by linear store,
 				 * advance read and write pointers.
 				 */
-				AE_L32_XC(q, (ae_int32 *)fir->out_rp, sz);
-				AE_S32_L_XP(q, (ae_int32 *)s->y_wptr, sz);
+				AE_L32_XC(q, out_rp, sz);
+				AE_S32_L_XP(q, y_wptr, sz);
 			}
+			s->y_wptr = (int32_t *)y_wptr;
 
 			/* Check wrap */
 			src_circ_inc_wrap(&s->y_wptr, s->y_end_addr, s->y_size);
 		}
+		fir->out_rp = (int32_t *)out_rp;
 	}
 }
 
@@ -449,6 +467,10 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 	 *  7x address pointers,
 	 */
 	ae_int32x2 q;
+	ae_int32 *x_rptr;
+	ae_int32 *y_wptr;
+	ae_int32 *fir_wp;
+	ae_int32 *out_rp;
 	ae_f32 *rp;
 	ae_f32 *wp;
 	int i;
@@ -468,7 +490,7 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 	const int blk_in_words = nch * cfg->blk_in;
 	const int blk_out_words = nch * cfg->num_of_subfilters;
 	const int sz = sizeof(int32_t);
-	const int n_sz = -sizeof(int32_t);
+	const int n_sz = -(int)sizeof(int32_t);
 	const int rewind_sz = sz * (nch * (cfg->blk_in
 		+ (cfg->num_of_subfilters - 1) * cfg->idm) - nch);
 	const int nch_x_idm_sz = -nch * cfg->idm * sizeof(int32_t);
@@ -487,29 +509,33 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 		/* Setup circular buffer for FIR input data delay */
 		AE_SETCBEGIN0(fir->fir_delay);
 		AE_SETCEND0(fir_end);
+		fir_wp = (ae_int32 *)fir->fir_wp;
 
 		while (m > 0) {
 			/* Number of words without circular wrap */
 			n_wrap_buf = s->x_end_addr - s->x_rptr;
 			n_min = (m < n_wrap_buf) ? m : n_wrap_buf;
 			m -= n_min;
+			x_rptr = (ae_int32 *)s->x_rptr;
 			for (i = 0; i < n_min; i++) {
 				/* Load 32 bits sample to accumulator
 				 * and left shift by 8, advance read
 				 * pointer.
 				 */
-				AE_L32_XP(q, (ae_int32 *)s->x_rptr, sz);
-				AE_S32_L_XC(AE_SLAI32(q, 8),
-					(ae_int32 *)fir->fir_wp, n_sz);
+				AE_L32_XP(q, x_rptr, sz);
+				AE_S32_L_XC(AE_SLAI32(q, 8), fir_wp, n_sz);
 			}
+			s->x_rptr = (int32_t *)x_rptr;
 
 			/* Check for wrap */
 			src_circ_inc_wrap(&s->x_rptr, s->x_end_addr, s->x_size);
 		}
 
+		fir->fir_wp = (int32_t *)fir_wp;
+
 		/* Do filter */
 		cp = cfg->coefs; /* Reset to 1st coefficient */
-		rp = (ae_f32 *)fir->fir_wp;
+		rp = (ae_f32 *)fir_wp;
 
 		/* Do circular modification to pointer rp by amount of
 		 * rewind to to data start. Loaded value q is discarded.
@@ -539,28 +565,31 @@ void src_polyphase_stage_cir_s24(struct src_stage_prm *s)
 		/* Setup circular buffer for SRC out delay access */
 		AE_SETCBEGIN0(fir->out_delay);
 		AE_SETCEND0(out_delay_end);
+		out_rp = (ae_int32 *)fir->out_rp;
 		m = blk_out_words;
 		while (m > 0) {
 			n_wrap_buf = s->y_end_addr - s->y_wptr;
 			n_min = (m < n_wrap_buf) ? m : n_wrap_buf;
 			m -= n_min;
+			y_wptr = (ae_int32 *)s->y_wptr;
 			for (i = 0; i < n_min; i++) {
 				/* Circular load for 32 bit sample,
 				 * advance read pointer.
 				 */
-				AE_L32_XC(q, (ae_int32 *)fir->out_rp, sz);
+				AE_L32_XC(q, out_rp, sz);
 
 				/* Store value as shifted right by 8
 				 * for sign extended 24 bit value,
 				 * advance write pointer.
 				 */
-				AE_S32_L_XP(AE_SRAI32(q, 8),
-					(ae_int32 *)s->y_wptr, sz);
+				AE_S32_L_XP(AE_SRAI32(q, 8), y_wptr, sz);
 			}
+			s->y_wptr = (int32_t *)y_wptr;
 
 			/* Check wrap */
 			src_circ_inc_wrap(&s->y_wptr, s->y_end_addr, s->y_size);
 		}
+		fir->out_rp = (int32_t *)out_rp;
 	}
 }
 
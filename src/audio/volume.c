@@ -47,6 +47,7 @@
 #include <sof/alloc.h>
 #include <sof/work.h>
 #include <sof/clock.h>
+#include <sof/ipc.h>
 #include "volume.h"
 
 /**
@@ -134,6 +135,9 @@ static uint64_t vol_work(void *data, uint64_t delay)
 		vol_sync_host(cd, i);
 	}
 
+	/* publish ramped volume in the stream status */
+	ipc_stream_status_volume(dev, cd->volume, PLATFORM_MAX_CHANNELS);
+
 	/* do we need to continue ramping */
 	if (again)
 		return VOL_RAMP_US;
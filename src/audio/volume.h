@@ -40,6 +40,7 @@
 #define VOLUME_H
 
 #include <stdint.h>
+#include <config.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/audio/format.h>
@@ -53,6 +54,8 @@
 #undef CONFIG_GENERIC
 #endif
 
+#elif defined(CONFIG_HIFI3_EMU)
+#undef CONFIG_GENERIC
 #endif
 
 /** \brief Volume trace function. */
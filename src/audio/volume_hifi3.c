@@ -36,9 +36,13 @@
 
 #include "volume.h"
 
-#if defined(__XCC__) && XCHAL_HAVE_HIFI3
+#ifndef CONFIG_GENERIC
 
+#if defined(__XCC__)
 #include <xtensa/tie/xt_hifi3.h>
+#else
+#include <arch/xt_hifi3.h>
+#endif
 
 /** \brief Volume scale ratio. */
 #define VOL_SCALE (uint32_t)((double)INT32_MAX / VOL_MAX)
@@ -76,7 +80,7 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
 			AE_L16_XP(in_sample, in, sizeof(ae_int16));
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = AE_MOVDA32(vol_scaled[channel]);
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X16X2RS_L(volume, in_sample);
@@ -131,7 +135,7 @@ static void vol_s16_to_sX(struct comp_dev *dev, struct comp_buffer *sink,
 			AE_L16_XP(in_sample, in, sizeof(ae_int16));
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = AE_MOVDA32(vol_scaled[channel]);
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X16X2RS_L(volume, in_sample);
@@ -189,7 +193,7 @@ static void vol_sX_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
 			in_sample = AE_SLAA32(in_sample, shift_left);
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = AE_MOVDA32(vol_scaled[channel]);
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X2RS(volume, in_sample);
@@ -242,7 +246,7 @@ static void vol_s24_to_s24_s32(struct comp_dev *dev, struct comp_buffer *sink,
 			AE_L32_XP(in_sample, in, sizeof(ae_int32));
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = AE_MOVDA32(vol_scaled[channel]);
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X2RS(volume, AE_SLAA32(in_sample, 8));
@@ -297,7 +301,7 @@ static void vol_s32_to_s24_s32(struct comp_dev *dev, struct comp_buffer *sink,
 			AE_L32_XP(in_sample, in, sizeof(ae_int32));
 
 			/* Get gain coefficients */
-			volume = *((ae_f32 *)&vol_scaled[channel]);
+			volume = AE_MOVDA32(vol_scaled[channel]);
 
 			/* Multiply the input sample */
 			mult = AE_MULFP32X2RS(volume, in_sample);
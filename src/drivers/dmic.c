@@ -36,7 +36,12 @@
 
 #if defined DMIC_HW_VERSION
 
+/* table generated by configure --with-dmic-rates has only the needed FIRs */
+#if defined CONFIG_DMIC_RATES
+#include <pdm_decim_select.h>
+#else
 #include <sof/audio/coefficients/pdm_decim/pdm_decim_table.h>
+#endif
 
 #if defined MODULE_TEST
 #include <stdio.h>
@@ -34,30 +34,482 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
 #include <sof/alloc.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <uapi/ipc.h>
 #include "host/common_test.h"
 
+/*
+ * Emulated firmware heap. When enabled every allocation is also placed in
+ * a copy of the firmware memmap block maps so that usage, peaks and
+ * fragmentation can be reported and allocations that would not fit on
+ * the DSP fail. Platform heap sizes are used when the host build includes
+ * a platform memory map. Host structures are larger than DSP structures
+ * so runtime heap results are an upper bound.
+ */
+
+#ifndef HEAP_RT_COUNT16
+#define HEAP_RT_COUNT16		256
+#define HEAP_RT_COUNT32		128
+#define HEAP_RT_COUNT64		64
+#define HEAP_RT_COUNT128	32
+#define HEAP_RT_COUNT256	64
+#define HEAP_RT_COUNT512	8
+#define HEAP_RT_COUNT1024	4
+#endif
+
+#ifndef HEAP_SYSTEM_SIZE
+#define HEAP_SYSTEM_SIZE	0x5000
+#endif
+
+#ifndef HEAP_BUFFER_BLOCK_SIZE
+#define HEAP_BUFFER_BLOCK_SIZE	0x180
+#endif
+
+#define HOST_RT_SIZE \
+	(HEAP_RT_COUNT16 * 16 + HEAP_RT_COUNT32 * 32 + \
+	HEAP_RT_COUNT64 * 64 + HEAP_RT_COUNT128 * 128 + \
+	HEAP_RT_COUNT256 * 256 + HEAP_RT_COUNT512 * 512 + \
+	HEAP_RT_COUNT1024 * 1024)
+
+#define HOST_BUFFER_COUNT	(HEAP_BUFFER_SIZE / HEAP_BUFFER_BLOCK_SIZE)
+#define HOST_BUFFER_SIZE	(HOST_BUFFER_COUNT * HEAP_BUFFER_BLOCK_SIZE)
+
+#define HOST_HEAP_CAPS \
+	(SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_EXT | SOF_MEM_CAPS_CACHE | \
+	SOF_MEM_CAPS_DMA)
+
+/* Heap blocks for modules */
+static struct block_hdr mod_block16[HEAP_RT_COUNT16];
+static struct block_hdr mod_block32[HEAP_RT_COUNT32];
+static struct block_hdr mod_block64[HEAP_RT_COUNT64];
+static struct block_hdr mod_block128[HEAP_RT_COUNT128];
+static struct block_hdr mod_block256[HEAP_RT_COUNT256];
+static struct block_hdr mod_block512[HEAP_RT_COUNT512];
+static struct block_hdr mod_block1024[HEAP_RT_COUNT1024];
+
+/* Heap memory map for modules */
+static struct block_map rt_heap_map[] = {
+	BLOCK_DEF(16, HEAP_RT_COUNT16, mod_block16, NULL),
+	BLOCK_DEF(32, HEAP_RT_COUNT32, mod_block32, NULL),
+	BLOCK_DEF(64, HEAP_RT_COUNT64, mod_block64, NULL),
+	BLOCK_DEF(128, HEAP_RT_COUNT128, mod_block128, NULL),
+	BLOCK_DEF(256, HEAP_RT_COUNT256, mod_block256, NULL),
+	BLOCK_DEF(512, HEAP_RT_COUNT512, mod_block512, NULL),
+	BLOCK_DEF(1024, HEAP_RT_COUNT1024, mod_block1024, NULL),
+};
+
+/* Heap blocks and memory map for buffers */
+static struct block_hdr buf_block[HOST_BUFFER_COUNT];
+
+static struct block_map buf_heap_map[] = {
+	BLOCK_DEF(HEAP_BUFFER_BLOCK_SIZE, HOST_BUFFER_COUNT, buf_block, NULL),
+};
+
+struct mm memmap = {
+	.system = {
+		.size = HEAP_SYSTEM_SIZE,
+		.info = {.free = HEAP_SYSTEM_SIZE,},
+		.caps = HOST_HEAP_CAPS,
+	},
+	.runtime[0] = {
+		.blocks = ARRAY_SIZE(rt_heap_map),
+		.map = rt_heap_map,
+		.size = HOST_RT_SIZE,
+		.info = {.free = HOST_RT_SIZE,},
+		.caps = HOST_HEAP_CAPS,
+	},
+	.buffer[0] = {
+		.blocks = ARRAY_SIZE(buf_heap_map),
+		.map = buf_heap_map,
+		.size = HOST_BUFFER_SIZE,
+		.info = {.free = HOST_BUFFER_SIZE,},
+		.caps = HOST_HEAP_CAPS,
+	},
+};
+
+/* emulated allocation, maps host pointer to its heap blocks */
+struct host_alloc {
+	void *ptr;
+	struct mm_heap *heap;
+	struct block_map *map;
+	uint32_t block;
+	struct list_item list;
+};
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct list_item alloc_list;
+static int heap_emulate;
+
+/* find heap that supports caps */
+static struct mm_heap *host_heap_from_caps(struct mm_heap *heaps, int count,
+					   uint32_t caps)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if ((heaps[i].caps & caps) == caps)
+			return &heaps[i];
+	}
+
+	return NULL;
+}
+
+/* allocate count continuous blocks from map, returns first block or -1 */
+static int host_map_alloc(struct mm_heap *heap, struct block_map *map,
+			  uint32_t count)
+{
+	uint32_t start;
+	uint32_t current;
+
+	if (count > map->free_count)
+		return -1;
+
+	for (start = 0; start + count <= map->count; start++) {
+		for (current = start; current < start + count; current++) {
+			if (map->block[current].used)
+				break;
+		}
+
+		if (current == start + count)
+			goto found;
+
+		start = current;
+	}
+
+	return -1;
+
+found:
+	map->block[start].size = count;
+	for (current = start; current < start + count; current++)
+		map->block[current].used = 1;
+
+	map->free_count -= count;
+	map->peak_used = MAX(map->peak_used, map->count - map->free_count);
+	heap->info.used += count * map->block_size;
+	heap->info.free -= count * map->block_size;
+	heap->info.peak = MAX(heap->info.peak, heap->info.used);
+
+	return start;
+}
+
+/* place allocation in emulated heap using the firmware allocator policy */
+static int host_heap_alloc(struct host_alloc *a, int zone, uint32_t caps,
+			   size_t bytes, int cont)
+{
+	struct mm_heap *heap;
+	struct block_map *map;
+	int block;
+	int i;
+
+	if (zone == RZONE_SYS && !cont) {
+		if (bytes > memmap.system.info.free)
+			return -ENOMEM;
+
+		memmap.system.info.used += bytes;
+		memmap.system.info.free -= bytes;
+		memmap.system.info.peak = memmap.system.info.used;
+		return 0;
+	}
+
+	/* runtime allocs fall back to buffer heaps, buffers use buffers */
+	heap = cont ? NULL : host_heap_from_caps(memmap.runtime,
+						 PLATFORM_HEAP_RUNTIME, caps);
+	if (!heap)
+		heap = host_heap_from_caps(memmap.buffer,
+					   PLATFORM_HEAP_BUFFER, caps);
+	if (!heap)
+		return -EINVAL;
+
+	/* single block */
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+
+		if (map->block_size < bytes)
+			continue;
+
+		block = host_map_alloc(heap, map, 1);
+		if (block >= 0)
+			goto found;
+	}
+
+	/* continuous blocks, largest block size first */
+	for (i = heap->blocks - 1; cont && i >= 0; i--) {
+		map = &heap->map[i];
+
+		block = host_map_alloc(heap, map,
+				       ceil_divide(bytes, map->block_size));
+		if (block >= 0)
+			goto found;
+	}
+
+	/* count failed request once, against the map of its size class */
+	heap->info.failures++;
+	if (!heap->blocks)
+		return -ENOMEM;
+	for (i = 0; i < heap->blocks - 1; i++) {
+		if (heap->map[i].block_size >= bytes)
+			break;
+	}
+	heap->map[i].failures++;
+	return -ENOMEM;
+
+found:
+	a->heap = heap;
+	a->map = map;
+	a->block = block;
+	return 0;
+}
+
+/* release emulated blocks of ptr, system heap is never released */
+static void host_heap_free(void *ptr)
+{
+	struct host_alloc *a;
+	struct list_item *plist;
+	struct block_map *map;
+	uint32_t count;
+	uint32_t i;
+
+	list_for_item(plist, &alloc_list) {
+		a = container_of(plist, struct host_alloc, list);
+		if (a->ptr == ptr)
+			goto found;
+	}
+
+	return;
+
+found:
+	map = a->map;
+	if (map) {
+		count = map->block[a->block].size;
+		for (i = a->block; i < a->block + count; i++) {
+			map->block[i].size = 0;
+			map->block[i].used = 0;
+		}
+
+		map->free_count += count;
+		a->heap->info.used -= count * map->block_size;
+		a->heap->info.free += count * map->block_size;
+	}
+
+	list_item_del(&a->list);
+	free(a);
+}
+
+/* allocate host memory, buffers are cache line aligned like on the DSP */
+static void *host_malloc(size_t bytes, int cont, int zero)
+{
+	void *ptr;
+
+	if (!cont)
+		return zero ? calloc(1, bytes) : malloc(bytes);
+
+	if (posix_memalign(&ptr, DCACHE_LINE_SIZE, bytes))
+		return NULL;
+
+	if (zero)
+		memset(ptr, 0, bytes);
+
+	return ptr;
+}
+
+/* allocate host memory and account for it in the emulated heap */
+static void *host_alloc(int zone, uint32_t caps, size_t bytes, int cont,
+			int zero)
+{
+	struct host_alloc *a;
+	void *ptr;
+
+	if (!heap_emulate)
+		return host_malloc(bytes, cont, zero);
+
+	a = calloc(1, sizeof(*a));
+	ptr = host_malloc(bytes, cont, zero);
+	if (!a || !ptr)
+		goto err_mem;
+
+	pthread_mutex_lock(&heap_lock);
+
+	if (zone >= 0 && zone < RZONE_COUNT)
+		memmap.zone[zone].allocs++;
+
+	if (host_heap_alloc(a, zone, caps, bytes, cont) < 0) {
+		if (zone >= 0 && zone < RZONE_COUNT)
+			memmap.zone[zone].failures++;
+		pthread_mutex_unlock(&heap_lock);
+		fprintf(stderr, "error: emulated heap zone %d caps 0x%x size %zu\n",
+			zone, caps, bytes);
+		goto err_mem;
+	}
+
+	a->ptr = ptr;
+	list_item_prepend(&a->list, &alloc_list);
+	pthread_mutex_unlock(&heap_lock);
+	return ptr;
+
+err_mem:
+	free(ptr);
+	free(a);
+	return NULL;
+}
+
 /* testbench mem alloc definition */
 
 void *rmalloc(int zone, uint32_t caps, size_t bytes)
 {
-	return malloc(bytes);
+	return host_alloc(zone, caps, bytes, 0, 0);
 }
 
 void *rzalloc(int zone, uint32_t caps, size_t bytes)
 {
-	void *x;
-
-	x = calloc(1, bytes);
-	return x;
+	return host_alloc(zone, caps, bytes, 0, 1);
 }
 
 void rfree(void *ptr)
 {
+	if (heap_emulate && ptr) {
+		pthread_mutex_lock(&heap_lock);
+		host_heap_free(ptr);
+		pthread_mutex_unlock(&heap_lock);
+	}
+
 	free(ptr);
 }
 
 void *rballoc(int zone, uint32_t caps, size_t bytes)
 {
-	return malloc(bytes);
+	return host_alloc(zone, caps, bytes, 1, 0);
+}
+
+/* host memory has no SRAM banks */
+void *rballoc_bank(int zone, uint32_t caps, size_t bytes, void *avoid,
+		   size_t avoid_bytes)
+{
+	return host_alloc(zone, caps, bytes, 1, 0);
+}
+
+/* largest run of continuous free blocks in map */
+static uint32_t host_map_largest_free(struct block_map *map)
+{
+	uint32_t largest = 0;
+	uint32_t run = 0;
+	uint32_t i;
+
+	for (i = 0; i < map->count; i++) {
+		run = map->block[i].used ? 0 : run + 1;
+		largest = MAX(largest, run);
+	}
+
+	return largest;
+}
+
+/* get usage and fragmentation statistics for one emulated heap */
+int mm_heap_stats(uint32_t zone, uint32_t index,
+		  struct sof_ipc_mem_stats *stats)
+{
+	struct mm_heap *heap;
+	struct block_map *map;
+	int i;
+
+	switch (zone) {
+	case RZONE_SYS:
+		if (index > 0)
+			return -EINVAL;
+		heap = &memmap.system;
+		break;
+	case RZONE_RUNTIME:
+		if (index >= PLATFORM_HEAP_RUNTIME)
+			return -EINVAL;
+		heap = &memmap.runtime[index];
+		break;
+	case RZONE_BUFFER:
+		if (index >= PLATFORM_HEAP_BUFFER)
+			return -EINVAL;
+		heap = &memmap.buffer[index];
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	pthread_mutex_lock(&heap_lock);
+
+	stats->zone = zone;
+	stats->index = index;
+	stats->caps = heap->caps;
+	stats->size = heap->size;
+	stats->used = heap->info.used;
+	stats->free = heap->info.free;
+	stats->peak = heap->info.peak;
+	stats->failures = heap->info.failures;
+	stats->zone_allocs = memmap.zone[zone].allocs;
+	stats->zone_failures = memmap.zone[zone].failures;
+	stats->num_maps = MIN(heap->blocks, SOF_IPC_MAX_MEM_MAPS);
+	stats->largest_free = heap->blocks ? 0 : heap->info.free;
+
+	for (i = 0; i < stats->num_maps; i++) {
+		map = &heap->map[i];
+
+		stats->map[i].block_size = map->block_size;
+		stats->map[i].count = map->count;
+		stats->map[i].free_count = map->free_count;
+		stats->map[i].peak_used = map->peak_used;
+		stats->map[i].largest_free = host_map_largest_free(map);
+		stats->map[i].failures = map->failures;
+
+		stats->largest_free = MAX(stats->largest_free,
+			stats->map[i].largest_free * map->block_size);
+	}
+
+	pthread_mutex_unlock(&heap_lock);
+
+	return 0;
+}
+
+/* place all further allocations in the emulated firmware heap */
+void tb_heap_emulate(void)
+{
+	list_init(&alloc_list);
+	heap_emulate = 1;
+}
+
+/* print emulated heap usage for every heap with any size */
+void tb_heap_report(void)
+{
+	struct sof_ipc_mem_stats stats;
+	struct sof_ipc_mem_map_stats *map;
+	uint32_t zone;
+	uint32_t index;
+	uint32_t i;
+
+	if (!heap_emulate)
+		return;
+
+	printf("Heap usage:\n");
+
+	for (zone = 0; zone < RZONE_COUNT; zone++) {
+		for (index = 0; mm_heap_stats(zone, index, &stats) == 0;
+		     index++) {
+			if (!stats.size)
+				continue;
+
+			printf("zone %u heap %u: size %u peak %u used %u largest free %u failures %u\n",
+			       zone, index, stats.size, stats.peak,
+			       stats.used, stats.largest_free, stats.failures);
+
+			for (i = 0; i < stats.num_maps; i++) {
+				map = &stats.map[i];
+				printf("  block %5u: peak %u/%u free %u largest free %u failures %u\n",
+				       map->block_size, map->peak_used,
+				       map->count, map->free_count,
+				       map->largest_free, map->failures);
+			}
+		}
+
+		printf("zone %u: allocs %u failures %u\n", zone,
+		       memmap.zone[zone].allocs, memmap.zone[zone].failures);
+	}
 }
@@ -50,6 +50,7 @@ int platform_ipc_init(struct ipc *ipc)
 	_ipc->dsp_msg = NULL;
 	list_init(&ipc->empty_list);
 	list_init(&ipc->msg_list);
+	list_init(&ipc->urgent_list);
 	spinlock_init(&ipc->lock);
 
 	for (i = 0; i < MSG_QUEUE_SIZE; i++)
@@ -79,3 +80,28 @@ int ipc_stream_send_xrun(struct comp_dev *cdev,
 {
 	return 0;
 }
+
+void ipc_stream_status_reset(struct pipeline *p, uint32_t comp_id)
+{
+}
+
+void ipc_stream_status_host(struct comp_dev *cdev, uint64_t host_posn)
+{
+}
+
+void ipc_stream_status_dai(struct comp_dev *cdev, uint64_t dai_posn)
+{
+}
+
+void ipc_stream_status_xrun(struct comp_dev *cdev, int32_t bytes)
+{
+}
+
+void ipc_stream_status_recover(struct pipeline *p)
+{
+}
+
+void ipc_stream_status_volume(struct comp_dev *cdev, uint32_t *volume,
+			      int channels)
+{
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sof/ipc.h>
+#include <sof/intel-ipc.h>
+#include <sof/mailbox.h>
+#include <sof/dma.h>
+#include <sof/dma-trace.h>
+#include <sof/timer.h>
+#include <platform/mailbox.h>
+#include "host/ipc_mock.h"
+
+/* mailbox shared with the host side of the transport */
+static uint8_t mailbox[MAILBOX_SIZE];
+uint8_t *host_mailbox = mailbox;
+
+extern struct ipc *_ipc;
+
+struct tb_ipc_stats tb_ipc_stats;
+
+/* host buffer data read by DMA, consumed in order */
+static const uint8_t *dma_data;
+static size_t dma_size;
+static size_t dma_pos;
+
+struct timer *platform_timer;
+
+int platform_ipc_init(struct ipc *ipc)
+{
+	struct intel_ipc_data *iipc;
+	int i;
+
+	_ipc = ipc;
+
+	/* init ipc data */
+	iipc = calloc(1, sizeof(struct intel_ipc_data));
+	ipc_set_drvdata(_ipc, iipc);
+	_ipc->dsp_msg = NULL;
+	list_init(&ipc->empty_list);
+	list_init(&ipc->msg_list);
+	list_init(&ipc->urgent_list);
+	spinlock_init(&ipc->lock);
+
+	for (i = 0; i < MSG_QUEUE_SIZE; i++)
+		list_item_prepend(&ipc->message[i].list, &ipc->empty_list);
+
+	/* allocate page table buffer */
+	iipc->page_table = calloc(1, HOST_PAGE_SIZE);
+
+	/* PM */
+	iipc->pm_prepare_D3 = 0;
+
+	return 0;
+}
+
+void ipc_platform_do_cmd(struct ipc *ipc)
+{
+	struct sof_ipc_reply reply;
+	int32_t err;
+
+	/* perform command and return any error */
+	err = ipc_cmd();
+	if (err > 0)
+		goto done; /* reply created and copied by cmd() */
+
+	/* send std error/ok reply */
+	reply.error = err;
+	reply.hdr.cmd = SOF_IPC_GLB_REPLY;
+	reply.hdr.size = sizeof(reply);
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+
+done:
+	ipc->host_pending = 0;
+}
+
+void ipc_platform_send_msg(struct ipc *ipc)
+{
+	struct ipc_msg *msg;
+	uint32_t flags;
+
+	spin_lock_irq(&ipc->lock, flags);
+
+	/* any messages to send ? */
+	msg = ipc_msg_next(ipc);
+	if (msg == NULL) {
+		ipc->dsp_pending = 0;
+		goto out;
+	}
+
+	/* host reads it straight away */
+	mailbox_dspbox_write(0, msg->tx_data, msg->tx_size);
+	tb_ipc_stats.notifications++;
+	tb_ipc_stats.last_notification = msg->header;
+
+	list_item_append(&msg->list, &ipc->empty_list);
+
+out:
+	spin_unlock_irq(&ipc->lock, flags);
+}
+
+int tb_ipc_msg(struct ipc *ipc, const void *msg, void *reply,
+	       size_t reply_bytes)
+{
+	const struct sof_ipc_hdr *hdr = msg;
+	struct sof_ipc_reply *rhdr = reply;
+
+	if (hdr->size < sizeof(*hdr) || hdr->size > MAILBOX_HOSTBOX_SIZE ||
+	    reply_bytes < sizeof(*rhdr))
+		return -EINVAL;
+
+	/* host writes the message and rings the doorbell */
+	mailbox_hostbox_write(0, msg, hdr->size);
+	ipc->host_msg = hdr->cmd;
+	ipc->host_pending = 1;
+
+	/* process it and any notifications it caused */
+	do {
+		ipc_process_msg_queue();
+	} while (ipc->dsp_pending);
+
+	/* reply overwrites the message in the mailbox */
+	mailbox_hostbox_read(reply, 0, sizeof(*rhdr));
+	if (rhdr->hdr.size < reply_bytes)
+		reply_bytes = rhdr->hdr.size;
+	if (reply_bytes > sizeof(*rhdr))
+		mailbox_hostbox_read((uint8_t *)reply + sizeof(*rhdr),
+				     sizeof(*rhdr), reply_bytes - sizeof(*rhdr));
+
+	return rhdr->error;
+}
+
+void tb_ipc_set_dma_data(const void *data, size_t bytes)
+{
+	dma_data = data;
+	dma_size = bytes;
+	dma_pos = 0;
+}
+
+/* DMA copies from host buffers read the next bytes of the DMA data */
+
+static void dma_mock_channel_put(struct dma *dma, int channel)
+{
+}
+
+static const struct dma_ops dma_mock_ops = {
+	.channel_put	= dma_mock_channel_put,
+};
+
+static struct dma dma_mock = {
+	.ops		= &dma_mock_ops,
+};
+
+int dma_copy_new(struct dma_copy *dc)
+{
+	dc->dmac = &dma_mock;
+	dc->chan = 0;
+	return 0;
+}
+
+int dma_copy_set_stream_tag(struct dma_copy *dc, uint32_t stream_tag)
+{
+	return 0;
+}
+
+int dma_copy_from_host(struct dma_copy *dc, struct dma_sg_config *host_sg,
+	int32_t host_offset, void *local_ptr, int32_t size)
+{
+	if (size < 0 || (size_t)size > dma_size - dma_pos)
+		return -EINVAL;
+
+	memcpy(local_ptr, dma_data + dma_pos, size);
+	dma_pos += size;
+	tb_ipc_stats.dma_bytes += size;
+	return size;
+}
+
+int dma_copy_to_host(struct dma_copy *dc, struct dma_sg_config *host_sg,
+	int32_t host_offset, void *local_ptr, int32_t size)
+{
+	return size;
+}
+
+/* The following definitions are to satisfy IPC handler linker errors */
+
+int dma_trace_enable(struct dma_trace_data *d)
+{
+	return -ENODEV;
+}
+
+void platform_timer_stop(struct timer *timer)
+{
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Replays IPC messages from a file through the firmware IPC handler and
+ * reports the time taken to handle each message. The file holds complete
+ * IPC messages back to back, each starting with its struct sof_ipc_hdr and
+ * padded to a multiple of 4 bytes, i.e. the same layout as the payload of
+ * a compound message.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <sof/ipc.h>
+#include "host/common_test.h"
+#include "host/trace.h"
+#include "host/ipc_mock.h"
+#include "host/topology.h"
+
+#define REPLAY_MAX_CMDS		64
+#define REPLAY_REPLY_SIZE	SOF_IPC_MSG_MAX_SIZE
+
+/* handling time of one message type */
+struct replay_stat {
+	uint32_t cmd;		/* global and command type */
+	uint32_t count;
+	uint32_t errors;
+	uint64_t total_ns;
+	uint64_t min_ns;
+	uint64_t max_ns;
+};
+
+/* main firmware context */
+static struct sof sof;
+static struct replay_stat stats[REPLAY_MAX_CMDS];
+static int num_stats;
+
+int debug;
+
+static void *read_file(const char *name, size_t *bytes)
+{
+	FILE *fp;
+	void *data;
+	long size;
+
+	fp = fopen(name, "rb");
+	if (!fp) {
+		fprintf(stderr, "error: opening file %s\n", name);
+		return NULL;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = malloc(size > 0 ? size : 1);
+	if (!data || fread(data, 1, size, fp) != (size_t)size) {
+		fprintf(stderr, "error: reading file %s\n", name);
+		free(data);
+		fclose(fp);
+		return NULL;
+	}
+
+	fclose(fp);
+	*bytes = size;
+	return data;
+}
+
+static uint64_t elapsed_ns(struct timespec *tic, struct timespec *toc)
+{
+	return (toc->tv_sec - tic->tv_sec) * 1000000000ULL +
+		toc->tv_nsec - tic->tv_nsec;
+}
+
+static void stat_add(uint32_t cmd, int err, uint64_t ns)
+{
+	struct replay_stat *s = NULL;
+	int i;
+
+	cmd &= SOF_GLB_TYPE_MASK | SOF_CMD_TYPE_MASK;
+
+	for (i = 0; i < num_stats; i++) {
+		if (stats[i].cmd == cmd) {
+			s = &stats[i];
+			break;
+		}
+	}
+
+	if (!s) {
+		if (num_stats == REPLAY_MAX_CMDS)
+			return;
+		s = &stats[num_stats++];
+		s->cmd = cmd;
+		s->min_ns = UINT64_MAX;
+	}
+
+	s->count++;
+	if (err < 0)
+		s->errors++;
+	s->total_ns += ns;
+	if (ns < s->min_ns)
+		s->min_ns = ns;
+	if (ns > s->max_ns)
+		s->max_ns = ns;
+}
+
+static void stat_print(void)
+{
+	struct replay_stat *s;
+	uint64_t total = 0;
+	uint32_t count = 0;
+	int i;
+
+	printf("cmd         count  errors   min us   avg us   max us\n");
+	for (i = 0; i < num_stats; i++) {
+		s = &stats[i];
+		printf("0x%8.8x %6u %7u %8.2f %8.2f %8.2f\n", s->cmd,
+		       s->count, s->errors, s->min_ns / 1000.0,
+		       s->total_ns / 1000.0 / s->count, s->max_ns / 1000.0);
+		total += s->total_ns;
+		count += s->count;
+	}
+
+	printf("%u messages in %.2f us, %u notifications, %u DMA bytes\n",
+	       count, total / 1000.0, tb_ipc_stats.notifications,
+	       tb_ipc_stats.dma_bytes);
+}
+
+/* size of a saved reply, truncated to the reply buffer */
+static size_t reply_size(struct sof_ipc_reply *rhdr)
+{
+	size_t size = (rhdr->hdr.size + 3) & ~3;
+
+	return size < REPLAY_REPLY_SIZE ? size : REPLAY_REPLY_SIZE;
+}
+
+/* send all messages of the file once, returns number of failed messages */
+static int replay(uint8_t *msgs, size_t size, FILE *out)
+{
+	uint8_t reply[REPLAY_REPLY_SIZE];
+	struct sof_ipc_reply *rhdr = (struct sof_ipc_reply *)reply;
+	struct sof_ipc_hdr *hdr;
+	struct timespec tic, toc;
+	size_t offset = 0;
+	uint64_t ns;
+	int failed = 0;
+	int index = 0;
+	int err;
+
+	while (offset + sizeof(*hdr) <= size) {
+		hdr = (struct sof_ipc_hdr *)(msgs + offset);
+		if (hdr->size < sizeof(*hdr) || hdr->size > size - offset) {
+			fprintf(stderr, "error: bad message %d at offset %zu\n",
+				index, offset);
+			return -EINVAL;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &tic);
+		err = tb_ipc_msg(sof.ipc, hdr, reply, sizeof(reply));
+		clock_gettime(CLOCK_MONOTONIC, &toc);
+
+		ns = elapsed_ns(&tic, &toc);
+		stat_add(hdr->cmd, err, ns);
+		if (err < 0)
+			failed++;
+
+		if (debug || err < 0)
+			printf("%4d cmd 0x%8.8x size %4u error %4d time %8.2f us\n",
+			       index, hdr->cmd, hdr->size, err, ns / 1000.0);
+
+		/* replies are saved with the same layout as messages */
+		if (out)
+			fwrite(reply, 1, reply_size(rhdr), out);
+
+		offset += (hdr->size + 3) & ~3;
+		index++;
+	}
+
+	return failed;
+}
+
+static void print_usage(char *executable)
+{
+	printf("Usage: %s -i <ipc_file> [-D <dma_file>] [-o <reply_file>] ",
+	       executable);
+	printf("[-r <repeat>] [-a <comp1=comp1_library,...>] [-t] [-d]\n\n");
+	printf("Replays IPC messages through the firmware IPC handler.\n");
+	printf("-D gives the data read by the DSP from host buffers, in the\n");
+	printf("order of the messages using them. -r repeats the messages,\n");
+	printf("useful for control messages. -t enables trace.\n");
+}
+
+int main(int argc, char **argv)
+{
+	char *ipc_file = NULL, *dma_file = NULL, *reply_file = NULL;
+	uint8_t *msgs, *dma = NULL;
+	size_t msgs_size, dma_size = 0;
+	FILE *out = NULL;
+	int repeat = 1;
+	int trace = 0;
+	int option;
+	int failed = 0;
+	int ret;
+	int i;
+
+	while ((option = getopt(argc, argv, "hdti:D:o:r:a:")) != -1) {
+		switch (option) {
+		/* IPC message file */
+		case 'i':
+			ipc_file = optarg;
+			break;
+
+		/* host buffer data file */
+		case 'D':
+			dma_file = optarg;
+			break;
+
+		/* reply output file */
+		case 'o':
+			reply_file = optarg;
+			break;
+
+		/* number of times to send the messages */
+		case 'r':
+			repeat = atoi(optarg);
+			break;
+
+		/* override default component libraries */
+		case 'a':
+			if (tplg_set_comp_libs(optarg) < 0)
+				exit(EXIT_FAILURE);
+			break;
+
+		/* enable trace prints */
+		case 't':
+			trace = 1;
+			break;
+
+		/* enable debug prints */
+		case 'd':
+			debug = 1;
+			break;
+
+		/* print usage */
+		case 'h':
+		default:
+			print_usage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (!ipc_file || repeat < 1) {
+		print_usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	setup_trace_table();
+	tb_enable_trace(trace);
+
+	msgs = read_file(ipc_file, &msgs_size);
+	if (!msgs)
+		exit(EXIT_FAILURE);
+
+	if (dma_file) {
+		dma = read_file(dma_file, &dma_size);
+		if (!dma)
+			exit(EXIT_FAILURE);
+	}
+
+	if (reply_file) {
+		out = fopen(reply_file, "wb");
+		if (!out) {
+			fprintf(stderr, "error: opening file %s\n", reply_file);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* initialize ipc and scheduler */
+	if (tb_pipeline_setup(&sof) < 0) {
+		fprintf(stderr, "error: pipeline init\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* register all comp drivers the replayed topology may use */
+	if (tplg_register_comps() < 0) {
+		fprintf(stderr, "error: comp driver registration\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < repeat; i++) {
+		tb_ipc_set_dma_data(dma, dma_size);
+		ret = replay(msgs, msgs_size, out);
+		if (ret < 0) {
+			failed = ret;
+			break;
+		}
+		failed += ret;
+	}
+
+	stat_print();
+
+	if (out)
+		fclose(out);
+	free(dma);
+	free(msgs);
+	free_trace_table();
+	tplg_free_comps();
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
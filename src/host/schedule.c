@@ -48,16 +48,20 @@ static struct schedule_data *sch;
 
 void schedule_task_complete(struct task *task)
 {
+	spin_lock(&sch->lock);
 	list_item_del(&task->list);
 	task->state = TASK_STATE_COMPLETED;
+	spin_unlock(&sch->lock);
 }
 
-/* schedule task */
+/* schedule task, can be called from several testbench worker threads */
 void schedule_task(struct task *task, uint64_t start, uint64_t deadline)
 {
+	spin_lock(&sch->lock);
 	task->deadline = deadline;
 	list_item_prepend(&task->list, &sch->list);
 	task->state = TASK_STATE_QUEUED;
+	spin_unlock(&sch->lock);
 
 	if (task->func)
 		task->func(task->data);
@@ -87,6 +91,15 @@ void schedule_task_idle(struct task *task, uint64_t deadline)
 {
 }
 
+int schedule_task_depend(struct task *consumer, struct task *producer)
+{
+	return 0;
+}
+
+void schedule_task_depend_free(struct task *task)
+{
+}
+
 /* testbench work definition */
 
 void work_schedule_default(struct work *w, uint64_t timeout)
@@ -32,61 +32,284 @@
 #include <sof/ipc.h>
 #include <sof/list.h>
 #include <getopt.h>
-#include <dlfcn.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "host/common_test.h"
 #include "host/topology.h"
+#include "host/tplg_cache.h"
 #include "host/trace.h"
 #include "host/file.h"
 
 #define TESTBENCH_NCH 2 /* Stereo */
+#define TB_MAX_PIPELINES 16
+#define TB_MAX_THREADS 64
+
+/* testbench pipeline run state */
+struct tb_pipeline {
+	struct pipeline *p;
+	struct file_comp_data *frcd;	/* pipeline fileread or NULL */
+	int depend[TB_MAX_PIPELINES];	/* producer pipelines at joins */
+	int num_depend;
+	int round;			/* last round pipeline was copied in */
+	int running;
+};
+
+/*
+ * Worker pool copying one period through every pipeline per round.
+ * Independent pipelines run concurrently and joined pipelines only run
+ * after their producers have been copied in the same round, so each join
+ * buffer has a single producer and a single consumer running at a time.
+ */
+struct tb_pool {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	struct tb_pipeline pipes[TB_MAX_PIPELINES];
+	int num_pipes;
+	int round;
+	int pending;			/* pipelines to copy in this round */
+	int running;			/* pipelines being copied now */
+	int stall;			/* round can't complete, dependency loop */
+	int stop;
+};
+
+/* result of a test run */
+struct tb_result {
+	double t_exec;
+	double c_realtime;
+	int n_in;
+	int n_out;
+};
 
 /* main firmware context */
 static struct sof sof;
+static struct tb_pool pool;
 static int fr_id; /* comp id for fileread */
 static int fw_id; /* comp id for filewrite */
 static int sched_id; /* comp id for scheduling comp */
+static int ab_fd = -1; /* result pipe of A/B test variant */
 
 int debug;
 
-/*
- * Parse shared library from user input
- * Currently only handles volume comp
- */
-static void parse_libraries(char *libs, void *handle)
+/* get pool index of pipeline */
+static int tb_pipe_index(uint32_t pipeline_id)
+{
+	int i;
+
+	for (i = 0; i < pool.num_pipes; i++) {
+		if (pool.pipes[i].p->ipc_pipe.pipeline_id == pipeline_id)
+			return i;
+	}
+
+	return -EINVAL;
+}
+
+/* add producer -> consumer dependency for buffer joining two pipelines */
+static void tb_pipe_depend(struct comp_buffer *buffer)
+{
+	struct tb_pipeline *consumer;
+	int producer_idx, consumer_idx;
+	int i;
+
+	producer_idx = tb_pipe_index(buffer->source->comp.pipeline_id);
+	consumer_idx = tb_pipe_index(buffer->sink->comp.pipeline_id);
+	if (producer_idx < 0 || consumer_idx < 0 ||
+	    producer_idx == consumer_idx)
+		return;
+
+	consumer = &pool.pipes[consumer_idx];
+	for (i = 0; i < consumer->num_depend; i++) {
+		if (consumer->depend[i] == producer_idx)
+			return;
+	}
+
+	consumer->depend[consumer->num_depend++] = producer_idx;
+}
+
+/* find all pipelines in topology and their joins */
+static int tb_pool_init(void)
+{
+	struct list_item *clist;
+	struct ipc_comp_dev *icd;
+	struct file_comp_data *cd;
+	int i;
+
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.cond, NULL);
+
+	list_for_item(clist, &sof.ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_PIPELINE)
+			continue;
+
+		if (pool.num_pipes == TB_MAX_PIPELINES) {
+			fprintf(stderr, "error: too many pipelines\n");
+			return -EINVAL;
+		}
+		pool.pipes[pool.num_pipes++].p = icd->pipeline;
+	}
+
+	list_for_item(clist, &sof.ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		switch (icd->type) {
+		case COMP_TYPE_COMPONENT:
+			if (icd->cd->comp.type != SOF_COMP_FILEREAD)
+				continue;
+
+			/* filewrite shares the fileread comp type */
+			cd = comp_get_drvdata(icd->cd);
+			if (cd->fs.mode != FILE_READ)
+				continue;
+
+			i = tb_pipe_index(icd->cd->comp.pipeline_id);
+			if (i >= 0)
+				pool.pipes[i].frcd = cd;
+			break;
+		case COMP_TYPE_BUFFER:
+			if (icd->cb->source && icd->cb->sink)
+				tb_pipe_depend(icd->cb);
+			break;
+		default:
+			break;
+		}
+	}
+
+	return pool.num_pipes ? 0 : -EINVAL;
+}
+
+/* set params, prepare and start all pipelines */
+static int tb_pool_start(char *bits_in)
+{
+	struct pipeline *p;
+	int i;
+
+	for (i = 0; i < pool.num_pipes; i++) {
+		p = pool.pipes[i].p;
+
+		/* joined pipelines are started by their producer */
+		if (p->sched_comp->state == COMP_STATE_ACTIVE)
+			continue;
+
+		if (tb_pipeline_start(sof.ipc, TESTBENCH_NCH, bits_in,
+				      &p->ipc_pipe) < 0)
+			return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* all fileread pipelines have reached EOF */
+static int tb_pool_eof(void)
+{
+	int i;
+
+	for (i = 0; i < pool.num_pipes; i++) {
+		if (pool.pipes[i].frcd && !pool.pipes[i].frcd->fs.reached_eof)
+			return 0;
+	}
+
+	return 1;
+}
+
+/* get next pipeline whose producers have been copied in this round */
+static struct tb_pipeline *tb_pool_get_ready(void)
 {
-	char *lib_token, *comp_token;
-	char *token = strtok_r(libs, ",", &lib_token);
-	char message[DEBUG_MSG_LEN];
-
-	while (token) {
-		char *token1 = strtok_r(token, "=", &comp_token);
-
-		/* parse shared library for volume component */
-		if (strcmp(token1, "vol") == 0) {
-			while (token1) {
-				token1 = strtok_r(NULL, "=", &comp_token);
-				if (!token1)
-					return;
-
-				/* close shared library object */
-				if (handle)
-					dlclose(handle);
-
-				/* open volume shared library object */
-				handle = dlopen(token1, RTLD_LAZY);
-				if (!handle) {
-					fprintf(stderr, "error: %s\n",
-						dlerror());
-					exit(EXIT_FAILURE);
-				}
-
-				sprintf(message, "opening vol shared lib %s\n",
-					token1);
-				debug_print(message);
+	struct tb_pipeline *tp;
+	int i, j;
+
+	for (i = 0; i < pool.num_pipes; i++) {
+		tp = &pool.pipes[i];
+		if (tp->running || tp->round == pool.round)
+			continue;
+
+		for (j = 0; j < tp->num_depend; j++) {
+			if (pool.pipes[tp->depend[j]].round != pool.round)
+				break;
+		}
+
+		if (j == tp->num_depend)
+			return tp;
+	}
+
+	return NULL;
+}
+
+static void *tb_pool_worker(void *arg)
+{
+	struct tb_pipeline *tp;
+
+	pthread_mutex_lock(&pool.lock);
+
+	while (!pool.stop) {
+		tp = tb_pool_get_ready();
+		if (!tp) {
+			/* nothing ready or running but round not done */
+			if (pool.pending && !pool.running && !pool.stall) {
+				pool.stall = 1;
+				pthread_cond_broadcast(&pool.cond);
 			}
+			pthread_cond_wait(&pool.cond, &pool.lock);
+			continue;
+		}
+
+		tp->running = 1;
+		pool.running++;
+		pthread_mutex_unlock(&pool.lock);
+
+		/* copy a period through this pipeline */
+		pipeline_schedule_copy(tp->p, 0);
+
+		pthread_mutex_lock(&pool.lock);
+		tp->running = 0;
+		pool.running--;
+		tp->round = pool.round;
+		pool.pending--;
+		pthread_cond_broadcast(&pool.cond);
+	}
+
+	pthread_mutex_unlock(&pool.lock);
+	return NULL;
+}
+
+/* run rounds on worker threads until all input files are consumed */
+static int tb_pool_run(int num_threads)
+{
+	pthread_t threads[TB_MAX_THREADS];
+	int i, ret;
+
+	for (i = 0; i < num_threads; i++) {
+		ret = pthread_create(&threads[i], NULL, tb_pool_worker, NULL);
+		if (ret) {
+			fprintf(stderr, "error: create thread %d\n", i);
+			num_threads = i;
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&pool.lock);
+
+	while (num_threads && !tb_pool_eof()) {
+		pool.round++;
+		pool.pending = pool.num_pipes;
+		pthread_cond_broadcast(&pool.cond);
+
+		while (pool.pending && !pool.stall)
+			pthread_cond_wait(&pool.cond, &pool.lock);
+
+		if (pool.stall) {
+			fprintf(stderr, "error: pipeline dependency loop\n");
+			break;
 		}
-		token = strtok_r(NULL, ",", &lib_token);
 	}
+
+	pool.stop = 1;
+	pthread_cond_broadcast(&pool.cond);
+	pthread_mutex_unlock(&pool.lock);
+
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	return num_threads && !pool.stall ? 0 : -EINVAL;
 }
 
 /* print usage for testbench */
@@ -94,15 +317,193 @@ static void print_usage(char *executable)
 {
 	printf("Usage: %s -i <input_file> -o <output_file> ", executable);
 	printf("-t <tplg_file> -b <input_format> ");
-	printf("-a <comp1=comp1_library,comp2=comp2_library>\n");
+	printf("-a <comp1=comp1_library,comp2=comp2_library> ");
+	printf("-B <comp1=comp1_library> ");
+	printf("-T <num_threads> -m -c <cache_file>\n");
 	printf("input_format should be S16_LE, S32_LE, S24_LE or FLOAT_LE\n");
+	printf("input_file and output_file can be comma separated lists, ");
+	printf("one file per fileread and filewrite in topology order\n");
+	printf("num_threads is the number of pipeline worker threads, ");
+	printf("default 1 and max %d\n", TB_MAX_THREADS);
+	printf("-m places allocations in an emulated firmware heap and ");
+	printf("reports heap usage\n");
+	printf("-c loads the topology from cache_file if it is valid, else ");
+	printf("the topology is parsed and saved to cache_file\n");
+	printf("comp is vol, src, eq_fir, eq_iir, mixer, mux, switch or ");
+	printf("tone\n");
+	printf("-B runs an A/B test, the test runs with the -a libraries ");
+	printf("(A) and again with the -B libraries (B) writing output files ");
+	printf("with a _b suffix. Outputs are compared and execution times ");
+	printf("reported\n");
 	printf("Example Usage:\n");
 	printf("%s -i in.txt -o out.txt -t test.tplg ", executable);
 	printf("-b S16_LE -a vol=libsof_volume.so\n");
+	printf("%s -i in.txt -o out.txt -t test.tplg ", executable);
+	printf("-b S16_LE -B src=libsof_src_opt.so\n");
 }
 
-/* free components */
-static void free_comps(void)
+/* insert suffix before the extension of each name in a file list */
+static char *tb_ab_file_names(const char *files, const char *suffix)
+{
+	char *names, *name, *ext;
+	int i, n = 1;
+
+	for (i = 0; files[i]; i++) {
+		if (files[i] == ',')
+			n++;
+	}
+
+	names = calloc(1, strlen(files) + n * strlen(suffix) + 1);
+	if (!names)
+		return NULL;
+
+	for (i = 0; (name = tplg_file_name(files, i)); i++) {
+		if (i)
+			strcat(names, ",");
+
+		/* keep the extension, it selects the file format */
+		ext = strrchr(name, '.');
+		if (ext && strchr(ext, '/'))
+			ext = NULL;
+
+		strncat(names, name, ext ? ext - name : strlen(name));
+		strcat(names, suffix);
+		if (ext)
+			strcat(names, ext);
+		free(name);
+	}
+
+	return names;
+}
+
+/* compare output files of the variants, return 0 if bit exact */
+static int tb_ab_compare(const char *file_a, const char *file_b)
+{
+	long offset = 0, first = -1, count = 0;
+	FILE *fa, *fb;
+	int a, b;
+
+	fa = fopen(file_a, "rb");
+	fb = fopen(file_b, "rb");
+	if (!fa || !fb) {
+		fprintf(stderr, "error: opening %s or %s\n", file_a, file_b);
+		if (fa)
+			fclose(fa);
+		if (fb)
+			fclose(fb);
+		return -EINVAL;
+	}
+
+	do {
+		a = fgetc(fa);
+		b = fgetc(fb);
+		if (a != b) {
+			if (first < 0)
+				first = offset;
+			count++;
+		}
+		offset++;
+	} while (a != EOF || b != EOF);
+
+	fclose(fa);
+	fclose(fb);
+
+	if (!count) {
+		printf("%s and %s: bit exact\n", file_a, file_b);
+		return 0;
+	}
+
+	printf("%s and %s: %ld bytes differ, first at byte %ld\n", file_a,
+	       file_b, count, first);
+	return 1;
+}
+
+/*
+ * A/B test, the test runs with the default libraries (A) and with the
+ * libs_b overrides (B) in child processes one after the other, so the
+ * variants have the same start state and don't disturb each other's
+ * timing. Returns in the children with the variant set up, the parent
+ * compares the output files and the execution times and exits.
+ */
+static void tb_ab_run(char *libs_b, char **output_file)
+{
+	struct tb_result res[2];
+	char *output[2];
+	char *name_a, *name_b;
+	int status, diff = 0;
+	int fd[2];
+	pid_t pid;
+	int v, i;
+
+	output[0] = *output_file;
+	output[1] = tb_ab_file_names(*output_file, "_b");
+	if (!output[1]) {
+		fprintf(stderr, "error: mem alloc\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (v = 0; v < 2; v++) {
+		if (pipe(fd) < 0) {
+			fprintf(stderr, "error: A/B pipe\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/* don't print buffered output twice */
+		fflush(stdout);
+		pid = fork();
+		if (pid < 0) {
+			fprintf(stderr, "error: A/B fork\n");
+			exit(EXIT_FAILURE);
+		}
+
+		if (!pid) {
+			close(fd[0]);
+			ab_fd = fd[1];
+			printf("Variant %c:\n", 'A' + v);
+			if (v && tplg_set_comp_libs(libs_b) < 0)
+				exit(EXIT_FAILURE);
+			*output_file = strdup(output[v]);
+			return;
+		}
+
+		close(fd[1]);
+		if (read(fd[0], &res[v], sizeof(res[v])) != sizeof(res[v]))
+			memset(&res[v], 0, sizeof(res[v]));
+		close(fd[0]);
+
+		if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+		    WEXITSTATUS(status) != EXIT_SUCCESS) {
+			fprintf(stderr, "error: variant %c failed\n", 'A' + v);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	printf("==========================================================\n");
+	printf("		           A/B Summary\n");
+	printf("==========================================================\n");
+	for (i = 0; (name_a = tplg_file_name(output[0], i)); i++) {
+		name_b = tplg_file_name(output[1], i);
+		if (tb_ab_compare(name_a, name_b))
+			diff = 1;
+		free(name_a);
+		free(name_b);
+	}
+
+	for (v = 0; v < 2; v++)
+		printf("Variant %c: %d samples in %.2f ms, %.2f x realtime\n",
+		       'A' + v, res[v].n_out, 1e3 * res[v].t_exec,
+		       res[v].c_realtime);
+
+	if (res[0].t_exec > 0 && res[1].t_exec > 0)
+		printf("Variant B speed: %.2f x variant A\n",
+		       res[0].t_exec / res[1].t_exec);
+
+	free(output[1]);
+	exit(diff ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* free all ipc objects of type, ipc_*_free() look them up by id */
+static void free_comps_type(int type)
 {
 	struct list_item *clist;
 	struct list_item *temp;
@@ -110,60 +511,56 @@ static void free_comps(void)
 
 	list_for_item_safe(clist, temp, &sof.ipc->comp_list) {
 		icd = container_of(clist, struct ipc_comp_dev, list);
-		switch (icd->type) {
+		if (icd->type != type)
+			continue;
+
+		switch (type) {
 		case COMP_TYPE_COMPONENT:
-			comp_free(icd->cd);
-			list_item_del(&icd->list);
-			rfree(icd);
+			ipc_comp_free(sof.ipc, icd->cd->comp.id);
 			break;
 		case COMP_TYPE_BUFFER:
-			rfree(icd->cb->addr);
-			rfree(icd->cb);
-			list_item_del(&icd->list);
-			rfree(icd);
+			ipc_buffer_free(sof.ipc, icd->cb->ipc_buffer.comp.id);
 			break;
 		default:
-			rfree(icd->pipeline);
-			list_item_del(&icd->list);
-			rfree(icd);
+			ipc_pipeline_free(sof.ipc,
+					  icd->pipeline->ipc_pipe.comp_id);
 			break;
 		}
 	}
 }
 
+/* free components, pipelines first as they disconnect their components
+ * and release the buffer arena
+ */
+static void free_comps(void)
+{
+	free_comps_type(COMP_TYPE_PIPELINE);
+	free_comps_type(COMP_TYPE_BUFFER);
+	free_comps_type(COMP_TYPE_COMPONENT);
+}
+
 int main(int argc, char **argv)
 {
 	struct ipc_comp_dev *pcm_dev;
 	struct pipeline *p;
 	struct sof_ipc_pipe_new *ipc_pipe;
-	struct comp_dev *cd;
 	struct file_comp_data *frcd, *fwcd;
-	char *tplg_file = NULL, *input_file = NULL;
+	char *tplg_file = NULL, *input_file = NULL, *cache_file = NULL;
+	struct tplg_cache *cache = NULL;
 	char *output_file = NULL, *bits_in = "S32_LE";
 	char pipeline[DEBUG_MSG_LEN];
-	clock_t tic, toc;
+	struct timespec tic, toc;
 	double c_realtime, t_exec;
 	int fs, n_in, n_out, ret;
+	int num_threads = 1;
+	int i;
 	int option = 0;
 
-	/* volume component share library handle */
-	void *vol_handle = NULL;
-
-	/* TODO: create a shared library table for all components */
-	/*set up default volume shared library */
-	if (!vol_handle) {
-		vol_handle = dlopen("libsof_volume.so", RTLD_LAZY);
-		if (!vol_handle) {
-			fprintf(stderr, "error: %s\n", dlerror());
-			exit(EXIT_FAILURE);
-		}
-	}
-
-	/* set up trace class definition table from trace header */
-	setup_trace_table();
+	struct tb_result res;
+	char *ab_libs = NULL;
 
 	/* command line arguments*/
-	while ((option = getopt(argc, argv, "hdi:o:t:b:a:")) != -1) {
+	while ((option = getopt(argc, argv, "hdi:o:t:b:a:B:T:mc:")) != -1) {
 		switch (option) {
 		/* input sample file */
 		case 'i':
@@ -187,7 +584,13 @@ int main(int argc, char **argv)
 
 		/* override default libraries */
 		case 'a':
-			parse_libraries(optarg, vol_handle);
+			if (tplg_set_comp_libs(optarg) < 0)
+				exit(EXIT_FAILURE);
+			break;
+
+		/* libraries of variant B in A/B test */
+		case 'B':
+			ab_libs = optarg;
 			break;
 
 		/* enable debug prints */
@@ -195,6 +598,21 @@ int main(int argc, char **argv)
 			debug = 1;
 			break;
 
+		/* number of pipeline worker threads */
+		case 'T':
+			num_threads = atoi(optarg);
+			break;
+
+		/* emulate firmware heap */
+		case 'm':
+			tb_heap_emulate();
+			break;
+
+		/* topology cache file */
+		case 'c':
+			cache_file = strdup(optarg);
+			break;
+
 		/* print usage */
 		case 'h':
 		default:
@@ -203,23 +621,63 @@ int main(int argc, char **argv)
 		}
 	}
 
+	/* use a valid topology cache instead of parsing the topology */
+	if (cache_file)
+		cache = tplg_cache_open(cache_file, tplg_file, bits_in);
+
 	/* check args */
-	if (!tplg_file || !input_file || !output_file) {
+	if ((!tplg_file && !cache) || !input_file || !output_file ||
+	    num_threads < 1 || num_threads > TB_MAX_THREADS) {
 		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
+	/* A/B test, only returns in the variant processes */
+	if (ab_libs)
+		tb_ab_run(ab_libs, &output_file);
+
+	/* set up trace class definition table */
+	if (cache) {
+		if (tplg_cache_trace_table(cache) < 0) {
+			fprintf(stderr, "error: trace table\n");
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		setup_trace_table();
+	}
+
 	/* initialize ipc and scheduler */
 	if (tb_pipeline_setup(&sof) < 0) {
 		fprintf(stderr, "error: pipeline init\n");
 		exit(EXIT_FAILURE);
 	}
 
-	/* parse topology file and create pipeline */
-	if (parse_topology(tplg_file, &sof, &fr_id, &fw_id, &sched_id, bits_in,
-			   input_file, output_file, vol_handle, pipeline) < 0) {
-		fprintf(stderr, "error: parsing topology\n");
-		exit(EXIT_FAILURE);
+	if (cache) {
+		/* create pipeline from the cached IPC objects */
+		if (tplg_register_comps() < 0 ||
+		    tplg_cache_load(cache, &sof, &fr_id, &fw_id, &sched_id,
+				    input_file, output_file, pipeline) < 0) {
+			fprintf(stderr, "error: loading topology cache\n");
+			exit(EXIT_FAILURE);
+		}
+		tplg_cache_close(cache);
+	} else {
+		/* parse topology file and create pipeline */
+		if (cache_file)
+			tplg_cache_record_start();
+
+		if (parse_topology(tplg_file, &sof, &fr_id, &fw_id, &sched_id,
+				   bits_in, input_file, output_file,
+				   pipeline) < 0) {
+			fprintf(stderr, "error: parsing topology\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/* save the objects for the next run */
+		if (cache_file &&
+		    tplg_cache_write(cache_file, tplg_file, bits_in, fr_id,
+				     fw_id, sched_id, pipeline) < 0)
+			fprintf(stderr, "warning: topology cache not saved\n");
 	}
 
 	/* Get pointers to fileread and filewrite */
@@ -235,34 +693,49 @@ int main(int argc, char **argv)
 
 	fs = ipc_pipe->deadline * ipc_pipe->frames_per_sched;
 
+	/* find all pipelines and the joins between them */
+	if (tb_pool_init() < 0) {
+		fprintf(stderr, "error: pipeline pool\n");
+		exit(EXIT_FAILURE);
+	}
+
 	/* set pipeline params and trigger start */
-	if (tb_pipeline_start(sof.ipc, TESTBENCH_NCH, bits_in, ipc_pipe) < 0) {
+	if (tb_pool_start(bits_in) < 0) {
 		fprintf(stderr, "error: pipeline params\n");
 		exit(EXIT_FAILURE);
 	}
 
-	cd = pcm_dev->cd;
 	tb_enable_trace(false); /* reduce trace output */
-	tic = clock();
+	clock_gettime(CLOCK_MONOTONIC, &tic);
 
-	while (frcd->fs.reached_eof == 0)
-		pipeline_schedule_copy(p, 0);
+	if (tb_pool_run(num_threads) < 0) {
+		fprintf(stderr, "error: pipeline run\n");
+		exit(EXIT_FAILURE);
+	}
 
 	if (!frcd->fs.reached_eof)
 		printf("warning: possible pipeline xrun\n");
 
 	/* reset and free pipeline */
-	toc = clock();
+	clock_gettime(CLOCK_MONOTONIC, &toc);
 	tb_enable_trace(true);
-	ret = pipeline_reset(p, cd);
-	if (ret < 0) {
-		fprintf(stderr, "error: pipeline reset\n");
-		exit(EXIT_FAILURE);
+	for (i = 0; i < pool.num_pipes; i++) {
+		p = pool.pipes[i].p;
+		if (p->sched_comp->state <= COMP_STATE_READY)
+			continue;
+
+		ret = pipeline_reset(p, p->sched_comp);
+		if (ret < 0) {
+			fprintf(stderr, "error: pipeline reset\n");
+			exit(EXIT_FAILURE);
+		}
 	}
 
 	n_in = frcd->fs.n;
 	n_out = fwcd->fs.n;
-	t_exec = (double)(toc - tic) / CLOCKS_PER_SEC;
+	/* wall clock time as clock() adds up all worker threads */
+	t_exec = (toc.tv_sec - tic.tv_sec) +
+		(double)(toc.tv_nsec - tic.tv_nsec) / 1e9;
 	c_realtime = (double)n_out / TESTBENCH_NCH / fs / t_exec;
 
 	/* free all components/buffers in pipeline */
@@ -283,16 +756,28 @@ int main(int argc, char **argv)
 	printf("Output sample count: %d\n", n_out);
 	printf("Total execution time: %.2f us, %.2f x realtime\n",
 	       1e3 * t_exec, c_realtime);
+	tb_heap_report();
+
+	/* report result to the A/B test */
+	if (ab_fd >= 0) {
+		res.t_exec = t_exec;
+		res.c_realtime = c_realtime;
+		res.n_in = n_in;
+		res.n_out = n_out;
+		if (write(ab_fd, &res, sizeof(res)) != sizeof(res))
+			fprintf(stderr, "error: A/B result\n");
+		close(ab_fd);
+	}
 
 	/* free all other data */
 	free(bits_in);
 	free(input_file);
 	free(tplg_file);
 	free(output_file);
+	free(cache_file);
 
-	/* close shared library object */
-	if (vol_handle)
-		dlclose(vol_handle);
+	/* close shared library objects */
+	tplg_free_comps();
 
 	return EXIT_SUCCESS;
 }
@@ -40,39 +40,131 @@
 #include <dlfcn.h>
 #include <sof/audio/component.h>
 #include "host/topology.h"
+#include "host/tplg_cache.h"
 #include "host/file.h"
 
 char *input_file;
 char *output_file;
-void *volume_lib;
 FILE *file;
 char pipeline_string[DEBUG_MSG_LEN];
+static int num_fileread;
+static int num_filewrite;
+
+/*
+ * Component drivers in their own shared libraries. The library of each
+ * driver can be replaced by name, e.g. with an optimised variant.
+ */
+struct tplg_comp_lib {
+	const char *name;	/* driver name used on the command line */
+	int widget;		/* DAPM widget type using the driver */
+	const char *lib;	/* shared library */
+	const char *init;	/* driver register function */
+	void *handle;
+	int registered;
+};
+
+static struct tplg_comp_lib comp_libs[] = {
+	{"vol", SND_SOC_TPLG_DAPM_PGA, "libsof_volume.so",
+		"sys_comp_volume_init"},
+	{"src", SND_SOC_TPLG_DAPM_SRC, "libsof_src.so", "sys_comp_src_init"},
+	{"eq_fir", SND_SOC_TPLG_DAPM_EFFECT, "libsof_eq_fir.so",
+		"sys_comp_eq_fir_init"},
+	{"eq_iir", SND_SOC_TPLG_DAPM_EFFECT, "libsof_eq_iir.so",
+		"sys_comp_eq_iir_init"},
+	{"mixer", SND_SOC_TPLG_DAPM_MIXER, "libsof_mixer.so",
+		"sys_comp_mixer_init"},
+	{"mux", SND_SOC_TPLG_DAPM_MUX, "libsof_mux.so", "sys_comp_mux_init"},
+	{"switch", SND_SOC_TPLG_DAPM_SWITCH, "libsof_switch.so",
+		"sys_comp_switch_init"},
+	{"tone", SND_SOC_TPLG_DAPM_SIGGEN, "libsof_tone.so",
+		"sys_comp_tone_init"},
+};
+
+/* use lib for the named driver, must be called before registration */
+int tplg_set_comp_lib(const char *name, const char *lib)
+{
+	char message[DEBUG_MSG_LEN];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(comp_libs); i++) {
+		if (strcmp(comp_libs[i].name, name))
+			continue;
+
+		comp_libs[i].lib = lib;
+		snprintf(message, sizeof(message), "%s comp driver from %s\n",
+			 name, lib);
+		debug_print(message);
+		return 0;
+	}
+
+	fprintf(stderr, "error: unknown comp driver %s\n", name);
+	return -EINVAL;
+}
+
+/* set driver libraries from a "name=lib,name=lib" list, modifies libs */
+int tplg_set_comp_libs(char *libs)
+{
+	char *lib_token, *comp_token;
+	char *token = strtok_r(libs, ",", &lib_token);
+	char *name, *lib;
+
+	while (token) {
+		name = strtok_r(token, "=", &comp_token);
+		lib = strtok_r(NULL, "=", &comp_token);
+		if (!name || !lib) {
+			fprintf(stderr, "error: bad comp library %s\n", token);
+			return -EINVAL;
+		}
+
+		if (tplg_set_comp_lib(name, lib) < 0)
+			return -EINVAL;
+
+		token = strtok_r(NULL, ",", &lib_token);
+	}
+
+	return 0;
+}
+
+/* open library and register the component driver */
+static int register_comp_lib(struct tplg_comp_lib *cl)
+{
+	char message[DEBUG_MSG_LEN];
+	void (*comp_init)(void);
+
+	cl->handle = dlopen(cl->lib, RTLD_LAZY);
+	if (!cl->handle) {
+		fprintf(stderr, "error: %s\n", dlerror());
+		return -EINVAL;
+	}
+
+	comp_init = (void (*)(void))dlsym(cl->handle, cl->init);
+	if (!comp_init) {
+		fprintf(stderr, "error: %s\n", dlerror());
+		return -EINVAL;
+	}
+
+	sprintf(message, "register %s comp driver\n", cl->init);
+	debug_print(message);
+
+	comp_init();
+	cl->registered = 1;
+	return 0;
+}
 
 /*
  * Register component driver
  * Only needed once per component type
  */
-static void register_comp(int comp_type)
+static int register_comp(int comp_type)
 {
-	static int pga_reg;
 	static int file_reg;
+	int i, ret;
 
 	switch (comp_type) {
-	case SND_SOC_TPLG_DAPM_PGA:
-		/* register comp driver if not already registered */
-		if (!pga_reg) {
-			debug_print("register pga comp driver\n");
-
-			/* register volume driver */
-			void (*sys_comp_volume_init)() =
-				(void (*)(void))dlsym(volume_lib,
-						      "sys_comp_volume_init");
-			sys_comp_volume_init();
-			pga_reg = 1;
-		}
-		break;
 	case SND_SOC_TPLG_DAPM_DAI_IN:
+	case SND_SOC_TPLG_DAPM_DAI_OUT:
 	case SND_SOC_TPLG_DAPM_AIF_IN:
+	case SND_SOC_TPLG_DAPM_AIF_OUT:
 		/* register comp driver if not already registered */
 		if (!file_reg) {
 			debug_print("register file comp driver\n");
@@ -81,10 +173,64 @@ static void register_comp(int comp_type)
 			sys_comp_file_init();
 			file_reg = 1;
 		}
-		break;
+		return 0;
 	default:
 		break;
 	}
+
+	for (i = 0; i < ARRAY_SIZE(comp_libs); i++) {
+		if (comp_libs[i].widget != comp_type || comp_libs[i].registered)
+			continue;
+
+		ret = register_comp_lib(&comp_libs[i]);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* register all component drivers, for users not parsing a topology */
+int tplg_register_comps(void)
+{
+	int i, ret;
+
+	for (i = 0; i < ARRAY_SIZE(comp_libs); i++) {
+		ret = register_comp(comp_libs[i].widget);
+		if (ret < 0)
+			return ret;
+	}
+
+	return register_comp(SND_SOC_TPLG_DAPM_AIF_IN);
+}
+
+/* close component driver libraries */
+void tplg_free_comps(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(comp_libs); i++) {
+		if (comp_libs[i].handle)
+			dlclose(comp_libs[i].handle);
+		comp_libs[i].handle = NULL;
+		comp_libs[i].registered = 0;
+	}
+}
+
+/* get n-th name from comma separated list of file names */
+char *tplg_file_name(const char *files, int n)
+{
+	const char *end;
+
+	while (n-- > 0) {
+		files = strchr(files, ',');
+		if (!files)
+			return NULL;
+		files++;
+	}
+
+	end = strchr(files, ',');
+	return strndup(files, end ? end - files : strlen(files));
 }
 
 /* read vendor tuples array from topology */
@@ -157,14 +303,15 @@ static int load_graph(struct sof *sof, struct comp_info *temp_comp_list,
 	}
 
 	/* set up component connections */
-	connection.source_id = -1;
-	connection.sink_id = -1;
 	for (i = 0; i < count; i++) {
 		size = sizeof(struct snd_soc_tplg_dapm_graph_elem);
 		ret = fread(graph_elem, size, 1, file);
 		if (ret != 1)
 			return -EINVAL;
 
+		connection.source_id = -1;
+		connection.sink_id = -1;
+
 		/* look up component id from the component list */
 		for (j = 0; j < num_comps; j++) {
 			if (strcmp(temp_comp_list[j].name,
@@ -183,18 +330,25 @@ static int load_graph(struct sof *sof, struct comp_info *temp_comp_list,
 			strcat(pipeline_string, graph_elem->sink);
 
 		/* connect source and sink */
-		if (connection.source_id != -1 && connection.sink_id != -1)
+		if (connection.source_id != -1 && connection.sink_id != -1) {
 			if (ipc_comp_connect(sof->ipc, &connection) < 0) {
 				fprintf(stderr, "error: comp connect\n");
 				return -EINVAL;
 			}
+			tplg_cache_record(TPLG_CACHE_CONNECT, &connection,
+					  sizeof(connection));
+		}
 	}
 
 	/* pipeline complete after pipeline connections are established */
 	for (i = 0; i < num_comps; i++) {
 		if (temp_comp_list[i].pipeline_id == pipeline_id &&
-		    temp_comp_list[i].type == SND_SOC_TPLG_DAPM_SCHEDULER)
+		    temp_comp_list[i].type == SND_SOC_TPLG_DAPM_SCHEDULER) {
 			ipc_pipeline_complete(sof->ipc, temp_comp_list[i].id);
+			tplg_cache_record(TPLG_CACHE_COMPLETE,
+					  &temp_comp_list[i].id,
+					  sizeof(uint32_t));
+		}
 	}
 
 	free(graph_elem);
@@ -229,10 +383,89 @@ static int load_buffer(struct sof *sof, int comp_id, int pipeline_id, int size)
 		fprintf(stderr, "error: buffer new\n");
 		return -EINVAL;
 	}
+	tplg_cache_record(TPLG_CACHE_BUFFER, &buffer, sizeof(buffer));
 	free(array);
 	return 0;
 }
 
+/*
+ * Read the vendor arrays of widget private data. Generic component tokens
+ * are parsed into config and the component specific tokens into object.
+ */
+static int load_comp_tokens(void *object, struct sof_ipc_comp_config *config,
+			    const struct sof_topology_token *tokens,
+			    int count, int size)
+{
+	struct snd_soc_tplg_vendor_array *array = NULL;
+	size_t total_array_size = 0, read_size;
+	int ret = 0;
+
+	if (size <= 0)
+		return 0;
+
+	/* allocate memory for vendor tuple array */
+	array = (struct snd_soc_tplg_vendor_array *)malloc(size);
+	if (!array) {
+		printf("error: mem alloc\n");
+		return -EINVAL;
+	}
+
+	/* read vendor tokens */
+	while (total_array_size < size) {
+		read_size = sizeof(struct snd_soc_tplg_vendor_array);
+		ret = fread(array, read_size, 1, file);
+		if (ret != 1) {
+			ret = -EINVAL;
+			break;
+		}
+
+		ret = read_array(array);
+		if (ret < 0)
+			break;
+
+		/* parse comp tokens */
+		if (config) {
+			ret = sof_parse_tokens(config, comp_tokens,
+					       ARRAY_SIZE(comp_tokens), array,
+					       array->size);
+			if (ret != 0)
+				break;
+		}
+
+		/* parse component specific tokens */
+		if (count) {
+			ret = sof_parse_tokens(object, tokens, count, array,
+					       array->size);
+			if (ret != 0)
+				break;
+		}
+
+		total_array_size += array->size;
+	}
+
+	free(array);
+	return ret;
+}
+
+/* set up IPC header of a component and create it */
+static int tplg_comp_new(struct sof *sof, struct sof_ipc_comp *comp,
+			 uint32_t size, enum sof_comp_type type, int comp_id,
+			 int pipeline_id)
+{
+	comp->hdr.size = size;
+	comp->id = comp_id;
+	comp->type = type;
+	comp->pipeline_id = pipeline_id;
+
+	if (ipc_comp_new(sof->ipc, comp) < 0) {
+		fprintf(stderr, "error: comp register\n");
+		return -EINVAL;
+	}
+	tplg_cache_record(TPLG_CACHE_COMP, comp, size);
+
+	return 0;
+}
+
 /* load fileread component */
 static int load_fileread(struct sof *sof, int comp_id, int pipeline_id,
 			 int size, char *bits_in, int *fr_id, int *sched_id)
@@ -270,13 +503,22 @@ static int load_fileread(struct sof *sof, int comp_id, int pipeline_id,
 		total_array_size += array->size;
 	}
 
-	/* configure fileread */
-	fileread.fn = strdup(input_file);
+	/* configure fileread, one input file per fileread */
+	fileread.fn = tplg_file_name(input_file, num_fileread);
+	if (!fileread.fn) {
+		fprintf(stderr, "error: no input file for fileread %d\n",
+			num_fileread);
+		return -EINVAL;
+	}
 	fileread.mode = FILE_READ;
 	fileread.comp.id = comp_id;
 
+	/* first fileread is reported by the testbench */
+	if (!num_fileread++)
+		*fr_id = comp_id;
+
 	/* use fileread comp as scheduling comp */
-	*fr_id = *sched_id = comp_id;
+	*sched_id = comp_id;
 	fileread.comp.hdr.size = sizeof(struct sof_ipc_comp_file);
 	fileread.comp.type = SOF_COMP_FILEREAD;
 	fileread.comp.pipeline_id = pipeline_id;
@@ -286,6 +528,7 @@ static int load_fileread(struct sof *sof, int comp_id, int pipeline_id,
 		fprintf(stderr, "error: comp register\n");
 		return -EINVAL;
 	}
+	tplg_cache_record(TPLG_CACHE_COMP, &fileread, sizeof(fileread));
 
 	free(array);
 	free(fileread.fn);
@@ -328,11 +571,19 @@ static int load_filewrite(struct sof *sof, int comp_id, int pipeline_id,
 		total_array_size += array->size;
 	}
 
-	/* configure filewrite */
-	filewrite.fn = strdup(output_file);
+	/* configure filewrite, one output file per filewrite */
+	filewrite.fn = tplg_file_name(output_file, num_filewrite);
+	if (!filewrite.fn) {
+		fprintf(stderr, "error: no output file for filewrite %d\n",
+			num_filewrite);
+		return -EINVAL;
+	}
 	filewrite.comp.id = comp_id;
 	filewrite.mode = FILE_WRITE;
-	*fw_id = comp_id;
+
+	/* first filewrite is reported by the testbench */
+	if (!num_filewrite++)
+		*fw_id = comp_id;
 	filewrite.comp.hdr.size = sizeof(struct sof_ipc_comp_file);
 	filewrite.comp.type = SOF_COMP_FILEREAD;
 	filewrite.comp.pipeline_id = pipeline_id;
@@ -342,75 +593,128 @@ static int load_filewrite(struct sof *sof, int comp_id, int pipeline_id,
 		fprintf(stderr, "error: comp register\n");
 		return -EINVAL;
 	}
+	tplg_cache_record(TPLG_CACHE_COMP, &filewrite, sizeof(filewrite));
 
 	free(array);
 	free(filewrite.fn);
 	return 0;
 }
 
-/* load pda dapm widget */
+/* load pga dapm widget */
 static int load_pga(struct sof *sof, int comp_id, int pipeline_id,
 		    int size)
 {
 	struct sof_ipc_comp_volume volume;
-	struct snd_soc_tplg_vendor_array *array = NULL;
-	size_t total_array_size = 0, read_size;
-	int ret = 0;
 
-	/* allocate memory for vendor tuple array */
-	array = (struct snd_soc_tplg_vendor_array *)malloc(size);
-	if (!array) {
-		printf("error: mem alloc\n");
+	memset(&volume, 0, sizeof(volume));
+	if (load_comp_tokens(&volume, &volume.config, volume_tokens,
+			     ARRAY_SIZE(volume_tokens), size) < 0) {
+		printf("error: parse pga tokens %d\n", size);
 		return -EINVAL;
 	}
 
-	/* read vendor tokens */
-	while (total_array_size < size) {
-		read_size = sizeof(struct snd_soc_tplg_vendor_array);
-		ret = fread(array, read_size, 1, file);
-		if (ret != 1)
-			return -EINVAL;
-		read_array(array);
+	return tplg_comp_new(sof, &volume.comp, sizeof(volume),
+			     SOF_COMP_VOLUME, comp_id, pipeline_id);
+}
 
-		/* parse volume tokens */
-		ret = sof_parse_tokens(&volume.config, comp_tokens,
-				       ARRAY_SIZE(comp_tokens), array,
-				       array->size);
-		if (ret != 0) {
-			printf("error: parse pga tokens %d\n", size);
-			return -EINVAL;
-		}
-		total_array_size += array->size;
+/* load src dapm widget */
+static int load_src(struct sof *sof, int comp_id, int pipeline_id,
+		    int size)
+{
+	struct sof_ipc_comp_src src;
+
+	memset(&src, 0, sizeof(src));
+	if (load_comp_tokens(&src, &src.config, src_tokens,
+			     ARRAY_SIZE(src_tokens), size) < 0) {
+		printf("error: parse src tokens %d\n", size);
+		return -EINVAL;
 	}
 
-	/* configure volume */
-	volume.comp.id = comp_id;
-	volume.comp.hdr.size = sizeof(struct sof_ipc_comp_volume);
-	volume.comp.type = SOF_COMP_VOLUME;
-	volume.comp.pipeline_id = pipeline_id;
+	return tplg_comp_new(sof, &src.comp, sizeof(src), SOF_COMP_SRC,
+			     comp_id, pipeline_id);
+}
 
-	/* load volume component */
-	if (ipc_comp_new(sof->ipc, (struct sof_ipc_comp *)&volume) < 0) {
-		fprintf(stderr, "error: comp register\n");
+/* load mixer, mux and switch dapm widgets, they only have comp tokens */
+static int load_mixer(struct sof *sof, int comp_id, int pipeline_id,
+		      int size, enum sof_comp_type type)
+{
+	struct sof_ipc_comp_mixer mixer;
+
+	memset(&mixer, 0, sizeof(mixer));
+	if (load_comp_tokens(&mixer, &mixer.config, NULL, 0, size) < 0) {
+		printf("error: parse mixer tokens %d\n", size);
 		return -EINVAL;
 	}
 
-	free(array);
-	return 0;
+	return tplg_comp_new(sof, &mixer.comp, sizeof(mixer), type,
+			     comp_id, pipeline_id);
+}
+
+/* load siggen dapm widget */
+static int load_tone(struct sof *sof, int comp_id, int pipeline_id,
+		     int size)
+{
+	struct sof_ipc_comp_tone tone;
+
+	memset(&tone, 0, sizeof(tone));
+	if (load_comp_tokens(&tone, &tone.config, tone_tokens,
+			     ARRAY_SIZE(tone_tokens), size) < 0) {
+		printf("error: parse tone tokens %d\n", size);
+		return -EINVAL;
+	}
+
+	return tplg_comp_new(sof, &tone.comp, sizeof(tone), SOF_COMP_TONE,
+			     comp_id, pipeline_id);
+}
+
+/* load effect dapm widget, the effect type token selects the EQ */
+static int load_effect(struct sof *sof, int comp_id, int pipeline_id,
+		       int size)
+{
+	struct sof_ipc_comp_eq_fir eq;
+	uint32_t type = SOF_COMP_NONE;
+
+	memset(&eq, 0, sizeof(eq));
+	if (load_comp_tokens(&type, &eq.config, effect_tokens,
+			     ARRAY_SIZE(effect_tokens), size) < 0) {
+		printf("error: parse effect tokens %d\n", size);
+		return -EINVAL;
+	}
+
+	if (type != SOF_COMP_EQ_FIR && type != SOF_COMP_EQ_IIR) {
+		printf("error: effect type not supported\n");
+		return -EINVAL;
+	}
+
+	/* FIR and IIR EQ IPC structs are the same */
+	return tplg_comp_new(sof, &eq.comp, sizeof(eq), type, comp_id,
+			     pipeline_id);
 }
 
 /* load scheduler dapm widget */
 static int load_pipeline(struct sof *sof, struct sof_ipc_pipe_new *pipeline,
-			 int comp_id, int pipeline_id, int size, int *sched_id)
+			 int comp_id, int pipeline_id, int size, int *sched_id,
+			 struct comp_info *temp_comp_list, int num_comps,
+			 const char *sname)
 {
 	struct snd_soc_tplg_vendor_array *array = NULL;
 	size_t total_array_size = 0, read_size;
 	int ret = 0;
+	int i;
 
-	/* configure pipeline */
+	/* scheduling comp is named by the widget stream name */
 	pipeline->sched_id = *sched_id;
+	for (i = 0; i < num_comps; i++) {
+		if (strcmp(temp_comp_list[i].name, sname) == 0) {
+			pipeline->sched_id = temp_comp_list[i].id;
+			break;
+		}
+	}
+
+	/* configure pipeline */
 	pipeline->comp_id = comp_id;
 	pipeline->pipeline_id = pipeline_id;
+	pipeline->periods_per_sched = 1;
 
 	/* allocate memory for vendor tuple array */
 	array = (struct snd_soc_tplg_vendor_array *)malloc(size);
@@ -446,16 +750,60 @@ static int load_pipeline(struct sof *sof, struct sof_ipc_pipe_new *pipeline,
 		fprintf(stderr, "error: pipeline new\n");
 		return -EINVAL;
 	}
+	tplg_cache_record(TPLG_CACHE_PIPELINE, pipeline, sizeof(*pipeline));
 
 	free(array);
 	return 0;
 }
 
+/* send bytes control private data, e.g. EQ coefficients, to the comp */
+static int load_bytes_data(struct sof *sof, int comp_id, int size)
+{
+	struct sof_ipc_ctrl_data *cdata;
+	struct ipc_comp_dev *icd;
+	int ret = 0;
+
+	cdata = calloc(1, sizeof(*cdata) + size);
+	if (!cdata) {
+		printf("error: mem alloc\n");
+		return -EINVAL;
+	}
+
+	if (fread(cdata->data, size, 1, file) != 1) {
+		free(cdata);
+		return -EINVAL;
+	}
+
+	/* controls without an ABI blob are left to the component defaults */
+	icd = ipc_get_comp(sof->ipc, comp_id);
+	if (!icd || icd->type != COMP_TYPE_COMPONENT ||
+	    size < sizeof(struct sof_abi_hdr) ||
+	    cdata->data->magic != SOF_ABI_MAGIC)
+		goto out;
+
+	cdata->rhdr.hdr.size = sizeof(*cdata) + size;
+	cdata->comp_id = comp_id;
+	cdata->type = SOF_CTRL_TYPE_DATA_SET;
+	cdata->cmd = SOF_CTRL_CMD_BINARY;
+	cdata->num_elems = size;
+
+	ret = comp_cmd(icd->cd, COMP_CMD_SET_DATA, cdata);
+	if (ret < 0)
+		printf("error: bytes control data for comp %d\n", comp_id);
+	else
+		tplg_cache_record(TPLG_CACHE_CTRL_DATA, cdata,
+				  cdata->rhdr.hdr.size);
+
+out:
+	free(cdata);
+	return ret;
+}
+
 /* load dapm widget kcontrols
- * we dont use controls in the testbench atm.
- * so just skip to the next dapm widget
+ * mixer and enum controls are not used in the testbench atm. and are
+ * skipped, bytes control data is sent to the component.
  */
-static int load_controls(struct sof *sof, int num_kcontrols)
+static int load_controls(struct sof *sof, int comp_id, int num_kcontrols)
 {
 	struct snd_soc_tplg_ctl_hdr *ctl_hdr;
 	struct snd_soc_tplg_mixer_control *mixer_ctl;
@@ -547,8 +895,11 @@ static int load_controls(struct sof *sof, int num_kcontrols)
 			if (ret != 1)
 				return -EINVAL;
 
-			/* skip bytes private data */
-			fseek(file, bytes_ctl->priv.size, SEEK_CUR);
+			/* send bytes private data to the component */
+			if (bytes_ctl->priv.size > 0 &&
+			    load_bytes_data(sof, comp_id,
+					    bytes_ctl->priv.size) < 0)
+				return -EINVAL;
 			break;
 		default:
 			printf("control type not supported\n");
@@ -606,7 +957,8 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 	debug_print(message);
 
 	/* register comp driver */
-	register_comp(temp_comp_list[comp_index].type);
+	if (register_comp(temp_comp_list[comp_index].type) < 0)
+		return -EINVAL;
 
 	/* load widget based on type */
 	switch (temp_comp_list[comp_index].type) {
@@ -619,8 +971,65 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 		}
 		break;
 
-	/* replace pcm playback component with fileread in testbench */
+	/* load src widget */
+	case(SND_SOC_TPLG_DAPM_SRC):
+		if (load_src(sof, temp_comp_list[comp_index].id,
+			     pipeline_id, widget->priv.size) < 0) {
+			printf("error: load src\n");
+			return -EINVAL;
+		}
+		break;
+
+	/* load EQ widget */
+	case(SND_SOC_TPLG_DAPM_EFFECT):
+		if (load_effect(sof, temp_comp_list[comp_index].id,
+				pipeline_id, widget->priv.size) < 0) {
+			printf("error: load effect\n");
+			return -EINVAL;
+		}
+		break;
+
+	/* load mixer, mux and switch widgets */
+	case(SND_SOC_TPLG_DAPM_MIXER):
+		if (load_mixer(sof, temp_comp_list[comp_index].id,
+			       pipeline_id, widget->priv.size,
+			       SOF_COMP_MIXER) < 0) {
+			printf("error: load mixer\n");
+			return -EINVAL;
+		}
+		break;
+	case(SND_SOC_TPLG_DAPM_MUX):
+		if (load_mixer(sof, temp_comp_list[comp_index].id,
+			       pipeline_id, widget->priv.size,
+			       SOF_COMP_MUX) < 0) {
+			printf("error: load mux\n");
+			return -EINVAL;
+		}
+		break;
+	case(SND_SOC_TPLG_DAPM_SWITCH):
+		if (load_mixer(sof, temp_comp_list[comp_index].id,
+			       pipeline_id, widget->priv.size,
+			       SOF_COMP_SWITCH) < 0) {
+			printf("error: load switch\n");
+			return -EINVAL;
+		}
+		break;
+
+	/* load tone widget */
+	case(SND_SOC_TPLG_DAPM_SIGGEN):
+		if (load_tone(sof, temp_comp_list[comp_index].id,
+			      pipeline_id, widget->priv.size) < 0) {
+			printf("error: load tone\n");
+			return -EINVAL;
+		}
+		break;
+
+	/*
+	 * replace pcm playback component and capture dai with fileread
+	 * in testbench
+	 */
 	case(SND_SOC_TPLG_DAPM_AIF_IN):
+	case(SND_SOC_TPLG_DAPM_DAI_OUT):
 		if (load_fileread(sof, temp_comp_list[comp_index].id,
 				  pipeline_id, widget->priv.size, bits_in,
 				  fr_id, sched_id) < 0) {
@@ -629,8 +1038,12 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 		}
 		break;
 
-	/* replace dai in component with filewrite in testbench */
+	/*
+	 * replace playback dai and pcm capture component with filewrite
+	 * in testbench
+	 */
 	case(SND_SOC_TPLG_DAPM_DAI_IN):
+	case(SND_SOC_TPLG_DAPM_AIF_OUT):
 		if (load_filewrite(sof, temp_comp_list[comp_index].id,
 				   pipeline_id, widget->priv.size,
 				   fw_id) < 0) {
@@ -654,8 +1067,9 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 				  temp_comp_list[comp_index].id,
 				  pipeline_id,
 				  widget->priv.size,
-				  sched_id) < 0) {
-			printf("error: load buffer\n");
+				  sched_id, temp_comp_list, comp_index,
+				  widget->sname) < 0) {
+			printf("error: load pipeline\n");
 			return -EINVAL;
 		}
 		break;
@@ -664,13 +1078,15 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 	default:
 		printf("Widget type not supported %d\n",
 		       widget->id);
+		fseek(file, widget->priv.size, SEEK_CUR);
 		break;
 	}
 
 	/* load widget kcontrols */
 	if (widget->num_kcontrols > 0)
-		if (load_controls(sof, widget->num_kcontrols) < 0) {
-			printf("error: load buffer\n");
+		if (load_controls(sof, temp_comp_list[comp_index].id,
+				  widget->num_kcontrols) < 0) {
+			printf("error: load controls\n");
 			return -EINVAL;
 		}
 
@@ -681,7 +1097,7 @@ static int load_widget(struct sof *sof, int *fr_id, int *fw_id,
 /* parse topology file and set up pipeline */
 int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 		   int *sched_id, char *bits_in, char *in_file,
-		   char *out_file, void *volume_library, char *pipeline_msg)
+		   char *out_file, char *pipeline_msg)
 {
 	struct snd_soc_tplg_hdr *hdr;
 
@@ -692,9 +1108,6 @@ int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 	int i, ret = 0;
 	size_t file_size, size;
 
-	/* set volume library */
-	volume_lib = volume_library;
-
 	/* open topology file */
 	file = fopen(filename, "rb");
 	if (!file) {
@@ -702,9 +1115,11 @@ int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 		return -EINVAL;
 	}
 
-	/* set up fileread and  filewrite file names */
+	/* set up fileread and filewrite file name lists */
 	input_file = strdup(in_file);
 	output_file = strdup(out_file);
+	num_fileread = 0;
+	num_filewrite = 0;
 
 	/* file size */
 	fseek(file, 0, SEEK_END);
@@ -737,15 +1152,28 @@ int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 			sprintf(message, "number of DAPM widgets %d\n",
 				hdr->count);
 			debug_print(message);
-			size = sizeof(struct comp_info) * hdr->count;
-			temp_comp_list = (struct comp_info *)malloc(size);
-			num_comps = hdr->count;
-
-			for (i = 0; i < hdr->count; i++)
-				load_widget(sof, fr_id, fw_id, sched_id,
-					    bits_in, temp_comp_list,
-					    &pipeline, next_comp_id++,
-					    i, hdr->index);
+
+			/* each pipeline has its own widget block */
+			size = sizeof(struct comp_info) *
+				(num_comps + hdr->count);
+			temp_comp_list = (struct comp_info *)
+				realloc(temp_comp_list, size);
+			if (!temp_comp_list) {
+				printf("error: mem alloc\n");
+				return -EINVAL;
+			}
+
+			for (i = 0; i < hdr->count; i++) {
+				ret = load_widget(sof, fr_id, fw_id, sched_id,
+						  bits_in, temp_comp_list,
+						  &pipeline, next_comp_id++,
+						  num_comps + i, hdr->index);
+				if (ret < 0) {
+					printf("error: loading widget\n");
+					return -EINVAL;
+				}
+			}
+			num_comps += hdr->count;
 			break;
 
 		/* set up component connections from pipeline graph */
@@ -952,3 +1380,19 @@ int get_token_comp_format(void *elem, void *object, uint32_t offset,
 	*val = find_format(velem->string);
 	return 0;
 }
+
+int get_token_effect_type(void *elem, void *object, uint32_t offset,
+			  uint32_t size)
+{
+	struct snd_soc_tplg_vendor_string_elem *velem = elem;
+	uint32_t *val = object + offset;
+
+	if (!strcmp(velem->string, "EQFIR"))
+		*val = SOF_COMP_EQ_FIR;
+	else if (!strcmp(velem->string, "EQIIR"))
+		*val = SOF_COMP_EQ_IIR;
+	else
+		*val = SOF_COMP_NONE;
+
+	return 0;
+}
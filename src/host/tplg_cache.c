@@ -0,0 +1,458 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sof/ipc.h>
+#include <uapi/abi.h>
+#include "host/common_test.h"
+#include "host/topology.h"
+#include "host/trace.h"
+#include "host/file.h"
+#include "host/tplg_cache.h"
+
+struct tplg_cache {
+	void *image;
+	size_t size;
+};
+
+/* records made while parsing the topology */
+static struct {
+	uint8_t *data;
+	size_t size;
+	size_t alloc;
+	uint32_t count;
+	int enabled;
+	int error;
+} rec;
+
+void tplg_cache_record_start(void)
+{
+	free(rec.data);
+	memset(&rec, 0, sizeof(rec));
+	rec.enabled = 1;
+}
+
+void tplg_cache_record(uint32_t type, const void *data, uint32_t size)
+{
+	struct tplg_cache_rec *r;
+	size_t bytes = sizeof(*r) + TPLG_CACHE_ALIGN(size);
+	uint8_t *new_data;
+
+	if (!rec.enabled || rec.error)
+		return;
+
+	/* grow the record buffer */
+	if (rec.size + bytes > rec.alloc) {
+		rec.alloc = (rec.alloc + bytes) * 2;
+		new_data = realloc(rec.data, rec.alloc);
+		if (!new_data) {
+			fprintf(stderr, "error: topology cache mem alloc\n");
+			rec.error = 1;
+			return;
+		}
+		rec.data = new_data;
+	}
+
+	r = (struct tplg_cache_rec *)(rec.data + rec.size);
+	r->type = type;
+	r->size = size;
+	memcpy(r + 1, data, size);
+	memset((uint8_t *)(r + 1) + size, 0, TPLG_CACHE_ALIGN(size) - size);
+
+	rec.size += bytes;
+	rec.count++;
+}
+
+/* trace classes are recorded last, they are not made by the topology */
+static void record_trace_table(void)
+{
+	struct tplg_cache_trace tc;
+	int i;
+
+	for (i = 0; i < num_trace_classes; i++) {
+		memset(&tc, 0, sizeof(tc));
+		tc.trace_class = trace_table[i].trace_class;
+		strncpy(tc.name, trace_table[i].class_name,
+			sizeof(tc.name) - 1);
+		tplg_cache_record(TPLG_CACHE_TRACE_CLASS, &tc, sizeof(tc));
+	}
+}
+
+int tplg_cache_write(const char *filename, const char *tplg_file,
+		     const char *bits_in, int fr_id, int fw_id, int sched_id,
+		     const char *pipeline)
+{
+	struct tplg_cache_hdr hdr;
+	struct stat st;
+	FILE *fp;
+	int ret = 0;
+
+	record_trace_table();
+	rec.enabled = 0;
+
+	if (rec.error || stat(tplg_file, &st) < 0) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TPLG_CACHE_MAGIC;
+	hdr.version = TPLG_CACHE_VERSION;
+	hdr.abi = SOF_ABI_VER(SOF_ABI_MAJOR, SOF_ABI_MINOR);
+	hdr.size = TPLG_CACHE_ALIGN(sizeof(hdr)) + rec.size;
+	hdr.count = rec.count;
+	hdr.frame_fmt = find_format(bits_in);
+	hdr.tplg_size = st.st_size;
+	hdr.tplg_mtime = st.st_mtime;
+	hdr.fr_id = fr_id;
+	hdr.fw_id = fw_id;
+	hdr.sched_id = sched_id;
+	strncpy(hdr.pipeline, pipeline, sizeof(hdr.pipeline) - 1);
+
+	fp = fopen(filename, "wb");
+	if (!fp) {
+		fprintf(stderr, "error: opening file %s\n", filename);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	/* header is padded to the record alignment */
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    fseek(fp, TPLG_CACHE_ALIGN(sizeof(hdr)), SEEK_SET) < 0 ||
+	    (rec.size && fwrite(rec.data, rec.size, 1, fp) != 1)) {
+		fprintf(stderr, "error: writing file %s\n", filename);
+		ret = -EIO;
+	}
+
+	if (fclose(fp) < 0)
+		ret = -EIO;
+
+	/* don't leave a partial image for the next run */
+	if (ret < 0)
+		unlink(filename);
+
+out:
+	free(rec.data);
+	memset(&rec, 0, sizeof(rec));
+	return ret;
+}
+
+/* the payload must hold the object tplg_cache_load() passes on */
+static int cache_rec_validate(struct tplg_cache_rec *r)
+{
+	struct sof_ipc_ctrl_data *cdata;
+	struct sof_ipc_comp *comp;
+	void *data = r + 1;
+
+	switch (r->type) {
+	case TPLG_CACHE_COMP:
+		comp = data;
+		if (r->size < sizeof(*comp) || comp->hdr.size > r->size)
+			return -EINVAL;
+		if (comp->type == SOF_COMP_FILEREAD &&
+		    r->size < sizeof(struct sof_ipc_comp_file))
+			return -EINVAL;
+		break;
+	case TPLG_CACHE_BUFFER:
+		if (r->size < sizeof(struct sof_ipc_buffer))
+			return -EINVAL;
+		break;
+	case TPLG_CACHE_PIPELINE:
+		if (r->size < sizeof(struct sof_ipc_pipe_new))
+			return -EINVAL;
+		break;
+	case TPLG_CACHE_CONNECT:
+		if (r->size < sizeof(struct sof_ipc_pipe_comp_connect))
+			return -EINVAL;
+		break;
+	case TPLG_CACHE_COMPLETE:
+		if (r->size < sizeof(uint32_t))
+			return -EINVAL;
+		break;
+	case TPLG_CACHE_CTRL_DATA:
+		cdata = data;
+		if (r->size < sizeof(*cdata) || cdata->rhdr.hdr.size != r->size)
+			return -EINVAL;
+		break;
+	case TPLG_CACHE_TRACE_CLASS:
+		if (r->size < sizeof(struct tplg_cache_trace))
+			return -EINVAL;
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+/* check the header and that all records are inside the image and valid */
+static int cache_validate(struct tplg_cache_hdr *hdr, size_t size,
+			  const char *tplg_file, const char *bits_in)
+{
+	struct tplg_cache_rec *r;
+	size_t offset = TPLG_CACHE_ALIGN(sizeof(*hdr));
+	struct stat st;
+	uint32_t i;
+
+	if (size < offset || hdr->magic != TPLG_CACHE_MAGIC ||
+	    hdr->version != TPLG_CACHE_VERSION ||
+	    hdr->abi != SOF_ABI_VER(SOF_ABI_MAJOR, SOF_ABI_MINOR) ||
+	    hdr->size != size)
+		return -EINVAL;
+
+	/* fileread format may come from the command line */
+	if (hdr->frame_fmt != find_format(bits_in))
+		return -EINVAL;
+
+	/* topology changed since the image was made */
+	if (tplg_file && (stat(tplg_file, &st) < 0 ||
+			  hdr->tplg_size != st.st_size ||
+			  hdr->tplg_mtime != st.st_mtime))
+		return -EINVAL;
+
+	for (i = 0; i < hdr->count; i++) {
+		if (offset + sizeof(*r) > size)
+			return -EINVAL;
+
+		r = (struct tplg_cache_rec *)((uint8_t *)hdr + offset);
+		offset += sizeof(*r);
+
+		/* check size before aligning it, the alignment may wrap */
+		if (r->size > size - offset)
+			return -EINVAL;
+
+		offset += TPLG_CACHE_ALIGN((size_t)r->size);
+		if (offset > size || cache_rec_validate(r) < 0)
+			return -EINVAL;
+	}
+
+	return offset == size ? 0 : -EINVAL;
+}
+
+struct tplg_cache *tplg_cache_open(const char *filename, const char *tplg_file,
+				   const char *bits_in)
+{
+	struct tplg_cache *cache;
+	struct stat st;
+	void *image;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st) < 0 || st.st_size == 0) {
+		close(fd);
+		return NULL;
+	}
+
+	/* private mapping, IPC functions may write to the objects */
+	image = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+		     fd, 0);
+	close(fd);
+	if (image == MAP_FAILED)
+		return NULL;
+
+	if (cache_validate(image, st.st_size, tplg_file, bits_in) < 0) {
+		printf("topology cache %s is stale\n", filename);
+		munmap(image, st.st_size);
+		return NULL;
+	}
+
+	cache = malloc(sizeof(*cache));
+	if (!cache) {
+		munmap(image, st.st_size);
+		return NULL;
+	}
+
+	cache->image = image;
+	cache->size = st.st_size;
+	return cache;
+}
+
+void tplg_cache_close(struct tplg_cache *cache)
+{
+	if (!cache)
+		return;
+
+	munmap(cache->image, cache->size);
+	free(cache);
+}
+
+/* get the next record of the given type, start with *offset 0 */
+static struct tplg_cache_rec *cache_next(struct tplg_cache *cache,
+					 size_t *offset, uint32_t type)
+{
+	struct tplg_cache_rec *r;
+
+	if (!*offset)
+		*offset = TPLG_CACHE_ALIGN(sizeof(struct tplg_cache_hdr));
+
+	while (*offset < cache->size) {
+		r = (struct tplg_cache_rec *)((uint8_t *)cache->image +
+					      *offset);
+		*offset += sizeof(*r) + TPLG_CACHE_ALIGN(r->size);
+		if (!type || r->type == type)
+			return r;
+	}
+
+	return NULL;
+}
+
+int tplg_cache_trace_table(struct tplg_cache *cache)
+{
+	struct tplg_cache_trace *tc;
+	struct tplg_cache_rec *r;
+	size_t offset = 0;
+	int i = 0;
+
+	while (cache_next(cache, &offset, TPLG_CACHE_TRACE_CLASS))
+		i++;
+
+	trace_table = calloc(i + 1, sizeof(*trace_table));
+	if (!trace_table)
+		return -ENOMEM;
+
+	offset = 0;
+	i = 0;
+	while ((r = cache_next(cache, &offset, TPLG_CACHE_TRACE_CLASS))) {
+		tc = (struct tplg_cache_trace *)(r + 1);
+		trace_table[i].trace_class = tc->trace_class;
+		trace_table[i].class_name = strndup(tc->name,
+						    sizeof(tc->name));
+		i++;
+	}
+
+	num_trace_classes = i;
+	return 0;
+}
+
+/* file comps get their file name from this run's file lists */
+static int cache_file_new(struct sof *sof, struct sof_ipc_comp_file *cached,
+			  char *in_file, char *out_file, int *num_read,
+			  int *num_write)
+{
+	struct sof_ipc_comp_file file = *cached;
+	int ret;
+
+	if (file.mode == FILE_READ)
+		file.fn = tplg_file_name(in_file, (*num_read)++);
+	else
+		file.fn = tplg_file_name(out_file, (*num_write)++);
+
+	if (!file.fn) {
+		fprintf(stderr, "error: no file for comp %d\n", file.comp.id);
+		return -EINVAL;
+	}
+
+	ret = ipc_comp_new(sof->ipc, (struct sof_ipc_comp *)&file);
+	free(file.fn);
+	return ret;
+}
+
+static int cache_ctrl_data(struct sof *sof, struct sof_ipc_ctrl_data *cdata)
+{
+	struct ipc_comp_dev *icd;
+
+	icd = ipc_get_comp(sof->ipc, cdata->comp_id);
+	if (!icd || icd->type != COMP_TYPE_COMPONENT)
+		return -EINVAL;
+
+	return comp_cmd(icd->cd, COMP_CMD_SET_DATA, cdata);
+}
+
+int tplg_cache_load(struct tplg_cache *cache, struct sof *sof, int *fr_id,
+		    int *fw_id, int *sched_id, char *in_file, char *out_file,
+		    char *pipeline)
+{
+	struct tplg_cache_hdr *hdr = cache->image;
+	struct sof_ipc_comp *comp;
+	struct tplg_cache_rec *r;
+	int num_read = 0, num_write = 0;
+	size_t offset = 0;
+	void *data;
+	int ret = 0;
+
+	debug_print("topology cache load start\n");
+
+	while ((r = cache_next(cache, &offset, 0))) {
+		data = r + 1;
+
+		switch (r->type) {
+		case TPLG_CACHE_COMP:
+			comp = data;
+			if (comp->type == SOF_COMP_FILEREAD)
+				ret = cache_file_new(sof, data, in_file,
+						     out_file, &num_read,
+						     &num_write);
+			else
+				ret = ipc_comp_new(sof->ipc, comp);
+			break;
+		case TPLG_CACHE_BUFFER:
+			ret = ipc_buffer_new(sof->ipc, data);
+			break;
+		case TPLG_CACHE_PIPELINE:
+			ret = ipc_pipeline_new(sof->ipc, data);
+			break;
+		case TPLG_CACHE_CONNECT:
+			ret = ipc_comp_connect(sof->ipc, data);
+			break;
+		case TPLG_CACHE_COMPLETE:
+			ret = ipc_pipeline_complete(sof->ipc,
+						    *(uint32_t *)data);
+			break;
+		case TPLG_CACHE_CTRL_DATA:
+			ret = cache_ctrl_data(sof, data);
+			break;
+		default:
+			break;
+		}
+
+		if (ret < 0) {
+			fprintf(stderr, "error: topology cache record type %d\n",
+				r->type);
+			return ret;
+		}
+	}
+
+	*fr_id = hdr->fr_id;
+	*fw_id = hdr->fw_id;
+	*sched_id = hdr->sched_id;
+	strcpy(pipeline, hdr->pipeline);
+
+	debug_print("topology cache load end\n");
+	return 0;
+}
@@ -62,4 +62,8 @@ int tb_pipeline_params(struct ipc *ipc, int nch, char *bits_in,
 
 void debug_print(char *message);
 
+void tb_heap_emulate(void);
+
+void tb_heap_report(void);
+
 #endif
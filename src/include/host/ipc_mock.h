@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _HOST_IPC_MOCK_H
+#define _HOST_IPC_MOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sof/ipc.h>
+
+/*
+ * Mock IPC transport for the host build. Messages are written to the host
+ * mailbox and processed by the firmware IPC handler, the reply is read back
+ * from the mailbox. Host buffers read by the DSP with DMA are taken in order
+ * from the data set with tb_ipc_set_dma_data().
+ */
+
+/* counters of the mock transport */
+struct tb_ipc_stats {
+	uint32_t notifications;		/* DSP initiated messages */
+	uint32_t last_notification;	/* header of last DSP message */
+	uint32_t dma_bytes;		/* bytes read from host buffers */
+};
+
+extern struct tb_ipc_stats tb_ipc_stats;
+
+/* send one message to the DSP and copy up to reply_bytes of the reply */
+int tb_ipc_msg(struct ipc *ipc, const void *msg, void *reply,
+	       size_t reply_bytes);
+
+/* set the data read by the DSP from host buffers */
+void tb_ipc_set_dma_data(const void *data, size_t bytes);
+
+#endif
@@ -50,6 +50,7 @@
 #define SOF_TKN_SCHED_CORE                      203
 #define SOF_TKN_SCHED_FRAMES                    204
 #define SOF_TKN_SCHED_TIMER                     205
+#define SOF_TKN_SCHED_PERIODS                   206
 
 /* volume */
 #define SOF_TKN_VOLUME_RAMP_STEP_TYPE           250
@@ -65,6 +66,12 @@
 #define SOF_TKN_COMP_FORMAT                     402
 #define SOF_TKN_COMP_PRELOAD_COUNT              403
 
+/* Tone */
+#define SOF_TKN_TONE_SAMPLE_RATE                800
+
+/* Processing components */
+#define SOF_TKN_EFFECT_TYPE                     900
+
 struct comp_info {
 	char *name;
 	int id;
@@ -107,6 +114,9 @@ int get_token_uint32_t(void *elem, void *object, uint32_t offset,
 int get_token_comp_format(void *elem, void *object, uint32_t offset,
 			  uint32_t size);
 
+int get_token_effect_type(void *elem, void *object, uint32_t offset,
+			  uint32_t size);
+
 /* Buffers */
 static const struct sof_topology_token buffer_tokens[] = {
 	{SOF_TKN_BUF_SIZE, SND_SOC_TPLG_TUPLE_TYPE_WORD, get_token_uint32_t,
@@ -135,6 +145,9 @@ static const struct sof_topology_token sched_tokens[] = {
 	{SOF_TKN_SCHED_TIMER, SND_SOC_TPLG_TUPLE_TYPE_WORD,
 		get_token_uint32_t,
 		offsetof(struct sof_ipc_pipe_new, timer), 0},
+	{SOF_TKN_SCHED_PERIODS, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_pipe_new, periods_per_sched), 0},
 };
 
 /* volume */
@@ -159,6 +172,15 @@ static const struct sof_topology_token src_tokens[] = {
 
 /* Tone */
 static const struct sof_topology_token tone_tokens[] = {
+	{SOF_TKN_TONE_SAMPLE_RATE, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_comp_tone, sample_rate), 0},
+};
+
+/* EQ, the effect type selects the FIR or IIR comp driver */
+static const struct sof_topology_token effect_tokens[] = {
+	{SOF_TKN_EFFECT_TYPE, SND_SOC_TPLG_TUPLE_TYPE_STRING,
+		get_token_effect_type, 0, 0},
 };
 
 /* Generic components */
@@ -196,7 +218,12 @@ void sof_parse_word_tokens(void *object,
 
 int parse_topology(char *filename, struct sof *sof, int *fr_id, int *fw_id,
 		   int *sched_id, char *bits_in,
-		   char *in_file, char *out_file, void *volume_library,
-		   char *pipeline);
+		   char *in_file, char *out_file, char *pipeline);
+
+char *tplg_file_name(const char *files, int n);
+int tplg_set_comp_lib(const char *name, const char *lib);
+int tplg_set_comp_libs(char *libs);
+int tplg_register_comps(void);
+void tplg_free_comps(void);
 
 #endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _HOST_TPLG_CACHE_H
+#define _HOST_TPLG_CACHE_H
+
+#include <stdint.h>
+#include <sof/sof.h>
+#include "host/common_test.h"
+
+/*
+ * Topology cache - a binary image of the IPC objects created while parsing
+ * a topology, in creation order. The image is mmap-ed by later runs and the
+ * objects are passed straight to the IPC functions, skipping the topology
+ * and trace header parsing. File names are not cached, they are taken from
+ * the input and output file lists of each run.
+ */
+
+#define TPLG_CACHE_MAGIC	0x43475054	/* "TPGC" */
+#define TPLG_CACHE_VERSION	1
+
+/* all records are aligned to 8 bytes for the pointers in file comps */
+#define TPLG_CACHE_ALIGN(x)	(((x) + 7) & ~7)
+
+/* record types */
+#define TPLG_CACHE_COMP		1	/* struct sof_ipc_comp + comp data */
+#define TPLG_CACHE_BUFFER	2	/* struct sof_ipc_buffer */
+#define TPLG_CACHE_PIPELINE	3	/* struct sof_ipc_pipe_new */
+#define TPLG_CACHE_CONNECT	4	/* struct sof_ipc_pipe_comp_connect */
+#define TPLG_CACHE_COMPLETE	5	/* uint32_t pipeline comp id */
+#define TPLG_CACHE_CTRL_DATA	6	/* struct sof_ipc_ctrl_data + data */
+#define TPLG_CACHE_TRACE_CLASS	7	/* struct tplg_cache_trace */
+
+struct tplg_cache_hdr {
+	uint32_t magic;
+	uint32_t version;		/* TPLG_CACHE_VERSION */
+	uint32_t abi;			/* SOF_ABI_VER() of the IPC objects */
+	uint32_t size;			/* image size including this header */
+	uint32_t count;			/* number of records */
+	uint32_t frame_fmt;		/* fileread format the image was made for */
+	uint64_t tplg_size;		/* topology file the image was made from */
+	uint64_t tplg_mtime;
+	int32_t fr_id;
+	int32_t fw_id;
+	int32_t sched_id;
+	char pipeline[DEBUG_MSG_LEN];	/* pipeline description */
+};
+
+struct tplg_cache_rec {
+	uint32_t type;
+	uint32_t size;			/* payload size without padding */
+};
+
+struct tplg_cache_trace {
+	uint32_t trace_class;
+	char name[20];
+};
+
+struct tplg_cache;
+
+/* record IPC objects created by parse_topology() */
+void tplg_cache_record_start(void);
+void tplg_cache_record(uint32_t type, const void *data, uint32_t size);
+int tplg_cache_write(const char *filename, const char *tplg_file,
+		     const char *bits_in, int fr_id, int fw_id, int sched_id,
+		     const char *pipeline);
+
+/*
+ * Map a cache image, NULL if it does not exist or does not match. The
+ * topology file is checked only when given.
+ */
+struct tplg_cache *tplg_cache_open(const char *filename, const char *tplg_file,
+				   const char *bits_in);
+void tplg_cache_close(struct tplg_cache *cache);
+
+/* set up the trace class table from the image */
+int tplg_cache_trace_table(struct tplg_cache *cache);
+
+/* create the cached IPC objects */
+int tplg_cache_load(struct tplg_cache *cache, struct sof *sof, int *fr_id,
+		    int *fw_id, int *sched_id, char *in_file, char *out_file,
+		    char *pipeline);
+
+#endif
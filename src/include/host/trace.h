@@ -39,6 +39,7 @@ struct trace_class_table {
 };
 
 struct trace_class_table *trace_table;
+extern int num_trace_classes;
 
 void tb_enable_trace(bool enable);
 
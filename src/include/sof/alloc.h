@@ -34,10 +34,13 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <errno.h>
 #include <sof/dma.h>
 #include <platform/memory.h>
+#include <arch/cache.h>
 
 struct sof;
+struct sof_ipc_mem_stats;
 
 /* Heap Memory Zones
  *
@@ -56,10 +59,19 @@ struct sof;
 #define RZONE_SYS		0
 #define RZONE_RUNTIME	1
 #define RZONE_BUFFER	2
+#define RZONE_COUNT	3
 
 struct mm_info {
 	uint32_t used;
 	uint32_t free;
+	uint32_t peak;		/* high water mark of used */
+	uint32_t failures;	/* failed allocations */
+};
+
+/* allocation requests per zone */
+struct mm_zone_info {
+	uint32_t allocs;
+	uint32_t failures;
 };
 
 struct block_hdr {
@@ -72,12 +84,19 @@ struct block_map {
 	uint16_t count;		/* number of blocks in map */
 	uint16_t free_count;	/* number of free blocks */
 	uint16_t first_free;	/* index of first free block */
+	uint16_t peak_used;	/* high water mark of used blocks */
+	uint16_t failures;	/* failed requests of this size class */
 	struct block_hdr *block;	/* base block header */
+	uint32_t *bitmap;	/* free block bitmap, bit set if block is free */
 	uint32_t base;		/* base address of space */
 } __attribute__ ((packed));
 
-#define BLOCK_DEF(sz, cnt, hdr) \
-	{.block_size = sz, .count = cnt, .free_count = cnt, .block = hdr}
+/* number of 32 bit bitmap words needed to track cnt blocks */
+#define BLOCK_MAP_WORDS(cnt)	(((cnt) + 31) >> 5)
+
+#define BLOCK_DEF(sz, cnt, hdr, bmp) \
+	{.block_size = sz, .count = cnt, .free_count = cnt, .block = hdr, \
+	.bitmap = bmp}
 
 struct mm_heap {
 	uint32_t blocks;
@@ -98,6 +117,7 @@ struct mm {
 	struct mm_heap buffer[PLATFORM_HEAP_BUFFER];
 
 	struct mm_info total;
+	struct mm_zone_info zone[RZONE_COUNT];
 	spinlock_t lock;	/* all allocs and frees are atomic */
 };
 
@@ -107,8 +127,88 @@ void *rzalloc(int zone, uint32_t caps, size_t bytes);
 void rfree(void *ptr);
 
 /* heap allocation and free for buffers on 1k boundary */
+/* Buffer data starts on a data cache line and owns whole cache lines, so
+ * cache maintenance on a buffer never touches neighbouring data.
+ */
 void *rballoc(int zone, uint32_t flags, size_t bytes);
 
+/* allocate buffer data in SRAM banks not used by avoid, if there is space */
+void *rballoc_bank(int zone, uint32_t flags, size_t bytes, void *avoid,
+	size_t avoid_bytes);
+
+/* SRAM banks can be accessed concurrently, e.g. by DMA and the core */
+#ifdef SRAM_BANK_SIZE
+#define SRAM_BANK(addr)	((uint32_t)(addr) / SRAM_BANK_SIZE)
+
+static inline int sram_bank_overlap(void *a, size_t a_bytes,
+	void *b, size_t b_bytes)
+{
+	return SRAM_BANK(a) <= SRAM_BANK(b + b_bytes - 1) &&
+		SRAM_BANK(b) <= SRAM_BANK(a + a_bytes - 1);
+}
+#else
+static inline int sram_bank_overlap(void *a, size_t a_bytes,
+	void *b, size_t b_bytes)
+{
+	return 0;
+}
+#endif
+
+/* Arena - a single continuous buffer heap allocation that is carved up by a
+ * bump allocator. Space is reserved first, then allocated once and all users
+ * are released together with arena_free().
+ */
+#define ARENA_ALIGN	DCACHE_LINE_SIZE
+
+struct mm_arena {
+	void *base;		/* start of allocation, NULL if not allocated */
+	uint32_t size;		/* reserved size in bytes */
+	uint32_t used;		/* bytes handed out */
+	uint32_t caps;		/* capabilities required by all users */
+};
+
+static inline void arena_reserve(struct mm_arena *arena, uint32_t caps,
+	size_t bytes)
+{
+	arena->size += (bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+	arena->caps |= caps;
+}
+
+static inline int arena_init(struct mm_arena *arena)
+{
+	arena->used = 0;
+	arena->base = rballoc(RZONE_BUFFER, arena->caps, arena->size);
+
+	return arena->base ? 0 : -ENOMEM;
+}
+
+static inline void *arena_alloc(struct mm_arena *arena, size_t bytes)
+{
+	void *ptr = arena->base + arena->used;
+
+	bytes = (bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+	if (arena->base == NULL || arena->used + bytes > arena->size)
+		return NULL;
+
+	arena->used += bytes;
+	return ptr;
+}
+
+static inline int arena_contains(struct mm_arena *arena, void *ptr)
+{
+	return arena->base && ptr >= arena->base &&
+		ptr < arena->base + arena->size;
+}
+
+static inline void arena_free(struct mm_arena *arena)
+{
+	rfree(arena->base);
+	arena->base = NULL;
+	arena->size = 0;
+	arena->used = 0;
+	arena->caps = 0;
+}
+
 /* utility */
 void bzero(void *s, size_t n);
 void *memset(void *s, int c, size_t n);
@@ -116,10 +216,26 @@ int rstrlen(const char *s);
 int rstrcmp(const char *s1, const char *s2);
 
 /* Heap save/restore contents and context for PM D0/D3 events */
+#define PM_CTX_MAGIC		0x58544350	/* "PCTX" */
+#define PM_CTX_ZERO_BLOCKS	(1 << 0)	/* don't save all zero blocks */
+
+/* PM context image header, followed by the block map descriptors and data */
+struct mm_pm_ctx_hdr {
+	uint32_t magic;
+	uint32_t flags;		/* PM_CTX_ flags used for save */
+	uint32_t size;		/* image size in bytes including header */
+	uint32_t reserved;
+};
+
 uint32_t mm_pm_context_size(void);
-int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg);
+int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg,
+	uint32_t flags);
 int mm_pm_context_restore(struct dma_copy *dc, struct dma_sg_config *sg);
 
+/* heap usage and fragmentation statistics */
+int mm_heap_stats(uint32_t zone, uint32_t index,
+	struct sof_ipc_mem_stats *stats);
+
 /* heap initialisation */
 void init_heap(struct sof *sof);
 #endif
@@ -41,6 +41,7 @@
 #include <sof/trace.h>
 #include <sof/schedule.h>
 #include <uapi/ipc.h>
+#include <arch/cache.h>
 
 /* pipeline tracing */
 #define trace_buffer(__e)	trace_event(TRACE_CLASS_BUFFER, __e)
@@ -50,7 +51,9 @@
 /* audio component buffer - connects 2 audio components together in pipeline */
 struct comp_buffer {
 
-	/* runtime data */
+	/* runtime data, in its own data cache lines as it's shared between
+	 * cores for pipeline stage buffers, see BUFFER_SHARED_SIZE
+	 */
 	uint32_t connected;	/* connected in path */
 	uint32_t size;		/* runtime buffer size in bytes (period multiple) */
 	uint32_t alloc_size;	/* allocated size in bytes */
@@ -60,9 +63,16 @@ struct comp_buffer {
 	void *r_ptr;		/* buffer read position */
 	void *addr;		/* buffer base address */
 	void *end_addr;		/* buffer end address */
+	uint32_t shared;	/* SPSC ring between stages on different cores */
+	uint32_t arena;		/* data is allocated from pipeline arena */
 
-	/* IPC configuration */
-	struct sof_ipc_buffer ipc_buffer;
+	/* deferred cache maintenance for DMA connected buffers */
+	void *cache_ptr;	/* start of dirty or stale data */
+	uint32_t cache_pending;	/* dirty or stale bytes from cache_ptr */
+
+	/* IPC configuration, starts on a new cache line */
+	struct sof_ipc_buffer ipc_buffer
+		__attribute__((aligned(DCACHE_LINE_SIZE)));
 
 	/* connected components */
 	struct comp_dev *source;	/* source component */
@@ -75,16 +85,40 @@ struct comp_buffer {
 	spinlock_t lock;
 };
 
+/* buffer data is allocated in whole data cache lines */
+#define buffer_data_size(size) \
+	(((size) + DCACHE_LINE_SIZE - 1) & ~(DCACHE_LINE_SIZE - 1))
+
+/* runtime pointers shared between cores for pipeline stage buffers, whole
+ * cache lines as shared buffers are allocated cache line aligned
+ */
+#define BUFFER_SHARED_SIZE	offsetof(struct comp_buffer, ipc_buffer)
+
 /* pipeline buffer creation and destruction */
 struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc);
 void buffer_free(struct comp_buffer *buffer);
 
+/* move buffer to a cache line aligned header for sharing between cores */
+struct comp_buffer *buffer_share(struct comp_buffer *buffer);
+
+/* place buffer data in other SRAM banks than the other buffer */
+int buffer_place_bank(struct comp_buffer *buffer, struct comp_buffer *other);
+
+/* produce silence into buffer */
+void buffer_produce_silence(struct comp_buffer *buffer, uint32_t bytes);
+
+/* get latest pointers and data of buffer shared with another core */
+void buffer_stage_sync(struct comp_buffer *buffer, int consumer);
+
 /* called by a component after producing data into this buffer */
 void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes);
 
 /* called by a component after consuming data from this buffer */
 void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes);
 
+/* do pending cache maintenance before the consumer copy, returns op count */
+uint32_t buffer_cache_sync(struct comp_buffer *buffer);
+
 /* get the max number of bytes that can be copied between sink and source */
 static inline int comp_buffer_can_copy_bytes(struct comp_buffer *source,
 	struct comp_buffer *sink, uint32_t bytes)
@@ -121,8 +155,17 @@ static inline void buffer_reset_pos(struct comp_buffer *buffer)
 	/* ther are no avail samples at reset */
 	buffer->avail = 0;
 
+	/* nothing left for cache maintenance */
+	buffer->cache_pending = 0;
+
 	/* clear buffer contents */
 	bzero(buffer->addr, buffer->size);
+
+	/* publish reset pointers and data before any invalidate drops them */
+	if (buffer->shared) {
+		dcache_writeback_region(buffer->addr, buffer->size);
+		dcache_writeback_region(buffer, BUFFER_SHARED_SIZE);
+	}
 }
 
 /* set the runtime size of a buffer in bytes and improve the data cache */
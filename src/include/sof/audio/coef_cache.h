@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_AUDIO_COEF_CACHE_H__
+#define __INCLUDE_AUDIO_COEF_CACHE_H__
+
+#include <stdint.h>
+
+/*
+ * Shared coefficient blob cache.
+ *
+ * Components that load identical coefficient blobs (e.g. the same EQ
+ * response on several pipelines) share a single reference counted copy.
+ * Blobs are looked up by a content hash and size, so the cache is
+ * transparent to the host. Cached blobs must be treated as read only,
+ * coef_get_writable() returns a private copy that can be modified and
+ * then handed back with coef_update(), other users only see it once it
+ * has been handed back.
+ */
+
+/* return shared copy of data, allocating a new blob if not cached */
+void *coef_get(const void *data, uint32_t size);
+
+/* take another reference to a cached blob */
+void *coef_ref(void *coef);
+
+/* drop reference to blob, freeing it when unused */
+void coef_put(void *coef);
+
+/* return a private blob that is safe to modify, cloning it if shared */
+void *coef_get_writable(void *coef);
+
+/* publish a modified blob, merging it with any identical cached blob */
+void *coef_update(void *coef);
+
+void sys_coef_init(void);
+
+#endif
@@ -199,6 +199,12 @@ struct comp_dev {
 	struct sof_ipc_comp comp;
 };
 
+/* processing state such as filter delay lines, only held while prepared */
+struct comp_delay {
+	void *data;		/* zeroed delay line memory, NULL if none */
+	uint32_t size;		/* size in bytes */
+};
+
 #define COMP_SIZE(x) \
 	(sizeof(struct comp_dev) - sizeof(struct sof_ipc_comp) + sizeof(x))
 #define COMP_GET_IPC(dev, type) \
@@ -229,6 +235,11 @@ static inline void comp_free(struct comp_dev *dev)
 /* component state set */
 int comp_set_state(struct comp_dev *dev, int cmd);
 
+/* delay line allocation, total held by all components is traced */
+int comp_delay_alloc(struct comp_delay *delay, uint32_t bytes);
+int comp_delay_resize(struct comp_delay *delay, uint32_t bytes);
+void comp_delay_free(struct comp_delay *delay);
+
 /* component parameter init - mandatory */
 static inline int comp_params(struct comp_dev *dev)
 {
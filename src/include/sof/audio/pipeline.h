@@ -50,6 +50,25 @@
 struct ipc_pipeline_dev;
 struct ipc;
 
+/*
+ * XRUN recovery statistics, reported to the host in the stream status.
+ */
+struct pipeline_xrun_stats {
+	uint32_t fast_count;		/* buffer re-align recoveries */
+	uint32_t full_count;		/* trigger and prepare recoveries */
+	uint64_t total_ticks;		/* total recovery time */
+	uint64_t max_ticks;		/* longest recovery time */
+};
+
+/*
+ * Buffer data cache maintenance statistics.
+ */
+struct pipeline_cache_stats {
+	uint32_t ops;			/* ops in the current period */
+	uint32_t period_ops;		/* ops in the last period */
+	uint32_t max_ops;		/* most ops in any period */
+};
+
 /*
  * Audio pipeline.
  */
@@ -59,6 +78,9 @@ struct pipeline {
 
 	/* runtime status */
 	int32_t xrun_bytes;		/* last xrun length */
+	struct comp_dev *xrun_comp;	/* component that reported last xrun */
+	struct pipeline_xrun_stats xrun_stats;
+	struct pipeline_cache_stats cache_stats;
 	uint32_t status;		/* pipeline status */
 
 	/* lists */
@@ -69,9 +91,16 @@ struct pipeline {
 	struct task pipe_task;		/* pipeline processing task */
 	struct comp_dev *sched_comp;	/* component that drives scheduling in this pipe */
 	struct comp_dev *source_comp;	/* source component for this pipe */
+	uint32_t batch_periods;		/* periods copied per wakeup */
+	uint32_t shared_buffers;	/* buffers to stages on other cores */
+
+	/* memory */
+	struct mm_arena arena;		/* buffer data for the whole pipeline */
 
 	/* position update */
 	uint32_t posn_offset;		/* position update array offset*/
+	uint32_t status_offset;		/* stream status offset, 0 if none */
+	struct sof_ipc_stream_status stream_status;	/* published status */
 };
 
 /* static pipeline */
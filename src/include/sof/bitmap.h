@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_BITMAP__
+#define __INCLUDE_BITMAP__
+
+#include <stdint.h>
+
+/*
+ * Bitmaps of 32 bit words, bit n of the map is bit (n & 31) of word (n >> 5).
+ * Bits past the map count in the last word must be kept clear.
+ */
+
+/* number of 32 bit words needed for a bitmap of count bits */
+#define BITMAP_WORDS(count)	(((count) + 31) >> 5)
+
+/* find first set bit at or after start, returns count if none */
+static inline unsigned int bitmap_next_set(const uint32_t *bitmap,
+	unsigned int count, unsigned int start)
+{
+	unsigned int word = start >> 5;
+	unsigned int words = BITMAP_WORDS(count);
+	uint32_t bits;
+
+	if (start >= count)
+		return count;
+
+	/* skip whole words with no set bits */
+	bits = bitmap[word] & (0xffffffffU << (start & 31));
+	while (bits == 0) {
+		if (++word >= words)
+			return count;
+		bits = bitmap[word];
+	}
+
+	return (word << 5) + __builtin_ctz(bits);
+}
+
+/* find first clear bit at or after start, returns count if none */
+static inline unsigned int bitmap_next_clear(const uint32_t *bitmap,
+	unsigned int count, unsigned int start)
+{
+	unsigned int word = start >> 5;
+	unsigned int words = BITMAP_WORDS(count);
+	unsigned int bit;
+	uint32_t bits;
+
+	if (start >= count)
+		return count;
+
+	/* skip whole words with no clear bits */
+	bits = ~bitmap[word] & (0xffffffffU << (start & 31));
+	while (bits == 0) {
+		if (++word >= words)
+			return count;
+		bits = ~bitmap[word];
+	}
+
+	/* bits past count are clear too */
+	bit = (word << 5) + __builtin_ctz(bits);
+	return bit < count ? bit : count;
+}
+
+/* set or clear count bits from start */
+static inline void bitmap_update(uint32_t *bitmap, unsigned int start,
+	unsigned int count, int set)
+{
+	uint32_t *word = &bitmap[start >> 5];
+	unsigned int bit = start & 31;
+	unsigned int bits;
+	uint32_t mask;
+
+	while (count) {
+		bits = 32 - bit < count ? 32 - bit : count;
+		mask = bits == 32 ? 0xffffffffU : ((1U << bits) - 1) << bit;
+
+		if (set)
+			*word |= mask;
+		else
+			*word &= ~mask;
+
+		count -= bits;
+		bit = 0;
+		word++;
+	}
+}
+
+#endif
@@ -51,6 +51,20 @@ struct dai_config;
 
 #define MSG_QUEUE_SIZE		12
 
+/*
+ * Coalescing slots for outbound messages. A newer message replaces the
+ * pending one in its slot instead of using another queue entry. XRUN
+ * messages are sent before any other queued message.
+ */
+#define IPC_SLOT_NONE		-1
+#define IPC_SLOT_XRUN(stream)	(stream)
+#define IPC_SLOT_POSN(stream)	(PLATFORM_MAX_STREAMS + (stream))
+#define IPC_SLOT_TRACE		(2 * PLATFORM_MAX_STREAMS)
+#define IPC_SLOTS		(IPC_SLOT_TRACE + 1)
+
+#define IPC_SLOT_URGENT(slot) \
+	((slot) >= 0 && (slot) < PLATFORM_MAX_STREAMS)
+
 #define COMP_TYPE_COMPONENT	1
 #define COMP_TYPE_BUFFER	2
 #define COMP_TYPE_PIPELINE	3
@@ -80,6 +94,7 @@ struct ipc_msg {
 	struct list_item list;
 	void (*cb)(void *cb_data, void *mailbox_data);
 	void *cb_data;
+	int slot;		/* IPC_SLOT_ while queued */
 };
 
 struct ipc {
@@ -89,11 +104,19 @@ struct ipc {
 	uint32_t host_pending;
 	uint32_t dsp_pending;
 	struct list_item msg_list;
+	struct list_item urgent_list;	/* sent before msg_list */
 	struct list_item empty_list;
 	spinlock_t lock;
 	struct ipc_msg message[MSG_QUEUE_SIZE];
+	struct ipc_msg *slot[IPC_SLOTS];	/* queued coalescing messages */
+	uint32_t msg_coalesced;		/* messages replaced in their slot */
+	uint32_t msg_overflow;		/* messages dropped, queue full */
 	void *comp_data;
 
+	/* binary control data from a host buffer, applied by ctrl_work */
+	struct sof_ipc_ctrl_data *ctrl_data;
+	struct work ctrl_work;
+
 	/* RX call back */
 	int (*cb)(struct ipc_msg *msg);
 
@@ -126,9 +149,19 @@ int ipc_stream_send_position(struct comp_dev *cdev,
 int ipc_stream_send_xrun(struct comp_dev *cdev,
 	struct sof_ipc_stream_posn *posn);
 
+/* stream status in the stream region, polled by the host */
+void ipc_stream_status_reset(struct pipeline *p, uint32_t comp_id);
+void ipc_stream_status_host(struct comp_dev *cdev, uint64_t host_posn);
+void ipc_stream_status_dai(struct comp_dev *cdev, uint64_t dai_posn);
+void ipc_stream_status_xrun(struct comp_dev *cdev, int32_t bytes);
+void ipc_stream_status_recover(struct pipeline *p);
+void ipc_stream_status_volume(struct comp_dev *cdev, uint32_t *volume,
+	int channels);
+
 int ipc_queue_host_message(struct ipc *ipc, uint32_t header,
 	void *tx_data, size_t tx_bytes, void *rx_data,
-	size_t rx_bytes, void (*cb)(void*, void*), void *cb_data, uint32_t replace);
+	size_t rx_bytes, void (*cb)(void*, void*), void *cb_data, int slot);
+struct ipc_msg *ipc_msg_next(struct ipc *ipc);
 int ipc_send_short_msg(uint32_t msg);
 
 void ipc_platform_do_cmd(struct ipc *ipc);
@@ -182,4 +215,25 @@ int ipc_dma_trace_send_position(void);
 
 /* get posn offset by pipeline. */
 int ipc_get_posn_offset(struct ipc *ipc, struct pipeline *pipe);
+
+/*
+ * Get the compound message at offset in data of size bytes, NULL if the
+ * remaining data can't hold a complete message header and its payload.
+ */
+static inline struct sof_ipc_hdr *ipc_compound_msg(uint8_t *data,
+	uint32_t size, uint32_t offset)
+{
+	struct sof_ipc_hdr *hdr;
+
+	/* check header fits before reading it */
+	if (offset > size || size - offset < sizeof(*hdr))
+		return NULL;
+
+	hdr = (struct sof_ipc_hdr *)(data + offset);
+	if (hdr->size < sizeof(*hdr) || hdr->size > size - offset ||
+	    hdr->size > SOF_IPC_MSG_MAX_SIZE)
+		return NULL;
+
+	return hdr;
+}
 #endif
@@ -82,6 +82,10 @@ void schedule_task_idle(struct task *task, uint64_t deadline);
 
 void schedule_task_complete(struct task *task);
 
+int schedule_task_depend(struct task *consumer, struct task *producer);
+
+void schedule_task_depend_free(struct task *task);
+
 static inline void schedule_task_init(struct task *task, void (*func)(void *),
 	void *data)
 {
@@ -37,8 +37,18 @@
 #ifndef __INCLUDE_UAPI_ABI_H__
 #define __INCLUDE_UAPI_ABI_H__
 
-/** \brief SOF ABI version number. */
-#define SOF_ABI_VERSION		1
+/** \brief SOF ABI major version, binary data and IPC must match. */
+#define SOF_ABI_MAJOR		1
+
+/** \brief SOF ABI minor version, bumped for each backwards compatible
+ * change to the IPC structures (e.g. appended fields). */
+#define SOF_ABI_MINOR		4
+
+/** \brief SOF ABI major and minor version in a single word. */
+#define SOF_ABI_VER(major, minor)	(((major) << 16) | (minor))
+
+/** \brief SOF ABI version number of binary data, see struct sof_abi_hdr. */
+#define SOF_ABI_VERSION		SOF_ABI_MAJOR
 
 /** \brief SOF ABI magic number "SOF\0". */
 #define SOF_ABI_MAGIC		0x00464F53
@@ -124,6 +124,7 @@
 /* trace and debug */
 #define SOF_IPC_TRACE_DMA_PARAMS		SOF_CMD_TYPE(0x001)
 #define SOF_IPC_TRACE_DMA_POSITION		SOF_CMD_TYPE(0x002)
+#define SOF_IPC_TRACE_MEM_STATS			SOF_CMD_TYPE(0x003)
 
 /* Get message component id */
 #define SOF_IPC_MESSAGE_ID(x)			(x & 0xffff)
@@ -181,20 +182,6 @@ struct sof_ipc_reply {
 	int32_t error;			/* negative error numbers */
 }  __attribute__((packed));
 
-/*
- * Compound commands - SOF_IPC_GLB_COMPOUND.
- *
- * Compound commands are sent to the DSP as a single IPC operation. The
- * commands are split into blocks and each block has a header. This header
- * identifies the command type and the number of commands before the next
- * header.
- */
-
-struct sof_ipc_compound_hdr {
-	struct sof_ipc_hdr hdr;
-	uint32_t count;		/* count of 0 means end of compound sequence */
-}  __attribute__((packed));
-
 /*
  * DAI Configuration.
  *
@@ -452,6 +439,38 @@ struct sof_ipc_host_buffer {
 	uint32_t offset;
 } __attribute__((packed));
 
+/*
+ * Compound commands - SOF_IPC_GLB_COMPOUND.
+ *
+ * Compound commands are sent to the DSP as a single IPC operation. The
+ * header is followed by count complete IPC messages, each starting with its
+ * own struct sof_ipc_hdr and padded to a multiple of 4 bytes. The messages
+ * follow the header in the mailbox, or for large sequences are read by the
+ * DSP from a host buffer using DMA. Only topology messages can be sent in a
+ * compound. The messages are processed in order until the first error and
+ * the DSP sends a single struct sof_ipc_compound_reply.
+ */
+
+/* compound flags */
+#define SOF_IPC_COMPOUND_DMA		(1 << 0) /* messages in host buffer */
+
+/* max size of the messages in a compound host buffer */
+#define SOF_IPC_COMPOUND_MAX_SIZE	0x4000
+
+struct sof_ipc_compound_hdr {
+	struct sof_ipc_hdr hdr;
+	uint32_t count;			/* number of messages */
+	uint32_t flags;			/* SOF_IPC_COMPOUND_ */
+	uint32_t stream_tag;		/* host DMA stream, DMA gateway only */
+	struct sof_ipc_host_buffer buffer;	/* host buffer, DMA only */
+}  __attribute__((packed));
+
+struct sof_ipc_compound_reply {
+	struct sof_ipc_reply rhdr;
+	uint32_t count;			/* messages completed */
+	uint32_t cmd;			/* cmd of failed message, or 0 */
+}  __attribute__((packed));
+
 struct sof_ipc_stream_params {
 	struct sof_ipc_host_buffer buffer;
 	enum sof_ipc_stream_direction direction;
@@ -479,6 +498,7 @@ struct sof_ipc_pcm_params_reply {
 	struct sof_ipc_reply rhdr;
 	uint32_t comp_id;
 	uint32_t posn_offset;
+	uint32_t status_offset;	/* stream status offset, 0 if not supported */
 }   __attribute__((packed));
 
 /* compressed vorbis params - SOF_IPC_STREAM_VORBIS_PARAMS */
@@ -528,6 +548,30 @@ struct sof_ipc_stream_posn {
 	int32_t xrun_size;	/* XRUN size in bytes */
 }  __attribute__((packed));
 
+/*
+ * Stream status - kept up to date by the DSP in the stream region at
+ * status_offset from the PCM params reply so the host can poll the stream
+ * without position IPCs (host_period_bytes of 0). seq is odd while the DSP
+ * is updating, the host retries the read until seq is even and the same
+ * before and after reading the other fields.
+ */
+struct sof_ipc_stream_status {
+	uint32_t seq;		/* update sequence, odd during update */
+	uint32_t comp_id;	/* host component ID */
+	uint64_t host_posn;	/* host DMA position in bytes */
+	uint64_t dai_posn;	/* DAI DMA position in bytes */
+	uint64_t wallclock;	/* audio wall clock at last update */
+	uint64_t timestamp;	/* system time stamp at last update */
+	uint32_t xrun_count;	/* XRUNs since stream params */
+	uint32_t xrun_comp_id;	/* comp ID of last XRUN component */
+	int32_t xrun_size;	/* last XRUN size in bytes */
+	uint32_t volume[SOF_IPC_MAX_CHANNELS];	/* current channel volume */
+	uint32_t xrun_fast_count;	/* XRUNs recovered by buffer re-align */
+	uint32_t xrun_full_count;	/* XRUNs recovered by pipeline restart */
+	uint64_t xrun_total_ticks;	/* total XRUN recovery time */
+	uint64_t xrun_max_ticks;	/* longest XRUN recovery time */
+}  __attribute__((packed));
+
 /*
  * Component Mixers and Controls
  */
@@ -568,6 +612,17 @@ struct sof_ipc_ctrl_value_comp {
 	};
 } __attribute__((packed));
 
+/*
+ * Binary control data (SOF_IPC_COMP_SET_DATA) larger than the mailbox is
+ * read by the DSP from a host buffer when buffer.size is not zero. The
+ * data starts with a struct sof_abi_hdr. On DMA gateway platforms
+ * buffer.phy_addr is the host DMA stream tag. The DSP replies once the
+ * data is received and validated, and applies it later to the component.
+ * The result is sent to the host with a SOF_IPC_COMP_SET_DATA message
+ * carrying a struct sof_ipc_reply.
+ */
+#define SOF_IPC_CTRL_DATA_MAX_SIZE	0x4000
+
 /* generic control data */
 struct sof_ipc_ctrl_data {
 	struct sof_ipc_reply rhdr;
@@ -769,8 +824,13 @@ struct sof_ipc_pipe_new {
 	uint32_t frames_per_sched;/* output frames of pipeline, 0 is variable */
 	uint32_t xrun_limit_usecs; /* report xruns greater than limit */
 	uint32_t timer;/* non zero if timer scheduled otherwise DAI scheduled */
+	uint32_t periods_per_sched; /* periods copied per wakeup, 0 is 1 */
 }  __attribute__((packed));
 
+/* size of pipeline new message from hosts without periods_per_sched */
+#define SOF_IPC_PIPE_NEW_SIZE_V1 \
+	(sizeof(struct sof_ipc_pipe_new) - sizeof(uint32_t))
+
 /* pipeline construction complete - SOF_IPC_TPLG_PIPE_COMPLETE */
 struct sof_ipc_pipe_ready {
 	struct sof_ipc_hdr hdr;
@@ -912,6 +972,52 @@ struct sof_ipc_dma_trace_posn {
 	uint32_t messages;	/* total trace messages */
 }  __attribute__((packed));
 
+/*
+ * Heap memory statistics
+ */
+
+/* heap zones, match the firmware RZONE_ values */
+#define SOF_IPC_MEM_ZONE_SYS		0
+#define SOF_IPC_MEM_ZONE_RUNTIME	1
+#define SOF_IPC_MEM_ZONE_BUFFER		2
+
+#define SOF_IPC_MAX_MEM_MAPS		8
+
+/* heap statistics request - SOF_IPC_TRACE_MEM_STATS */
+struct sof_ipc_mem_stats_req {
+	struct sof_ipc_hdr hdr;
+	uint32_t zone;		/* SOF_IPC_MEM_ZONE_ */
+	uint32_t index;		/* heap index within zone */
+}  __attribute__((packed));
+
+/* statistics for one block size class of a heap */
+struct sof_ipc_mem_map_stats {
+	uint32_t block_size;	/* size of block in bytes */
+	uint32_t count;		/* number of blocks in map */
+	uint32_t free_count;	/* number of free blocks */
+	uint32_t peak_used;	/* most blocks ever used at once */
+	uint32_t largest_free;	/* largest run of continuous free blocks */
+	uint32_t failures;	/* failed requests of this size class */
+}  __attribute__((packed));
+
+/* heap statistics reply - SOF_IPC_TRACE_MEM_STATS */
+struct sof_ipc_mem_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t zone;		/* SOF_IPC_MEM_ZONE_ */
+	uint32_t index;		/* heap index within zone */
+	uint32_t caps;		/* SOF_MEM_CAPS_ */
+	uint32_t size;		/* heap size in bytes */
+	uint32_t used;		/* bytes in use */
+	uint32_t free;		/* bytes free */
+	uint32_t peak;		/* most bytes ever used at once */
+	uint32_t largest_free;	/* largest continuous free bytes */
+	uint32_t failures;	/* failed allocations from this heap */
+	uint32_t zone_allocs;	/* allocations requested from zone */
+	uint32_t zone_failures;	/* failed allocations from zone */
+	uint32_t num_maps;	/* valid entries in map[] */
+	struct sof_ipc_mem_map_stats map[SOF_IPC_MAX_MEM_MAPS];
+}  __attribute__((packed));
+
 /*
  * Architecture specific debug
  */
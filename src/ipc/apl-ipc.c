@@ -152,15 +152,14 @@ void ipc_platform_send_msg(struct ipc *ipc)
 	spin_lock_irq(&ipc->lock, flags);
 
 	/* any messages to send ? */
-	if (list_is_empty(&ipc->msg_list)) {
+	msg = ipc_msg_next(ipc);
+	if (msg == NULL) {
 		ipc->dsp_pending = 0;
 		goto out;
 	}
 
 	/* now send the message */
-	msg = list_first_item(&ipc->msg_list, struct ipc_msg, list);
 	mailbox_dspbox_write(0, msg->tx_data, msg->tx_size);
-	list_item_del(&msg->list);
 	ipc->dsp_msg = msg;
 	tracev_ipc("Msg");
 
@@ -189,6 +188,7 @@ int platform_ipc_init(struct ipc *ipc)
 	_ipc->dsp_msg = NULL;
 	list_init(&ipc->empty_list);
 	list_init(&ipc->msg_list);
+	list_init(&ipc->urgent_list);
 	spinlock_init(&ipc->lock);
 	for (i = 0; i < MSG_QUEUE_SIZE; i++)
 		list_item_prepend(&ipc->message[i].list, &ipc->empty_list);
@@ -76,6 +76,13 @@ static inline struct sof_ipc_hdr *mailbox_validate(void)
 	/* read component values from the inbox */
 	mailbox_hostbox_read(hdr, 0, sizeof(*hdr));
 
+	/* compound messages are read in by the compound handler */
+	if ((hdr->cmd & SOF_GLB_TYPE_MASK) == SOF_IPC_GLB_COMPOUND) {
+		mailbox_hostbox_read(hdr + 1, sizeof(*hdr),
+			sizeof(struct sof_ipc_compound_hdr) - sizeof(*hdr));
+		return hdr;
+	}
+
 	/* validate component header */
 	if (hdr->size > SOF_IPC_MSG_MAX_SIZE) {
 		trace_ipc_error("ebg");
@@ -271,7 +278,11 @@ pipe_params:
 	reply.rhdr.error = 0;
 	reply.comp_id = pcm_params->comp_id;
 	reply.posn_offset = posn_offset;
+	reply.status_offset = pcm_dev->cd->pipeline->status_offset;
 	mailbox_hostbox_write(0, &reply, sizeof(reply));
+
+	/* start the stream status from zero */
+	ipc_stream_status_reset(pcm_dev->cd->pipeline, pcm_params->comp_id);
 	return 1;
 
 error:
@@ -361,6 +372,12 @@ static int ipc_stream_position(uint32_t header)
 	return 1;
 }
 
+/* stream index of the position slot, used for the message slots */
+static inline int ipc_stream_index(struct comp_dev *cdev)
+{
+	return cdev->pipeline->posn_offset / sizeof(struct sof_ipc_stream_posn);
+}
+
 /* send stream position */
 int ipc_stream_send_position(struct comp_dev *cdev,
 	struct sof_ipc_stream_posn *posn)
@@ -378,7 +395,8 @@ int ipc_stream_send_position(struct comp_dev *cdev,
 
 	mailbox_stream_write(cdev->pipeline->posn_offset, posn, sizeof(*posn));
 	return ipc_queue_host_message(_ipc, posn->rhdr.hdr.cmd, &hdr,
-				      sizeof(hdr), NULL, 0, NULL, NULL, 0);
+				      sizeof(hdr), NULL, 0, NULL, NULL,
+				      IPC_SLOT_POSN(ipc_stream_index(cdev)));
 }
 
 /* send stream position TODO: send compound message  */
@@ -396,7 +414,136 @@ int ipc_stream_send_xrun(struct comp_dev *cdev,
 
 	mailbox_stream_write(cdev->pipeline->posn_offset, posn, sizeof(*posn));
 	return ipc_queue_host_message(_ipc, posn->rhdr.hdr.cmd, &hdr,
-				      sizeof(hdr), NULL, 0, NULL, NULL, 0);
+				      sizeof(hdr), NULL, 0, NULL, NULL,
+				      IPC_SLOT_XRUN(ipc_stream_index(cdev)));
+}
+
+/*
+ * Stream status is written by the DMA callbacks and volume work of the
+ * pipeline core with interrupts disabled, the pipeline lock can already be
+ * held by the caller. The seq word is made odd, the status written and seq
+ * made even again so the host never uses a partial update.
+ */
+static void ipc_stream_status_write(struct pipeline *p)
+{
+	struct sof_ipc_stream_status *status = &p->stream_status;
+	uint32_t seq_size = sizeof(status->seq);
+
+	status->timestamp = platform_timer_get(platform_timer);
+
+	status->seq++;
+	mailbox_stream_write(p->status_offset, &status->seq, seq_size);
+	mailbox_stream_write(p->status_offset + seq_size,
+			     (uint8_t *)status + seq_size,
+			     sizeof(*status) - seq_size);
+	status->seq++;
+	mailbox_stream_write(p->status_offset, &status->seq, seq_size);
+}
+
+void ipc_stream_status_reset(struct pipeline *p, uint32_t comp_id)
+{
+	struct sof_ipc_stream_status *status = &p->stream_status;
+	uint32_t seq = status->seq;
+	uint32_t flags;
+
+	if (p->status_offset == 0)
+		return;
+
+	flags = interrupt_global_disable();
+
+	/* keep seq counting so the host sees the reset */
+	bzero(status, sizeof(*status));
+	bzero(&p->xrun_stats, sizeof(p->xrun_stats));
+	status->seq = seq;
+	status->comp_id = comp_id;
+	ipc_stream_status_write(p);
+
+	interrupt_global_enable(flags);
+}
+
+void ipc_stream_status_host(struct comp_dev *cdev, uint64_t host_posn)
+{
+	struct pipeline *p = cdev->pipeline;
+	uint32_t flags;
+
+	if (p->status_offset == 0)
+		return;
+
+	flags = interrupt_global_disable();
+	p->stream_status.host_posn = host_posn;
+	ipc_stream_status_write(p);
+	interrupt_global_enable(flags);
+}
+
+void ipc_stream_status_dai(struct comp_dev *cdev, uint64_t dai_posn)
+{
+	struct pipeline *p = cdev->pipeline;
+	uint64_t wallclock;
+	uint32_t flags;
+
+	if (p->status_offset == 0)
+		return;
+
+	platform_dai_wallclock(cdev, &wallclock);
+
+	flags = interrupt_global_disable();
+	p->stream_status.dai_posn = dai_posn;
+	p->stream_status.wallclock = wallclock;
+	ipc_stream_status_write(p);
+	interrupt_global_enable(flags);
+}
+
+void ipc_stream_status_xrun(struct comp_dev *cdev, int32_t bytes)
+{
+	struct pipeline *p = cdev->pipeline;
+	uint32_t flags;
+
+	if (p->status_offset == 0)
+		return;
+
+	flags = interrupt_global_disable();
+	p->stream_status.xrun_count++;
+	p->stream_status.xrun_comp_id = cdev->comp.id;
+	p->stream_status.xrun_size = bytes;
+	ipc_stream_status_write(p);
+	interrupt_global_enable(flags);
+}
+
+void ipc_stream_status_recover(struct pipeline *p)
+{
+	struct pipeline_xrun_stats *stats = &p->xrun_stats;
+	uint32_t flags;
+
+	if (p->status_offset == 0)
+		return;
+
+	flags = interrupt_global_disable();
+	p->stream_status.xrun_fast_count = stats->fast_count;
+	p->stream_status.xrun_full_count = stats->full_count;
+	p->stream_status.xrun_total_ticks = stats->total_ticks;
+	p->stream_status.xrun_max_ticks = stats->max_ticks;
+	ipc_stream_status_write(p);
+	interrupt_global_enable(flags);
+}
+
+void ipc_stream_status_volume(struct comp_dev *cdev, uint32_t *volume,
+	int channels)
+{
+	struct pipeline *p = cdev->pipeline;
+	uint32_t flags;
+	int i;
+
+	if (p->status_offset == 0)
+		return;
+
+	if (channels > SOF_IPC_MAX_CHANNELS)
+		channels = SOF_IPC_MAX_CHANNELS;
+
+	flags = interrupt_global_disable();
+	for (i = 0; i < channels; i++)
+		p->stream_status.volume[i] = volume[i];
+	ipc_stream_status_write(p);
+	interrupt_global_enable(flags);
 }
 
 static int ipc_stream_trigger(uint32_t header)
@@ -714,7 +861,39 @@ int ipc_dma_trace_send_position(void)
 	posn.rhdr.hdr.size = sizeof(posn);
 
 	return ipc_queue_host_message(_ipc, posn.rhdr.hdr.cmd, &posn,
-		sizeof(posn), NULL, 0, NULL, NULL, 1);
+		sizeof(posn), NULL, 0, NULL, NULL, IPC_SLOT_TRACE);
+}
+
+/* send heap usage and fragmentation statistics to host */
+static int ipc_mem_stats(uint32_t header)
+{
+	struct sof_ipc_mem_stats_req *req = _ipc->comp_data;
+	struct sof_ipc_mem_stats stats;
+	int ret;
+
+	trace_ipc("DMs");
+
+	/* sanity check size */
+	if (IPC_INVALID_SIZE(req)) {
+		trace_ipc_error("DMz");
+		return -EINVAL;
+	}
+
+	bzero(&stats, sizeof(stats));
+
+	ret = mm_heap_stats(req->zone, req->index, &stats);
+	if (ret < 0) {
+		trace_ipc_error("eMs");
+		trace_error_value(req->zone);
+		trace_error_value(req->index);
+		return ret;
+	}
+
+	/* write stats to the outbox */
+	stats.rhdr.hdr.cmd = header;
+	stats.rhdr.hdr.size = sizeof(stats);
+	mailbox_hostbox_write(0, &stats, sizeof(stats));
+	return 1;
 }
 
 static int ipc_glb_debug_message(uint32_t header)
@@ -726,6 +905,8 @@ static int ipc_glb_debug_message(uint32_t header)
 	switch (cmd) {
 	case iCS(SOF_IPC_TRACE_DMA_PARAMS):
 		return ipc_dma_trace_config(header);
+	case iCS(SOF_IPC_TRACE_MEM_STATS):
+		return ipc_mem_stats(header);
 	default:
 		trace_ipc_error("eDc");
 		trace_error_value(header);
@@ -733,15 +914,211 @@ static int ipc_glb_debug_message(uint32_t header)
 	}
 }
 
+/* read data the host has placed in a host buffer using DMA */
+static int ipc_host_buffer_read(struct sof_ipc_host_buffer *buffer,
+	uint32_t stream_tag, void *data, uint32_t size)
+{
+#ifdef CONFIG_HOST_PTABLE
+	struct intel_ipc_data *iipc = ipc_get_drvdata(_ipc);
+#endif
+	struct dma_sg_config host_sg;
+	struct dma_sg_elem *elem;
+	struct list_item *plist;
+	struct list_item *tlist;
+	struct dma_copy dc;
+	int err;
+
+	list_init(&host_sg.elem_list);
+
+#ifdef CONFIG_HOST_PTABLE
+	/* use DMA to read in compressed page table of the host buffer */
+	err = ipc_get_page_descriptors(iipc->dmac, iipc->page_table,
+				       buffer);
+	if (err < 0) {
+		trace_ipc_error("eHp");
+		goto out;
+	}
+
+	err = ipc_parse_page_descriptors(iipc->page_table, buffer,
+					 &host_sg.elem_list,
+					 SOF_IPC_STREAM_PLAYBACK);
+	if (err < 0) {
+		trace_ipc_error("eHP");
+		goto out;
+	}
+#else
+	/* host side of the DMA gateway is set up by the host driver */
+	elem = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*elem));
+	if (elem == NULL)
+		return -ENOMEM;
+
+	elem->size = size;
+	list_item_append(&elem->list, &host_sg.elem_list);
+#endif
+
+	err = dma_copy_new(&dc);
+	if (err < 0) {
+		trace_ipc_error("eHd");
+		goto out;
+	}
+
+#if defined CONFIG_DMA_GW
+	err = dma_copy_set_stream_tag(&dc, stream_tag);
+	if (err < 0) {
+		trace_ipc_error("eHt");
+		goto out;
+	}
+#endif
+
+	err = dma_copy_from_host(&dc, &host_sg, 0, data, size);
+	if (err < 0)
+		trace_ipc_error("eHc");
+
+	dma_copy_free(&dc);
+
+out:
+	list_for_item_safe(plist, tlist, &host_sg.elem_list) {
+		elem = container_of(plist, struct dma_sg_elem, list);
+		list_item_del(&elem->list);
+		rfree(elem);
+	}
+
+	return err < 0 ? err : 0;
+}
+
 /*
  * Topology IPC Operations.
  */
 
+/* check the ABI header of binary control data of size bytes */
+static int ipc_ctrl_data_validate(struct sof_abi_hdr *abi, uint32_t size)
+{
+	if (size < sizeof(*abi) || abi->magic != SOF_ABI_MAGIC ||
+	    abi->abi != SOF_ABI_VERSION) {
+		trace_ipc_error("eKa");
+		return -EINVAL;
+	}
+
+	if (abi->size > size - sizeof(*abi)) {
+		trace_ipc_error("eKs");
+		trace_error_value(abi->size);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* apply staged control data to the component outside of the IPC handler */
+static uint64_t ipc_ctrl_data_work(void *data, uint64_t delay)
+{
+	struct ipc *ipc = data;
+	struct sof_ipc_ctrl_data *cdata = ipc->ctrl_data;
+	struct ipc_comp_dev *comp_dev;
+	struct sof_ipc_reply reply;
+	int ret;
+
+	trace_ipc("KdA");
+
+	/* component may have been freed since the data was received */
+	comp_dev = ipc_get_comp(ipc, cdata->comp_id);
+	if (comp_dev == NULL) {
+		trace_ipc_error("eKg");
+		trace_error_value(cdata->comp_id);
+		ret = -ENODEV;
+	} else {
+		ret = comp_cmd(comp_dev->cd, COMP_CMD_SET_DATA, cdata);
+		if (ret < 0) {
+			trace_ipc_error("eKA");
+			trace_error_value(cdata->comp_id);
+		}
+	}
+
+	/* tell the host the data has been applied */
+	reply.hdr.cmd = SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_SET_DATA;
+	reply.hdr.size = sizeof(reply);
+	reply.error = ret;
+
+	ipc->ctrl_data = NULL;
+	rfree(cdata);
+
+	ipc_queue_host_message(ipc, reply.hdr.cmd, &reply, sizeof(reply),
+			       NULL, 0, NULL, NULL, IPC_SLOT_NONE);
+	return 0;
+}
+
+/* stage binary control data from the host buffer and apply it later */
+static int ipc_comp_data_dma(uint32_t header)
+{
+	struct sof_ipc_ctrl_data *data = _ipc->comp_data;
+	struct sof_ipc_ctrl_data *cdata;
+	uint32_t size = data->buffer.size;
+	uint32_t stream_tag = 0;
+	int ret;
+
+	trace_ipc("KdD");
+	tracev_value(size);
+
+	/* only one blob can be staged at a time */
+	if (_ipc->ctrl_data) {
+		trace_ipc_error("eKb");
+		return -EBUSY;
+	}
+
+	if (size > SOF_IPC_CTRL_DATA_MAX_SIZE) {
+		trace_ipc_error("eKS");
+		trace_error_value(size);
+		return -EINVAL;
+	}
+
+	if (ipc_get_comp(_ipc, data->comp_id) == NULL) {
+		trace_ipc_error("eKg");
+		trace_error_value(data->comp_id);
+		return -ENODEV;
+	}
+
+	/* control header followed by the blob, as for mailbox data */
+	cdata = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM,
+			sizeof(*cdata) + size);
+	if (cdata == NULL) {
+		trace_ipc_error("eKm");
+		return -ENOMEM;
+	}
+
+	memcpy(cdata, data, sizeof(*cdata));
+
+#if defined CONFIG_DMA_GW
+	/* the host DMA gateway is identified by its stream tag */
+	stream_tag = data->buffer.phy_addr;
+#endif
+
+	ret = ipc_host_buffer_read(&cdata->buffer, stream_tag, cdata->data,
+				   size);
+	if (ret < 0)
+		goto err;
+
+	ret = ipc_ctrl_data_validate(cdata->data, size);
+	if (ret < 0)
+		goto err;
+
+	cdata->rhdr.hdr.size = sizeof(*cdata) + size;
+
+	/* component applies the data from the work queue */
+	_ipc->ctrl_data = cdata;
+	work_init(&_ipc->ctrl_work, ipc_ctrl_data_work, _ipc, WORK_ASYNC);
+	work_schedule_default(&_ipc->ctrl_work, 0);
+	return 0;
+
+err:
+	rfree(cdata);
+	return ret;
+}
+
 /* get/set component values or runtime data */
 static int ipc_comp_value(uint32_t header, uint32_t cmd)
 {
 	struct ipc_comp_dev *comp_dev;
 	struct sof_ipc_ctrl_data *data = _ipc->comp_data;
+	uint32_t size;
 	int ret;
 
 	trace_ipc("VoG");
@@ -754,6 +1131,15 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 		return -ENODEV;
 	}
 	
+	/* binary data in the mailbox follows the control header */
+	if (cmd == COMP_CMD_SET_DATA) {
+		size = data->rhdr.hdr.size > sizeof(*data) ?
+			data->rhdr.hdr.size - sizeof(*data) : 0;
+		ret = ipc_ctrl_data_validate(data->data, size);
+		if (ret < 0)
+			return ret;
+	}
+
 	/* get component values */
 	ret = comp_cmd(comp_dev->cd, cmd, data);
 	if (ret < 0) {
@@ -768,6 +1154,7 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 
 static int ipc_glb_comp_message(uint32_t header)
 {
+	struct sof_ipc_ctrl_data *data = _ipc->comp_data;
 	uint32_t cmd = (header & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
 
 	switch (cmd) {
@@ -776,6 +1163,8 @@ static int ipc_glb_comp_message(uint32_t header)
 	case iCS(SOF_IPC_COMP_GET_VALUE):
 		return ipc_comp_value(header, COMP_CMD_GET_VALUE);
 	case iCS(SOF_IPC_COMP_SET_DATA):
+		if (data->buffer.size)
+			return ipc_comp_data_dma(header);
 		return ipc_comp_value(header, COMP_CMD_SET_DATA);
 	case iCS(SOF_IPC_COMP_GET_DATA):
 		return ipc_comp_value(header, COMP_CMD_GET_DATA);
@@ -841,8 +1230,10 @@ static int ipc_glb_tplg_pipe_new(uint32_t header)
 
 	trace_ipc("Ipn");
 
-	/* sanity check size */
-	if (IPC_INVALID_SIZE(ipc_pipeline)) {
+	/* sanity check size, older hosts don't send periods_per_sched */
+	if (ipc_pipeline->hdr.size == SOF_IPC_PIPE_NEW_SIZE_V1) {
+		ipc_pipeline->periods_per_sched = 0;
+	} else if (IPC_INVALID_SIZE(ipc_pipeline)) {
 		trace_ipc_error("Ips");
 		return -EINVAL;
 	}
@@ -933,6 +1324,128 @@ static int ipc_glb_tplg_message(uint32_t header)
 	}
 }
 
+/*
+ * Compound IPC Operations.
+ */
+
+/* process a packed sequence of topology messages with a single reply */
+static int ipc_glb_compound_message(uint32_t header)
+{
+	struct sof_ipc_compound_hdr *compound = _ipc->comp_data;
+	struct sof_ipc_compound_reply reply;
+	struct sof_ipc_hdr *hdr;
+	uint8_t *data;
+	uint32_t offset = 0;
+	uint32_t count;
+	uint32_t size;
+	uint32_t hdr_size;
+	uint32_t cmd = 0;
+	int ret = 0;
+
+	trace_ipc("Cmp");
+
+	if (compound->hdr.size < sizeof(*compound)) {
+		trace_ipc_error("eCs");
+		return -EINVAL;
+	}
+
+	if (compound->flags & SOF_IPC_COMPOUND_DMA) {
+		size = compound->buffer.size;
+		if (size > SOF_IPC_COMPOUND_MAX_SIZE) {
+			trace_ipc_error("eCS");
+			trace_error_value(size);
+			return -EINVAL;
+		}
+	} else {
+		size = compound->hdr.size - sizeof(*compound);
+		if (compound->hdr.size > MAILBOX_HOSTBOX_SIZE) {
+			trace_ipc_error("eCS");
+			trace_error_value(compound->hdr.size);
+			return -EINVAL;
+		}
+	}
+
+	count = compound->count;
+	if (count == 0 || size < count * sizeof(*hdr)) {
+		trace_ipc_error("eCn");
+		return -EINVAL;
+	}
+
+	tracev_value(count);
+	tracev_value(size);
+
+	data = rballoc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, size);
+	if (data == NULL) {
+		trace_ipc_error("eCm");
+		return -ENOMEM;
+	}
+
+	/* get all messages first, the mailbox is also used for replies */
+	if (compound->flags & SOF_IPC_COMPOUND_DMA) {
+		ret = ipc_host_buffer_read(&compound->buffer,
+					   compound->stream_tag, data, size);
+		if (ret < 0) {
+			rfree(data);
+			return ret;
+		}
+	} else {
+		mailbox_hostbox_read(data, sizeof(*compound), size);
+	}
+
+	reply.count = 0;
+	reply.cmd = 0;
+
+	/* compound header in comp_data is overwritten by each message */
+	while (reply.count < count) {
+		hdr = ipc_compound_msg(data, size, offset);
+		if (hdr == NULL) {
+			trace_ipc_error("eCh");
+			ret = -EINVAL;
+			break;
+		}
+
+		cmd = hdr->cmd;
+		hdr_size = hdr->size;
+
+		if ((cmd & SOF_GLB_TYPE_MASK) != SOF_IPC_GLB_TPLG_MSG) {
+			trace_ipc_error("eCg");
+			trace_error_value(cmd);
+			ret = -EINVAL;
+			break;
+		}
+
+		/* message handlers write their own reply, it's overwritten
+		 * by the compound reply below.
+		 */
+		memcpy(_ipc->comp_data, hdr, hdr_size);
+		ret = ipc_glb_tplg_message(cmd);
+		if (ret < 0)
+			break;
+
+		ret = 0;
+		reply.count++;
+
+		/* messages are padded to 4 bytes */
+		offset += (hdr_size + 3) & ~3;
+		if (offset > size)
+			offset = size;
+	}
+
+	if (ret < 0) {
+		trace_ipc_error("eCx");
+		trace_error_value(reply.count);
+		reply.cmd = cmd;
+	}
+
+	rfree(data);
+
+	reply.rhdr.hdr.cmd = header;
+	reply.rhdr.hdr.size = sizeof(reply);
+	reply.rhdr.error = ret;
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+	return 1;
+}
+
 /*
  * Global IPC Operations.
  */
@@ -954,7 +1467,7 @@ int ipc_cmd(void)
 	case iGS(SOF_IPC_GLB_REPLY):
 		return 0;
 	case iGS(SOF_IPC_GLB_COMPOUND):
-		return -EINVAL;	/* TODO */
+		return ipc_glb_compound_message(hdr->cmd);
 	case iGS(SOF_IPC_GLB_TPLG_MSG):
 		return ipc_glb_tplg_message(hdr->cmd);
 	case iGS(SOF_IPC_GLB_PM_MSG):
@@ -987,111 +1500,71 @@ static inline struct ipc_msg *msg_get_empty(struct ipc *ipc)
 	return msg;
 }
 
-static inline struct ipc_msg *ipc_glb_stream_message_find(struct ipc *ipc,
-	struct sof_ipc_stream_posn *posn)
+/* take the oldest queued message that can be dropped for an urgent one */
+static inline struct ipc_msg *msg_get_dropped(struct ipc *ipc)
 {
 	struct list_item *plist;
-	struct ipc_msg *msg = NULL;
-	struct sof_ipc_stream_posn *old_posn = NULL;
-	uint32_t cmd;
-
-	/* Check whether the command is expected */
-	cmd = (posn->rhdr.hdr.cmd & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
-
-	switch (cmd) {
-	case iCS(SOF_IPC_STREAM_TRIG_XRUN):
-	case iCS(SOF_IPC_STREAM_POSITION):
-
-		/* iterate host message list for searching */
-		list_for_item(plist, &ipc->msg_list) {
-			msg = container_of(plist, struct ipc_msg, list);
-			if (msg->header == posn->rhdr.hdr.cmd) {
-				old_posn = (struct sof_ipc_stream_posn *)msg->tx_data;
-				if (old_posn->comp_id == posn->comp_id)
-					return msg;
-			}
-		}
-		break;
-	default:
-		break;
-	}
-
-	/* no match */
-	return NULL;
-}
+	struct ipc_msg *msg;
 
-static inline struct ipc_msg *ipc_glb_trace_message_find(struct ipc *ipc,
-	struct sof_ipc_dma_trace_posn *posn)
-{
-	struct list_item *plist;
-	struct ipc_msg *msg = NULL;
-	uint32_t cmd;
+	list_for_item(plist, &ipc->msg_list) {
+		msg = container_of(plist, struct ipc_msg, list);
 
-	/* Check whether the command is expected */
-	cmd = (posn->rhdr.hdr.cmd & SOF_CMD_TYPE_MASK) >> SOF_CMD_TYPE_SHIFT;
+		/* only messages with a slot are superseded by later ones */
+		if (msg->slot == IPC_SLOT_NONE)
+			continue;
 
-	switch (cmd) {
-	case iCS(SOF_IPC_TRACE_DMA_POSITION):
-		/* iterate host message list for searching */
-		list_for_item(plist, &ipc->msg_list) {
-			msg = container_of(plist, struct ipc_msg, list);
-			if (msg->header == posn->rhdr.hdr.cmd)
-				return msg;
-		}
-		break;
-	default:
-		break;
+		list_item_del(&msg->list);
+		ipc->slot[msg->slot] = NULL;
+		ipc->msg_overflow++;
+		return msg;
 	}
 
-	/* no match */
 	return NULL;
 }
 
-static inline struct ipc_msg *msg_find(struct ipc *ipc, uint32_t header,
-	void *tx_data)
-{
-	uint32_t type;
-
-	/* use different sub function for different global message type */
-	type = (header & SOF_GLB_TYPE_MASK) >> SOF_GLB_TYPE_SHIFT;
-
-	switch (type) {
-	case iGS(SOF_IPC_GLB_STREAM_MSG):
-		return ipc_glb_stream_message_find(ipc,
-			(struct sof_ipc_stream_posn *)tx_data);
-	case iGS(SOF_IPC_GLB_TRACE_MSG):
-		return ipc_glb_trace_message_find(ipc,
-			(struct sof_ipc_dma_trace_posn *)tx_data);
-	default:
-		/* not found */
-		return NULL;
-	}
-}
-
 int ipc_queue_host_message(struct ipc *ipc, uint32_t header,
 	void *tx_data, size_t tx_bytes, void *rx_data,
-	size_t rx_bytes, void (*cb)(void*, void*), void *cb_data, uint32_t replace)
+	size_t rx_bytes, void (*cb)(void*, void*), void *cb_data, int slot)
 {
 	struct ipc_msg *msg = NULL;
-	uint32_t flags, found = 0;
+	uint32_t flags;
 	int ret = 0;
 
 	spin_lock_irq(&ipc->lock, flags);
 
-	/* do we need to replace an existing message? */
-	if (replace)
-		msg = msg_find(ipc, header, tx_data);
+	/* replace any message still queued in the same slot */
+	if (slot != IPC_SLOT_NONE) {
+		msg = ipc->slot[slot];
+		if (msg)
+			ipc->msg_coalesced++;
+	}
 
-	/* do we need to use a new empty message? */
-	if (msg)
-		found = 1;
-	else
+	if (msg == NULL) {
 		msg = msg_get_empty(ipc);
 
-	if (msg == NULL) {
-		trace_ipc_error("eQb");
-		ret = -EBUSY;
-		goto out;
+		/* XRUNs must get to the host, drop a stale message instead */
+		if (msg == NULL && IPC_SLOT_URGENT(slot))
+			msg = msg_get_dropped(ipc);
+
+		if (msg == NULL) {
+			ipc->msg_overflow++;
+			trace_ipc_error("eQb");
+			trace_error_value(header);
+			trace_error_value(ipc->msg_overflow);
+			ret = -EBUSY;
+			goto out;
+		}
+
+		/* now queue the message */
+		msg->slot = slot;
+		if (slot != IPC_SLOT_NONE)
+			ipc->slot[slot] = msg;
+
+		ipc->dsp_pending = 1;
+		if (IPC_SLOT_URGENT(slot))
+			list_item_append(&msg->list, &ipc->urgent_list);
+		else
+			list_item_append(&msg->list, &ipc->msg_list);
 	}
 
 	/* prepare the message */
@@ -1105,17 +1578,34 @@ int ipc_queue_host_message(struct ipc *ipc, uint32_t header,
 	if (tx_bytes > 0 && tx_bytes < SOF_IPC_MSG_MAX_SIZE)
 		rmemcpy(msg->tx_data, tx_data, tx_bytes);
 
-	if (!found) {
-		/* now queue the message */
-		ipc->dsp_pending = 1;
-		list_item_append(&msg->list, &ipc->msg_list);
-	}
-
 out:
 	spin_unlock_irq(&ipc->lock, flags);
 	return ret;
 }
 
+/* dequeue the next message to send, called with the IPC lock held */
+struct ipc_msg *ipc_msg_next(struct ipc *ipc)
+{
+	struct ipc_msg *msg;
+
+	if (!list_is_empty(&ipc->urgent_list))
+		msg = list_first_item(&ipc->urgent_list, struct ipc_msg, list);
+	else if (!list_is_empty(&ipc->msg_list))
+		msg = list_first_item(&ipc->msg_list, struct ipc_msg, list);
+	else
+		return NULL;
+
+	list_item_del(&msg->list);
+
+	/* later messages for this slot must be queued again */
+	if (msg->slot != IPC_SLOT_NONE) {
+		ipc->slot[msg->slot] = NULL;
+		msg->slot = IPC_SLOT_NONE;
+	}
+
+	return msg;
+}
+
 /* process current message */
 int ipc_process_msg_queue(void)
 {
@@ -74,8 +74,6 @@ static void do_notify(void)
 	if (msg->cb)
 		msg->cb(msg->cb_data, msg->rx_data);
 
-	list_item_append(&msg->list, &_ipc->empty_list);
-
 out:
 	spin_unlock_irq(&_ipc->lock, flags);
 
@@ -169,20 +167,19 @@ void ipc_platform_send_msg(struct ipc *ipc)
 
 	spin_lock_irq(&ipc->lock, flags);
 
+	/* can't send nofication when one is in progress */
+	if (shim_read(SHIM_IPCD) & (SHIM_IPCD_BUSY | SHIM_IPCD_DONE))
+		goto out;
+
 	/* any messages to send ? */
-	if (list_is_empty(&ipc->msg_list)) {
+	msg = ipc_msg_next(ipc);
+	if (msg == NULL) {
 		ipc->dsp_pending = 0;
 		goto out;
 	}
 
-	/* can't send nofication when one is in progress */
-	if (shim_read(SHIM_IPCD) & (SHIM_IPCD_BUSY | SHIM_IPCD_DONE))
-		goto out;
-
 	/* now send the message */
-	msg = list_first_item(&ipc->msg_list, struct ipc_msg, list);
 	mailbox_dspbox_write(0, msg->tx_data, msg->tx_size);
-	list_item_del(&msg->list);
 	ipc->dsp_msg = msg;
 	tracev_ipc("Msg");
 
@@ -210,6 +207,7 @@ int platform_ipc_init(struct ipc *ipc)
 	_ipc->dsp_msg = NULL;
 	list_init(&ipc->empty_list);
 	list_init(&ipc->msg_list);
+	list_init(&ipc->urgent_list);
 	spinlock_init(&ipc->lock);
 
 	for (i = 0; i < MSG_QUEUE_SIZE; i++)
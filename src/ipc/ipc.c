@@ -40,6 +40,7 @@
 #include <sof/ipc.h>
 #include <sof/debug.h>
 #include <platform/platform.h>
+#include <platform/mailbox.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/audio/buffer.h>
@@ -78,10 +79,15 @@ struct ipc_comp_dev *ipc_get_comp(struct ipc *ipc, uint32_t id)
 	return NULL;
 }
 
+/* stream status array follows the position array in the stream region */
+#define IPC_STREAM_STATUS_OFFSET \
+	(PLATFORM_MAX_STREAMS * sizeof(struct sof_ipc_stream_posn))
+
 int ipc_get_posn_offset(struct ipc *ipc, struct pipeline *pipe)
 {
 	int i;
 	uint32_t posn_size = sizeof(struct sof_ipc_stream_posn);
+	uint32_t status_size = sizeof(struct sof_ipc_stream_status);
 
 	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
 		if (ipc->posn_map[i] == pipe)
@@ -92,6 +98,15 @@ int ipc_get_posn_offset(struct ipc *ipc, struct pipeline *pipe)
 		if (ipc->posn_map[i] == NULL) {
 			ipc->posn_map[i] = pipe;
 			pipe->posn_offset = i * posn_size;
+
+			/* no stream status if the stream region is too small */
+			if (IPC_STREAM_STATUS_OFFSET + (i + 1) * status_size <=
+			    MAILBOX_STREAM_SIZE)
+				pipe->status_offset = IPC_STREAM_STATUS_OFFSET +
+					i * status_size;
+			else
+				pipe->status_offset = 0;
+
 			return pipe->posn_offset;
 		}
 	}
@@ -206,11 +221,67 @@ int ipc_buffer_free(struct ipc *ipc, uint32_t buffer_id)
 	return 0;
 }
 
+static struct pipeline *ipc_get_pipeline(struct ipc *ipc,
+	uint32_t pipeline_id)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type == COMP_TYPE_PIPELINE &&
+		    icd->pipeline->ipc_pipe.pipeline_id == pipeline_id)
+			return icd->pipeline;
+	}
+
+	return NULL;
+}
+
+/* connection joins two pipelines so source pipeline produces data that sink
+ * pipeline consumes, and must be scheduled first in each period. Pipelines
+ * on different cores are stages that run in parallel with the consumer one
+ * period behind, so they share buffer as a SPSC ring instead. */
+static int ipc_pipeline_depend(struct ipc *ipc, struct ipc_comp_dev *ibd,
+	uint32_t source_id, uint32_t sink_id)
+{
+	struct pipeline *producer;
+	struct pipeline *consumer;
+	struct comp_buffer *buffer;
+
+	if (source_id == sink_id)
+		return 0;
+
+	producer = ipc_get_pipeline(ipc, source_id);
+	consumer = ipc_get_pipeline(ipc, sink_id);
+	if (producer == NULL || consumer == NULL) {
+		trace_ipc_error("eCd");
+		trace_error_value((source_id << 16) | sink_id);
+		return 0;
+	}
+
+	if (producer->ipc_pipe.core != consumer->ipc_pipe.core) {
+		if (!ibd->cb->shared) {
+			/* only shared buffers need a cache line aligned header */
+			buffer = buffer_share(ibd->cb);
+			if (buffer == NULL)
+				return -ENOMEM;
+
+			ibd->cb = buffer;
+			producer->shared_buffers++;
+			consumer->shared_buffers++;
+		}
+		return 0;
+	}
+
+	return schedule_task_depend(&consumer->pipe_task, &producer->pipe_task);
+}
+
 int ipc_comp_connect(struct ipc *ipc,
 	struct sof_ipc_pipe_comp_connect *connect)
 {
 	struct ipc_comp_dev *icd_source;
 	struct ipc_comp_dev *icd_sink;
+	int ret;
 
 	/* check whether the components already exist */
 	icd_source = ipc_get_comp(ipc, connect->source_id);
@@ -229,14 +300,26 @@ int ipc_comp_connect(struct ipc *ipc,
 
 	/* check source and sink types */
 	if (icd_source->type == COMP_TYPE_BUFFER &&
-		icd_sink->type == COMP_TYPE_COMPONENT)
-		return pipeline_buffer_connect(icd_source->pipeline,
+		icd_sink->type == COMP_TYPE_COMPONENT) {
+		ret = pipeline_buffer_connect(icd_source->pipeline,
 			icd_source->cb, icd_sink->cd);
-	else if (icd_source->type == COMP_TYPE_COMPONENT &&
-		icd_sink->type == COMP_TYPE_BUFFER)
-		return pipeline_comp_connect(icd_source->pipeline,
+		if (ret < 0)
+			return ret;
+
+		return ipc_pipeline_depend(ipc, icd_source,
+			icd_source->cb->ipc_buffer.comp.pipeline_id,
+			icd_sink->cd->comp.pipeline_id);
+	} else if (icd_source->type == COMP_TYPE_COMPONENT &&
+		icd_sink->type == COMP_TYPE_BUFFER) {
+		ret = pipeline_comp_connect(icd_source->pipeline,
 			icd_source->cd, icd_sink->cb);
-	else {
+		if (ret < 0)
+			return ret;
+
+		return ipc_pipeline_depend(ipc, icd_sink,
+			icd_source->cd->comp.pipeline_id,
+			icd_sink->cb->ipc_buffer.comp.pipeline_id);
+	} else {
 		trace_ipc_error("eCt");
 		trace_error_value(connect->source_id);
 		trace_error_value(connect->sink_id);
@@ -30,12 +30,15 @@
  */
 
 #include <sof/alloc.h>
+#include <sof/bitmap.h>
 #include <sof/sof.h>
 #include <sof/debug.h>
 #include <sof/panic.h>
 #include <sof/trace.h>
 #include <sof/lock.h>
+#include <sof/math/numbers.h>
 #include <platform/memory.h>
+#include <uapi/ipc.h>
 #include <stdint.h>
 
 /* debug to set memory value on every allocation */
@@ -113,6 +116,11 @@ static void *rmalloc_sys(size_t bytes)
 		panic(SOF_IPC_PANIC_MEM);
 	}
 
+	/* system memory is never freed so used is also the peak */
+	memmap.system.info.used += bytes;
+	memmap.system.info.free -= bytes;
+	memmap.system.info.peak = memmap.system.info.used;
+
 #if DEBUG_BLOCK_ALLOC
 	alloc_memset_region(ptr, bytes, DEBUG_BLOCK_ALLOC_VALUE);
 #endif
@@ -120,35 +128,104 @@ static void *rmalloc_sys(size_t bytes)
 	return ptr;
 }
 
+/* find first free block at or after start, returns map->count if none */
+static inline unsigned int map_next_free(struct block_map *map,
+	unsigned int start)
+{
+	return bitmap_next_set(map->bitmap, map->count, start);
+}
+
+/* find first used block at or after start, returns map->count if none */
+static inline unsigned int map_next_used(struct block_map *map,
+	unsigned int start)
+{
+	return bitmap_next_clear(map->bitmap, map->count, start);
+}
+
+/* mark count blocks from start as free or used in the bitmap */
+static inline void map_update(struct block_map *map, unsigned int start,
+	unsigned int count, int free)
+{
+	bitmap_update(map->bitmap, start, count, free);
+}
+
+/* find largest run of continuous free blocks in map */
+static unsigned int map_largest_free(struct block_map *map)
+{
+	unsigned int largest = 0;
+	unsigned int start;
+	unsigned int end;
+
+	for (start = map->first_free; start < map->count;
+		start = map_next_free(map, end)) {
+		end = map_next_used(map, start);
+		largest = MAX(largest, end - start);
+	}
+
+	return largest;
+}
+
+/* update high water marks after allocating from map */
+static inline void alloc_update_peak(struct mm_heap *heap,
+	struct block_map *map)
+{
+	heap->info.peak = MAX(heap->info.peak, heap->info.used);
+	map->peak_used = MAX(map->peak_used, map->count - map->free_count);
+}
+
 /* allocate single block */
 static void *alloc_block(struct mm_heap *heap, int level,
 	uint32_t caps)
 {
 	struct block_map *map = &heap->map[level];
-	struct block_hdr *hdr = &map->block[map->first_free];
+	unsigned int block = map->first_free;
+	struct block_hdr *hdr = &map->block[block];
 	void *ptr;
-	int i;
 
 	map->free_count--;
-	ptr = (void *)(map->base + map->first_free * map->block_size);
+	ptr = (void *)(map->base + block * map->block_size);
 	hdr->size = 1;
 	hdr->used = 1;
 	heap->info.used += map->block_size;
 	heap->info.free -= map->block_size;
+	alloc_update_peak(heap, map);
 
 	/* find next free */
-	for (i = map->first_free; i < map->count; ++i) {
+	map_update(map, block, 1, 0);
+	map->first_free = map_next_free(map, block + 1);
 
-		hdr = &map->block[i];
+#if DEBUG_BLOCK_ALLOC
+	alloc_memset_region(ptr, map->block_size, DEBUG_BLOCK_ALLOC_VALUE);
+#endif
 
-		if (hdr->used == 0) {
-			map->first_free = i;
-			break;
-		}
-	}
+	return ptr;
+}
+
+/* allocate count continuous free blocks from start */
+static void *alloc_blocks_at(struct mm_heap *heap, struct block_map *map,
+	unsigned int start, unsigned int count, size_t bytes)
+{
+	unsigned int current;
+	void *ptr;
+
+	map->free_count -= count;
+	ptr = (void *)(map->base + start * map->block_size);
+	map->block[start].size = count;
+	heap->info.used += count * map->block_size;
+	heap->info.free -= count * map->block_size;
+	alloc_update_peak(heap, map);
+
+	/* allocate each block */
+	for (current = start; current < start + count; current++)
+		map->block[current].used = 1;
+	map_update(map, start, count, 0);
+
+	/* do we need to find a new first free block ? */
+	if (start == map->first_free)
+		map->first_free = map_next_free(map, start + count);
 
 #if DEBUG_BLOCK_ALLOC
-	alloc_memset_region(ptr, map->block_size, DEBUG_BLOCK_ALLOC_VALUE);
+	alloc_memset_region(ptr, bytes, DEBUG_BLOCK_ALLOC_VALUE);
 #endif
 
 	return ptr;
@@ -159,75 +236,33 @@ static void *alloc_cont_blocks(struct mm_heap *heap, int level,
 	uint32_t caps, size_t bytes)
 {
 	struct block_map *map = &heap->map[level];
-	struct block_hdr *hdr = &map->block[map->first_free];
-	void *ptr;
 	unsigned int start;
-	unsigned int current;
 	unsigned int count = bytes / map->block_size;
-	unsigned int i;
-	unsigned int remaining = map->count - count;
 	unsigned int end;
 
 	if (bytes % map->block_size)
 		count++;
 
-	/* check for continuous blocks from "start" */
-	for (start = map->first_free; start < remaining; start++) {
+	/* not enough free blocks in the whole map */
+	if (count > map->free_count)
+		return NULL;
 
-		/* check that we have enough free blocks from start pos */
-		end = start + count;
-		for (current = start; current < end; current++) {
-			hdr = &map->block[current];
+	/* walk the free runs until one is long enough */
+	for (start = map->first_free; start < map->count;
+		start = map_next_free(map, end)) {
 
-			/* is block used */
-			if (hdr->used)
-				break;
-		}
+		end = map_next_used(map, start);
 
 		/* enough free blocks ? */
-		if (current == end)
+		if (end - start >= count)
 			goto found;
 	}
 
 	/* not found */
-	trace_mem_error("eCb");
 	return NULL;
 
 found:
-	/* found some free blocks */
-	map->free_count -= count;
-	ptr = (void *)(map->base + start * map->block_size);
-	hdr = &map->block[start];
-	hdr->size = count;
-	heap->info.used += count * map->block_size;
-	heap->info.free -= count * map->block_size;
-
-	/* allocate each block */
-	for (current = start; current < end; current++) {
-		hdr = &map->block[current];
-		hdr->used = 1;
-	}
-
-	/* do we need to find a new first free block ? */
-	if (start == map->first_free) {
-
-		/* find next free */
-		for (i = map->first_free + count; i < map->count; ++i) {
-
-			hdr = &map->block[i];
-
-			if (hdr->used == 0) {
-				map->first_free = i;
-				break;
-			}
-		}
-	}
-
-#if DEBUG_BLOCK_ALLOC
-	alloc_memset_region(ptr, bytes, DEBUG_BLOCK_ALLOC_VALUE);
-#endif
-
-	return ptr;
+	return alloc_blocks_at(heap, map, start, count, bytes);
 }
 
 static struct mm_heap *get_heap_from_ptr(void *ptr)
@@ -289,14 +324,43 @@ static struct mm_heap *get_buffer_heap_from_caps(uint32_t caps)
 	return NULL;
 }
 
+/* find map that ptr belongs to. Maps have different block sizes so there is
+ * no direct address to map translation, instead this is a binary search over
+ * the map base addresses which are in ascending order, i.e. at most 3 steps
+ * for the 8 maps of the largest heaps.
+ */
+static struct block_map *get_map_from_ptr(struct mm_heap *heap, void *ptr)
+{
+	struct block_map *map;
+	int low = 0;
+	int high = heap->blocks - 1;
+	int mid;
+
+	while (low < high) {
+		mid = (low + high + 1) >> 1;
+
+		if ((uint32_t)ptr < heap->map[mid].base)
+			high = mid - 1;
+		else
+			low = mid;
+	}
+
+	map = &heap->map[low];
+	if ((uint32_t)ptr >= map->base + map->count * map->block_size)
+		return NULL;
+
+	return map;
+}
+
 /* free block(s) */
 static void free_block(void *ptr)
 {
 	struct mm_heap *heap;
 	struct block_map *block_map;
 	struct block_hdr *hdr;
-	int i;
-	int block;
+	unsigned int block;
+	unsigned int count;
+	unsigned int i;
 
 	/* sanity check */
 	if (ptr == NULL)
@@ -307,44 +371,61 @@ static void free_block(void *ptr)
 		return;
 
 	/* find block that ptr belongs to */
-	for (i = 0; i < heap->blocks - 1; i++) {
-
-		/* is ptr in this block */
-		if ((uint32_t)ptr < heap->map[i + 1].base)
-			goto found;
+	block_map = get_map_from_ptr(heap, ptr);
+	if (block_map == NULL) {
+		trace_mem_error("eMF");
+		return;
 	}
 
-	/* not found */
-	trace_mem_error("eMF");
-	return;
-
-found:
-	/* the block i is it */
-	block_map = &heap->map[i];
-
 	/* calculate block header */
 	block = ((uint32_t)ptr - block_map->base) / block_map->block_size;
 	hdr = &block_map->block[block];
+	count = hdr->size;
 
 	/* free block header and continuous blocks */
-	for (i = block; i < block + hdr->size; i++) {
+	for (i = block; i < block + count; i++) {
 		hdr = &block_map->block[i];
 		hdr->size = 0;
 		hdr->used = 0;
-		block_map->free_count++;
-		heap->info.used -= block_map->block_size;
-		heap->info.free += block_map->block_size;
 	}
+	map_update(block_map, block, count, 1);
+
+	block_map->free_count += count;
+	heap->info.used -= count * block_map->block_size;
+	heap->info.free += count * block_map->block_size;
 
 	/* set first free block */
 	if (block < block_map->first_free)
 		block_map->first_free = block;
 
 #if DEBUG_BLOCK_FREE
-	alloc_memset_region(ptr, block_map->block_size * (i - 1), DEBUG_BLOCK_FREE_VALUE);
+	alloc_memset_region(ptr, block_map->block_size * count,
+		DEBUG_BLOCK_FREE_VALUE);
 #endif
 }
 
+/* count a failed request once, against the map of its size class. That is
+ * the smallest map with big enough blocks or the largest map that is tried
+ * first for continuous blocks.
+ */
+static void alloc_failed(struct mm_heap *heap, size_t bytes)
+{
+	int i;
+
+	heap->info.failures++;
+
+	/* blocks is unsigned, blocks - 1 would wrap */
+	if (!heap->blocks)
+		return;
+
+	for (i = 0; i < heap->blocks - 1; i++) {
+		if (heap->map[i].block_size >= bytes)
+			break;
+	}
+
+	heap->map[i].failures++;
+}
+
 /* allocate single block for runtime */
 static void *rmalloc_runtime(uint32_t caps, size_t bytes)
 {
@@ -376,6 +457,8 @@ find:
 		return alloc_block(heap, i, caps);
 	}
 
+	alloc_failed(heap, bytes);
+
 error:
 	trace_mem_error("eMm");
 	trace_error_value(bytes);
@@ -402,6 +485,12 @@ void *rmalloc(int zone, uint32_t caps, size_t bytes)
 		break;
 	}
 
+	if (zone >= 0 && zone < RZONE_COUNT) {
+		memmap.zone[zone].allocs++;
+		if (ptr == NULL)
+			memmap.zone[zone].failures++;
+	}
+
 	spin_unlock_irq(&memmap.lock, flags);
 	return ptr;
 }
@@ -448,28 +537,111 @@ void *rballoc(int zone, uint32_t caps, size_t bytes)
 		goto out;
 	}
 
-	/* request spans > 1 block */
+	/* request spans > 1 block, prefer largest block size first */
+	for (i = heap->blocks - 1; i >= 0; i--) {
+		ptr = alloc_cont_blocks(heap, i, caps, bytes);
+		if (ptr)
+			goto out;
+	}
 
-	/* only 1 choice for block size */
-	if (heap->blocks == 1) {
-		ptr = alloc_cont_blocks(heap, 0, caps, bytes);
-		goto out;
-	} else {
+	/* not found */
+	trace_mem_error("eCb");
+	alloc_failed(heap, bytes);
 
-		/* find best block size for request */
-		for (i = 0; i < heap->blocks; i++) {
+out:
+	if (zone >= 0 && zone < RZONE_COUNT) {
+		memmap.zone[zone].allocs++;
+		if (ptr == NULL)
+			memmap.zone[zone].failures++;
+	}
 
-			/* allocate is block size smaller than request */
-			if (heap->map[i].block_size < bytes)
-				alloc_cont_blocks(heap, i, caps, bytes);
+	spin_unlock_irq(&memmap.lock, flags);
+	return ptr;
+}
+
+#ifdef SRAM_BANK_SIZE
+/* allocates continuous blocks outside of SRAM banks first to last */
+static void *alloc_cont_blocks_bank(struct mm_heap *heap, int level,
+	size_t bytes, uint32_t first, uint32_t last)
+{
+	struct block_map *map = &heap->map[level];
+	uint32_t addr;
+	unsigned int start;
+	unsigned int block;
+	unsigned int count = bytes / map->block_size;
+	unsigned int end;
+
+	if (bytes % map->block_size)
+		count++;
+
+	/* not enough free blocks in the whole map */
+	if (count > map->free_count)
+		return NULL;
+
+	for (start = map->first_free; start < map->count;
+		start = map_next_free(map, end)) {
+
+		end = map_next_used(map, start);
+
+		/* look for room before or after the banks in this free run */
+		for (block = start; block + count <= end;) {
+			addr = map->base + block * map->block_size;
+			if (SRAM_BANK(addr + count * map->block_size - 1) < first
+				|| SRAM_BANK(addr) > last)
+				return alloc_blocks_at(heap, map, block, count,
+					bytes);
+
+			/* skip to first block after the banks */
+			block = ((last + 1) * SRAM_BANK_SIZE - map->base +
+				map->block_size - 1) / map->block_size;
 		}
 	}
 
-	ptr = alloc_cont_blocks(heap, heap->blocks - 1, caps, bytes);
+	return NULL;
+}
+#endif
+
+void *rballoc_bank(int zone, uint32_t caps, size_t bytes, void *avoid,
+	size_t avoid_bytes)
+{
+#ifdef SRAM_BANK_SIZE
+	struct mm_heap *heap;
+	uint32_t first = SRAM_BANK(avoid);
+	uint32_t last = SRAM_BANK(avoid + avoid_bytes - 1);
+	uint32_t flags;
+	void *ptr = NULL;
+	int i;
+
+	spin_lock_irq(&memmap.lock, flags);
+
+	heap = get_buffer_heap_from_caps(caps);
+	if (heap == NULL)
+		goto out;
+
+	/* same policy as rballoc(), single block first */
+	for (i = 0; i < heap->blocks && ptr == NULL; i++) {
+		if (heap->map[i].block_size >= bytes)
+			ptr = alloc_cont_blocks_bank(heap, i, bytes, first,
+				last);
+	}
+
+	for (i = heap->blocks - 1; i >= 0 && ptr == NULL; i--) {
+		if (heap->map[i].block_size < bytes)
+			ptr = alloc_cont_blocks_bank(heap, i, bytes, first,
+				last);
+	}
+
+	if (ptr != NULL && zone >= 0 && zone < RZONE_COUNT)
+		memmap.zone[zone].allocs++;
 
 out:
 	spin_unlock_irq(&memmap.lock, flags);
-	return ptr;
+	if (ptr != NULL)
+		return ptr;
+#endif
+
+	/* no room outside the banks of avoid, any placement will do */
+	return rballoc(zone, caps, bytes);
 }
 
 void rfree(void *ptr)
@@ -481,23 +653,294 @@ void rfree(void *ptr)
 	spin_unlock_irq(&memmap.lock, flags);
 }
 
-uint32_t mm_pm_context_size(void)
+/* get usage and fragmentation statistics for one heap */
+int mm_heap_stats(uint32_t zone, uint32_t index,
+	struct sof_ipc_mem_stats *stats)
+{
+	struct mm_heap *heap;
+	struct block_map *map;
+	uint32_t flags;
+	int i;
+
+	switch (zone) {
+	case RZONE_SYS:
+		if (index > 0)
+			return -EINVAL;
+		heap = &memmap.system;
+		break;
+	case RZONE_RUNTIME:
+		if (index >= PLATFORM_HEAP_RUNTIME)
+			return -EINVAL;
+		heap = &memmap.runtime[index];
+		break;
+	case RZONE_BUFFER:
+		if (index >= PLATFORM_HEAP_BUFFER)
+			return -EINVAL;
+		heap = &memmap.buffer[index];
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&memmap.lock, flags);
+
+	stats->zone = zone;
+	stats->index = index;
+	stats->caps = heap->caps;
+	stats->size = heap->size;
+	stats->used = heap->info.used;
+	stats->free = heap->info.free;
+	stats->peak = heap->info.peak;
+	stats->failures = heap->info.failures;
+	stats->zone_allocs = memmap.zone[zone].allocs;
+	stats->zone_failures = memmap.zone[zone].failures;
+	stats->num_maps = MIN(heap->blocks, SOF_IPC_MAX_MEM_MAPS);
+
+	/* system heap has no map and is always continuous */
+	stats->largest_free = heap->blocks ? 0 : heap->info.free;
+
+	for (i = 0; i < stats->num_maps; i++) {
+		map = &heap->map[i];
+
+		stats->map[i].block_size = map->block_size;
+		stats->map[i].count = map->count;
+		stats->map[i].free_count = map->free_count;
+		stats->map[i].peak_used = map->peak_used;
+		stats->map[i].largest_free = map_largest_free(map);
+		stats->map[i].failures = map->failures;
+
+		stats->largest_free = MAX(stats->largest_free,
+			stats->map[i].largest_free * map->block_size);
+	}
+
+	spin_unlock_irq(&memmap.lock, flags);
+
+	return 0;
+}
+
+/*
+ * PM context image layout, in host SG buffer order :-
+ *
+ * 1) struct mm_pm_ctx_hdr
+ * 2) struct mm memmap
+ * 3) system heap contents in use
+ * 4) for every runtime and buffer heap map: the struct block_map, its block
+ *    headers and free bitmap followed by the contents of the used blocks.
+ *    The used blocks are found from the saved bitmap so only they are
+ *    transferred, runs of continuous used blocks in a single DMA copy. With
+ *    PM_CTX_ZERO_BLOCKS each 32 block bitmap word is preceded by a word
+ *    flagging its used blocks that are all zero, these are not transferred
+ *    and are cleared on restore.
+ *
+ * Save and restore walk the image in the same order using the same code.
+ */
+struct pm_ctx {
+	struct dma_copy *dc;
+	struct dma_sg_config *sg;
+	int32_t offset;		/* current offset in host SG buffer */
+	uint32_t flags;
+	int restore;
+};
+
+static int pm_ctx_copy(struct pm_ctx *ctx, void *ptr, uint32_t bytes)
+{
+	int32_t ret;
+
+	if (bytes == 0)
+		return 0;
+
+	if (ctx->restore)
+		ret = dma_copy_from_host(ctx->dc, ctx->sg, ctx->offset,
+			ptr, bytes);
+	else
+		ret = dma_copy_to_host(ctx->dc, ctx->sg, ctx->offset,
+			ptr, bytes);
+	if (ret < 0)
+		return ret;
+
+	ctx->offset += bytes;
+	return 0;
+}
+
+/* check if block contents are all zero */
+static int block_is_zero(struct block_map *map, unsigned int block)
+{
+	uint32_t *data = (uint32_t *)(map->base + block * map->block_size);
+	unsigned int words = map->block_size >> 2;
+	unsigned int i;
+
+	for (i = 0; i < words; i++) {
+		if (data[i])
+			return 0;
+	}
+
+	return 1;
+}
+
+/* copy or clear a run of used blocks */
+static int pm_ctx_blocks(struct pm_ctx *ctx, struct block_map *map,
+	unsigned int start, unsigned int count, int zero)
+{
+	void *ptr = (void *)(map->base + start * map->block_size);
+	uint32_t bytes = count * map->block_size;
+
+	if (!zero)
+		return pm_ctx_copy(ctx, ptr, bytes);
+
+	if (ctx->restore)
+		bzero(ptr, bytes);
+
+	return 0;
+}
+
+static int pm_ctx_map(struct pm_ctx *ctx, struct block_map *map)
+{
+	unsigned int words;
+	unsigned int word;
+	unsigned int start;
+	unsigned int end;
+	unsigned int i;
+	uint32_t used;
+	uint32_t zero;
+	int ret;
+
+	/* descriptor - map state, block headers and free bitmap */
+	ret = pm_ctx_copy(ctx, map, sizeof(*map));
+	if (ret < 0)
+		return ret;
+
+	ret = pm_ctx_copy(ctx, map->block,
+		map->count * sizeof(struct block_hdr));
+	if (ret < 0)
+		return ret;
+
+	words = BLOCK_MAP_WORDS(map->count);
+	ret = pm_ctx_copy(ctx, map->bitmap, words * sizeof(uint32_t));
+	if (ret < 0)
+		return ret;
+
+	/* contents of used blocks, one bitmap word at a time */
+	for (word = 0; word < words; word++) {
+		start = word << 5;
+		end = MIN(start + 32, map->count);
+		used = ~map->bitmap[word];
+		zero = 0;
+
+		if (ctx->flags & PM_CTX_ZERO_BLOCKS) {
+			if (!ctx->restore) {
+				for (i = start; i < end; i++) {
+					if (((used >> (i & 31)) & 1) &&
+						block_is_zero(map, i))
+						zero |= 1U << (i & 31);
+				}
+			}
+
+			ret = pm_ctx_copy(ctx, &zero, sizeof(zero));
+			if (ret < 0)
+				return ret;
+		}
+
+		/* find runs of used blocks with the same zero state */
+		i = start;
+		while (i < end) {
+			if (!((used >> (i & 31)) & 1)) {
+				i++;
+				continue;
+			}
+
+			start = i;
+			while (++i < end && ((used >> (i & 31)) & 1) &&
+				((zero >> (i & 31)) & 1) ==
+				((zero >> (start & 31)) & 1))
+				;
+
+			ret = pm_ctx_blocks(ctx, map, start, i - start,
+				(zero >> (start & 31)) & 1);
+			if (ret < 0)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int pm_ctx_heap(struct pm_ctx *ctx, struct mm_heap *heap)
+{
+	int ret;
+	int i;
+
+	for (i = 0; i < heap->blocks; i++) {
+		ret = pm_ctx_map(ctx, &heap->map[i]);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* walk the PM context image after the header, see layout above */
+static int pm_ctx_walk(struct pm_ctx *ctx)
 {
+	int ret;
+	int i;
+
+	ret = pm_ctx_copy(ctx, &memmap, sizeof(memmap));
+	if (ret < 0)
+		return ret;
+
+	/* system heap is continuous and used up to the current heap pointer */
+	ret = pm_ctx_copy(ctx, (void *)HEAP_SYSTEM_BASE,
+		memmap.system.heap - HEAP_SYSTEM_BASE);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++) {
+		ret = pm_ctx_heap(ctx, &memmap.runtime[i]);
+		if (ret < 0)
+			return ret;
+	}
+
+	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++) {
+		ret = pm_ctx_heap(ctx, &memmap.buffer[i]);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* size of map descriptor and used block contents in the PM context */
+static uint32_t pm_ctx_heap_size(struct mm_heap *heap)
+{
+	struct block_map *map;
 	uint32_t size = 0;
 	int i;
 
-	/* calc context size for each area  */
-	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++)
-		size += memmap.buffer[i].info.used;
-	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++)
-		size += memmap.runtime[i].info.used;
-	size += memmap.system.info.used;
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+		size += sizeof(*map) + map->count * sizeof(struct block_hdr) +
+			BLOCK_MAP_WORDS(map->count) * sizeof(uint32_t) * 2 +
+			(map->count - map->free_count) * map->block_size;
+	}
+
+	return size;
+}
 
-	/* add memory maps */
+/* worst case size of PM context i.e. with no zero blocks */
+uint32_t mm_pm_context_size(void)
+{
+	uint32_t size;
+	int i;
+
+	/* context header, memory maps and system heap in use */
+	size = sizeof(struct mm_pm_ctx_hdr) + sizeof(memmap) +
+		memmap.system.heap - HEAP_SYSTEM_BASE;
+
+	/* map descriptors and used blocks */
 	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++)
-		size += heap_get_size(&memmap.buffer[i]);
+		size += pm_ctx_heap_size(&memmap.buffer[i]);
 	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++)
-		size += heap_get_size(&memmap.runtime[i]);
+		size += pm_ctx_heap_size(&memmap.runtime[i]);
 	size += heap_get_size(&memmap.system);
 
 	/* recalc totals */
@@ -522,38 +965,43 @@ uint32_t mm_pm_context_size(void)
  * must be disabled before calling this functions. No allocations are permitted after
  * calling this and before calling restore.
  */
-int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg)
+int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg,
+	uint32_t flags)
 {
-	uint32_t used;
-	int32_t offset = 0;
-	int32_t ret;
+	struct mm_pm_ctx_hdr hdr;
+	struct pm_ctx ctx = {
+		.dc = dc,
+		.sg = sg,
+		.offset = sizeof(hdr),
+		.flags = flags,
+		.restore = 0,
+	};
+	int ret;
 
 	/* first make sure SG buffer has enough space on host for DSP context */
-	used = mm_pm_context_size();
-	if (used > dma_sg_get_size(sg))
+	if (mm_pm_context_size() > dma_sg_get_size(sg))
 		return -EINVAL;
 
-	/* copy memory maps to SG */
-	ret = dma_copy_to_host(dc, sg, offset,
-		(void *)&memmap, sizeof(memmap));
+	/* copy memory maps and used memory contents to SG */
+	ret = pm_ctx_walk(&ctx);
 	if (ret < 0)
 		return ret;
 
-	/* copy system memory contents to SG */
-	ret = dma_copy_to_host(dc, sg, offset + ret,
-		(void *)memmap.system.heap, (int32_t)(memmap.system.size));
+	/* header last, now the image size is known */
+	hdr.magic = PM_CTX_MAGIC;
+	hdr.flags = flags;
+	hdr.size = ctx.offset;
+	hdr.reserved = 0;
+	ctx.offset = 0;
+
+	ret = pm_ctx_copy(&ctx, &hdr, sizeof(hdr));
 	if (ret < 0)
 		return ret;
 
-	/* copy module memory contents to SG */
-	// TODO: iterate over module block map and copy contents of each block
-	// to the host.
+	trace_mem("PMs");
+	tracev_value(hdr.size);
 
-	/* copy buffer memory contents to SG */
-	// TODO: iterate over buffer block map and copy contents of each block
-	// to the host.
-
-	return ret;
+	return hdr.size;
 }
 
 /*
@@ -562,41 +1010,57 @@ int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg)
  */
 int mm_pm_context_restore(struct dma_copy *dc, struct dma_sg_config *sg)
 {
-	int32_t offset = 0;
-	int32_t ret;
-
-	/* copy memory maps from SG */
-	ret = dma_copy_from_host(dc, sg, offset,
-		(void *)&memmap, sizeof(memmap));
+	struct mm_pm_ctx_hdr hdr;
+	struct pm_ctx ctx = {
+		.dc = dc,
+		.sg = sg,
+		.offset = 0,
+		.restore = 1,
+	};
+	int ret;
+
+	ret = pm_ctx_copy(&ctx, &hdr, sizeof(hdr));
 	if (ret < 0)
 		return ret;
 
-	/* copy system memory contents from SG */
-	ret = dma_copy_to_host(dc, sg, offset + ret,
-		(void *)memmap.system.heap, (int32_t)(memmap.system.size));
+	if (hdr.magic != PM_CTX_MAGIC || hdr.size > dma_sg_get_size(sg)) {
+		trace_mem_error("ePr");
+		return -EINVAL;
+	}
+
+	/* copy memory maps and used memory contents from SG */
+	ctx.flags = hdr.flags;
+	ret = pm_ctx_walk(&ctx);
 	if (ret < 0)
 		return ret;
 
-	/* copy module memory contents from SG */
-	// TODO: iterate over module block map and copy contents of each block
-	// to the host. This is the same block order used by the context store
-
-	/* copy buffer memory contents from SG */
-	// TODO: iterate over buffer block map and copy contents of each block
-	// to the host. This is the same block order used by the context store
+	trace_mem("PMr");
+	tracev_value(ctx.offset);
 
 	return 0;
 }
 
+/* initialise map base addresses and free bitmaps for heap */
+static void init_heap_map(struct mm_heap *heap)
+{
+	struct block_map *map;
+	uint32_t base = heap->heap;
+	int i;
+
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+		map->base = base;
+		map->first_free = 0;
+		map_update(map, 0, map->count, 1);
+
+		base += map->block_size * map->count;
+	}
+}
+
 /* initialise map */
 void init_heap(struct sof *sof)
 {
-	struct mm_heap *heap;
-	struct block_map *next_map;
-	struct block_map *current_map;
 	int i;
-	int j;
-	int k;
 
 	/* sanity check for malformed images or loader issues */
 	if (memmap.system.heap != HEAP_SYSTEM_BASE)
@@ -604,41 +1068,16 @@ void init_heap(struct sof *sof)
 
 	spinlock_init(&memmap.lock);
 
-	/* initialise buffer map */
+	/* initialise buffer map, buffer blocks must be cache line aligned */
 	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++) {
-		heap = &memmap.buffer[i];
-
-		for (j = 0; j < heap->blocks; j++) {
-
-			current_map = &heap->map[j];
-			current_map->base = heap->heap;
+		if ((memmap.buffer[i].heap | memmap.buffer[i].map[0].block_size)
+			& (DCACHE_LINE_SIZE - 1))
+			panic(SOF_IPC_PANIC_MEM);
 
-			for (k = 1; k < heap->blocks; k++) {
-				next_map = &heap->map[k];
-				next_map->base = current_map->base +
-					current_map->block_size *
-					current_map->count;
-				current_map = &heap->map[k];
-			}
-		}
+		init_heap_map(&memmap.buffer[i]);
 	}
 
 	/* initialise runtime map */
-	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++) {
-		heap = &memmap.runtime[i];
-
-		for (j = 0; j < heap->blocks; j++) {
-
-			current_map = &heap->map[j];
-			current_map->base = heap->heap;
-
-			for (k = 1; k < heap->blocks; k++) {
-				next_map = &heap->map[k];
-				next_map->base = current_map->base +
-					current_map->block_size *
-					current_map->count;
-				current_map = &heap->map[k];
-			}
-		}
-	}
+	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++)
+		init_heap_map(&memmap.runtime[i]);
 }
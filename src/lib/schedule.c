@@ -49,10 +49,19 @@
 struct schedule_data {
 	spinlock_t lock;
 	struct list_item list;	/* list of tasks in priority queue */
+	struct list_item depend_list;	/* list of task dependencies */
+	uint32_t depend_count;
 	uint32_t clock;
 	struct work work;
 };
 
+/* producer task must run before consumer task when both are due */
+struct task_depend {
+	struct task *producer;
+	struct task *consumer;
+	struct list_item list;
+};
+
 static struct schedule_data *sch;
 
 #define SLOT_ALIGN_TRIES	10
@@ -84,6 +93,44 @@ static inline void edf_reschedule(struct task *task, uint64_t current)
 	task->deadline = task->start + delta;
 }
 
+/*
+ * Get the due producer of task that must run first. Walks up the producer
+ * chain so the most upstream due task is returned. Chain length is limited by
+ * the number of dependencies in case of a dependency loop.
+ * Scheduler lock must be held by caller.
+ */
+static inline struct task *edf_get_producer(struct task *task,
+	uint64_t current)
+{
+	struct task_depend *dep;
+	struct list_item *dlist;
+	uint32_t i;
+
+	for (i = 0; i < sch->depend_count; i++) {
+		dep = NULL;
+
+		list_for_item(dlist, &sch->depend_list) {
+			dep = container_of(dlist, struct task_depend, list);
+
+			/* producer that is due but not yet run ? */
+			if (dep->consumer == task &&
+			    dep->producer->state == TASK_STATE_QUEUED &&
+			    dep->producer->start <= current)
+				break;
+
+			dep = NULL;
+		}
+
+		/* no more producers */
+		if (dep == NULL)
+			break;
+
+		task = dep->producer;
+	}
+
+	return task;
+}
+
 /*
  * Find the first non running task with the earliest deadline.
  * TODO: Reduce cache invalidations by checking if the currently
@@ -151,6 +198,10 @@ static inline struct task *edf_get_next(uint64_t current,
 		}
 	}
 
+	/* producers run before their consumers in the same period */
+	if (next_task && !list_is_empty(&sch->depend_list))
+		next_task = edf_get_producer(next_task, current);
+
 	spin_unlock_irq(&sch->lock, flags);
 	return next_task;
 }
@@ -315,6 +366,85 @@ void schedule_task_complete(struct task *task)
 	spin_unlock_irq(&sch->lock, flags);
 }
 
+/*
+ * Make consumer task depend on producer task. When both tasks are due the
+ * producer task is always run first so that any data it generates for the
+ * consumer is available in the same period.
+ */
+int schedule_task_depend(struct task *consumer, struct task *producer)
+{
+	struct task_depend *dep;
+	struct task_depend *new_dep;
+	struct list_item *dlist;
+	uint32_t flags;
+
+	if (consumer == producer)
+		return -EINVAL;
+
+	/* allocate up front so check and insert are done in one lock hold */
+	new_dep = rzalloc(RZONE_RUNTIME, SOF_MEM_CAPS_RAM, sizeof(*new_dep));
+	if (new_dep == NULL) {
+		trace_pipe_error("eSd");
+		return -ENOMEM;
+	}
+
+	new_dep->producer = producer;
+	new_dep->consumer = consumer;
+
+	spin_lock_irq(&sch->lock, flags);
+
+	/* dependency already known ? */
+	list_for_item(dlist, &sch->depend_list) {
+		dep = container_of(dlist, struct task_depend, list);
+		if (dep->consumer == consumer && dep->producer == producer)
+			goto out;
+	}
+
+	list_item_append(&new_dep->list, &sch->depend_list);
+	sch->depend_count++;
+	new_dep = NULL;
+
+out:
+	spin_unlock_irq(&sch->lock, flags);
+
+	/* free duplicate outside of the lock */
+	if (new_dep)
+		rfree(new_dep);
+
+	return 0;
+}
+
+/* Remove all dependencies on and by task */
+void schedule_task_depend_free(struct task *task)
+{
+	struct task_depend *dep;
+	struct list_item *dlist;
+	struct list_item *tlist;
+	struct list_item free_list;
+	uint32_t flags;
+
+	list_init(&free_list);
+
+	spin_lock_irq(&sch->lock, flags);
+
+	list_for_item_safe(dlist, tlist, &sch->depend_list) {
+		dep = container_of(dlist, struct task_depend, list);
+		if (dep->consumer == task || dep->producer == task) {
+			list_item_del(&dep->list);
+			list_item_append(&dep->list, &free_list);
+			sch->depend_count--;
+		}
+	}
+
+	spin_unlock_irq(&sch->lock, flags);
+
+	/* free outside of the lock */
+	list_for_item_safe(dlist, tlist, &free_list) {
+		dep = container_of(dlist, struct task_depend, list);
+		rfree(dep);
+	}
+}
+
 static void scheduler_run(void *unused)
 {
 	struct task *future_task;
@@ -371,6 +501,7 @@ int scheduler_init(struct sof *sof)
 
 	sch = rzalloc(RZONE_SYS, SOF_MEM_CAPS_RAM, sizeof(*sch));
 	list_init(&sch->list);
+	list_init(&sch->depend_list);
 	spinlock_init(&sch->lock);
 	sch->clock = PLATFORM_SCHED_CLOCK;
 	work_init(&sch->work, sch_work, sch, WORK_ASYNC);
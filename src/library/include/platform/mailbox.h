@@ -32,6 +32,7 @@
 #define __INCLUDE_PLATFORM_HOST_MAILBOX__
 
 #include <platform/memory.h>
+#include <stdint.h>
 
 #define MAILBOX_HOST_OFFSET	0x144000
 
@@ -69,4 +70,18 @@
 #define MAILBOX_TRACE_BASE \
 	(MAILBOX_BASE + MAILBOX_TRACE_OFFSET)
 
+/* host writes messages and reads replies in the inbox */
+#define MAILBOX_HOSTBOX_SIZE	MAILBOX_INBOX_SIZE
+#define MAILBOX_HOSTBOX_BASE	MAILBOX_INBOX_BASE
+#define MAILBOX_HOSTBOX_OFFSET	MAILBOX_INBOX_OFFSET
+
+/* DSP initiated messages are written to the outbox */
+#define MAILBOX_DSPBOX_SIZE	MAILBOX_OUTBOX_SIZE
+#define MAILBOX_DSPBOX_BASE	MAILBOX_OUTBOX_BASE
+#define MAILBOX_DSPBOX_OFFSET	MAILBOX_OUTBOX_OFFSET
+
+/* total size of the host mailbox */
+#define MAILBOX_SIZE \
+	(MAILBOX_TRACE_SIZE + MAILBOX_TRACE_OFFSET)
+
 #endif
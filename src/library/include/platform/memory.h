@@ -32,6 +32,7 @@
 #define __PLATFORM_HOST_MEMORY_H__
 
 #include <config.h>
+#include <stdint.h>
 
 #if CONFIG_HT_BAYTRAIL
 #include <baytrail/include/platform/memory.h>
@@ -87,8 +88,8 @@
 
 #endif
 
-#define MAILBOX_DSPBOX_BASE	0
-#define MAILBOX_HOSTBOX_BASE	0
-#define MAILBOX_BASE		0
+/* mailbox is host memory, provided by the host IPC transport */
+extern uint8_t *host_mailbox;
+#define MAILBOX_BASE		((uintptr_t)host_mailbox)
 
 #endif
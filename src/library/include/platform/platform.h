@@ -50,6 +50,9 @@
 /* IPC page data copy timeout */
 #define PLATFORM_IPC_DMA_TIMEOUT 2000
 
+struct timer;
+extern struct timer *platform_timer;
+
 static inline void platform_panic(uint32_t p) {}
 
 #endif
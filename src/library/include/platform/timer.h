@@ -39,6 +39,8 @@
 struct comp_dev;
 struct sof_ipc_stream_posn;
 
+void platform_timer_stop(struct timer *timer);
+
 /* get timestamp for host stream DMA position */
 static inline void platform_host_timestamp(struct comp_dev *host,
 	struct sof_ipc_stream_posn *posn) {}
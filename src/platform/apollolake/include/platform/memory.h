@@ -193,6 +193,9 @@
 #define HP_SRAM_BASE		0xBE000000
 #define HP_SRAM_SIZE		0x00080000
 
+/* HP SRAM is made of 64kB banks that can be accessed in parallel */
+#define SRAM_BANK_SIZE		0x10000
+
 /* HP SRAM Heap */
 #define HEAP_HP_BUFFER_BASE	HP_SRAM_BASE
 #define HEAP_HP_BUFFER_SIZE	0x8000
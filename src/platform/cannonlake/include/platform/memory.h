@@ -165,6 +165,9 @@
 #define HP_SRAM_BASE		0xBE000000
 #define HP_SRAM_SIZE		0x002F0000
 
+/* HP SRAM is made of 64kB banks that can be accessed in parallel */
+#define SRAM_BANK_SIZE		0x10000
+
 /* HP SRAM Base */
 #define HP_SRAM_VECBASE_RESET	(HP_SRAM_BASE + 0x40000)
 
@@ -39,23 +39,36 @@ static struct block_hdr mod_block256[HEAP_RT_COUNT256];
 static struct block_hdr mod_block512[HEAP_RT_COUNT512];
 static struct block_hdr mod_block1024[HEAP_RT_COUNT1024];
 
+/* Free block bitmaps for modules */
+static uint32_t mod_bitmap16[BLOCK_MAP_WORDS(HEAP_RT_COUNT16)];
+static uint32_t mod_bitmap32[BLOCK_MAP_WORDS(HEAP_RT_COUNT32)];
+static uint32_t mod_bitmap64[BLOCK_MAP_WORDS(HEAP_RT_COUNT64)];
+static uint32_t mod_bitmap128[BLOCK_MAP_WORDS(HEAP_RT_COUNT128)];
+static uint32_t mod_bitmap256[BLOCK_MAP_WORDS(HEAP_RT_COUNT256)];
+static uint32_t mod_bitmap512[BLOCK_MAP_WORDS(HEAP_RT_COUNT512)];
+static uint32_t mod_bitmap1024[BLOCK_MAP_WORDS(HEAP_RT_COUNT1024)];
+
 /* Heap memory map for modules */
 static struct block_map rt_heap_map[] = {
-	BLOCK_DEF(16, HEAP_RT_COUNT16, mod_block16),
-	BLOCK_DEF(32, HEAP_RT_COUNT32, mod_block32),
-	BLOCK_DEF(64, HEAP_RT_COUNT64, mod_block64),
-	BLOCK_DEF(128, HEAP_RT_COUNT128, mod_block128),
-	BLOCK_DEF(256, HEAP_RT_COUNT256, mod_block256),
-	BLOCK_DEF(512, HEAP_RT_COUNT512, mod_block512),
-	BLOCK_DEF(1024, HEAP_RT_COUNT1024, mod_block1024),
+	BLOCK_DEF(16, HEAP_RT_COUNT16, mod_block16, mod_bitmap16),
+	BLOCK_DEF(32, HEAP_RT_COUNT32, mod_block32, mod_bitmap32),
+	BLOCK_DEF(64, HEAP_RT_COUNT64, mod_block64, mod_bitmap64),
+	BLOCK_DEF(128, HEAP_RT_COUNT128, mod_block128, mod_bitmap128),
+	BLOCK_DEF(256, HEAP_RT_COUNT256, mod_block256, mod_bitmap256),
+	BLOCK_DEF(512, HEAP_RT_COUNT512, mod_block512, mod_bitmap512),
+	BLOCK_DEF(1024, HEAP_RT_COUNT1024, mod_block1024, mod_bitmap1024),
 };
 
 /* Heap blocks for buffers */
 static struct block_hdr buf_block[HEAP_BUFFER_COUNT];
 
+/* Free block bitmaps for buffers */
+static uint32_t buf_bitmap[BLOCK_MAP_WORDS(HEAP_BUFFER_COUNT)];
+
 /* Heap memory map for buffers */
 static struct block_map buf_heap_map[] = {
-	BLOCK_DEF(HEAP_BUFFER_BLOCK_SIZE, HEAP_BUFFER_COUNT, buf_block),
+	BLOCK_DEF(HEAP_BUFFER_BLOCK_SIZE, HEAP_BUFFER_COUNT, buf_block,
+		buf_bitmap),
 };
 
 struct mm memmap = {
@@ -39,6 +39,9 @@
 #include <math.h>
 #include <cmocka.h>
 
+/* buffers are not connected to real components in these tests */
+static struct comp_dev test_dev;
+
 static void test_audio_buffer_copy_underrun(void **state)
 {
 	(void)state;
@@ -52,6 +55,10 @@ static void test_audio_buffer_copy_underrun(void **state)
 
 	assert_non_null(src);
 	assert_non_null(snk);
+	src->source = &test_dev;
+	src->sink = &test_dev;
+	snk->source = &test_dev;
+	snk->sink = &test_dev;
 
 	comp_update_buffer_produce(src, 10);
 
@@ -75,6 +82,10 @@ static void test_audio_buffer_copy_overrun(void **state)
 
 	assert_non_null(src);
 	assert_non_null(snk);
+	src->source = &test_dev;
+	src->sink = &test_dev;
+	snk->source = &test_dev;
+	snk->sink = &test_dev;
 
 	comp_update_buffer_produce(src, 16);
 	comp_update_buffer_produce(snk, 246);
@@ -100,6 +111,10 @@ static void test_audio_buffer_copy_success(void **state)
 
 	assert_non_null(src);
 	assert_non_null(snk);
+	src->source = &test_dev;
+	src->sink = &test_dev;
+	snk->source = &test_dev;
+	snk->sink = &test_dev;
 
 	comp_update_buffer_produce(src, 10);
 
@@ -123,6 +138,10 @@ static void test_audio_buffer_copy_fit_space_constraint(void **state)
 
 	assert_non_null(src);
 	assert_non_null(snk);
+	src->source = &test_dev;
+	src->sink = &test_dev;
+	snk->source = &test_dev;
+	snk->sink = &test_dev;
 
 	comp_update_buffer_produce(src, 16);
 	comp_update_buffer_produce(snk, 246);
@@ -148,6 +167,10 @@ static void test_audio_buffer_copy_fit_no_space_constraint(void **state)
 
 	assert_non_null(src);
 	assert_non_null(snk);
+	src->source = &test_dev;
+	src->sink = &test_dev;
+	snk->source = &test_dev;
+	snk->sink = &test_dev;
 
 	comp_update_buffer_produce(src, 16);
 
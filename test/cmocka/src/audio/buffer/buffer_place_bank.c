@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/ipc.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+/* buffers are not connected to real components in these tests */
+static struct comp_dev test_dev;
+
+static void test_audio_buffer_place_bank_wrap(void **state)
+{
+	(void)state;
+
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = 10
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	assert_non_null(buf);
+	buf->source = &test_dev;
+	buf->sink = &test_dev;
+
+	/* buffer always shares its own banks, so it is moved if the
+	 * platform has SRAM banks
+	 */
+	assert_int_equal(buffer_place_bank(buf, buf), 0);
+
+	assert_non_null(buf->addr);
+	assert_ptr_equal(buf->end_addr, buf->addr + 10);
+	assert_ptr_equal(buf->r_ptr, buf->addr);
+	assert_ptr_equal(buf->w_ptr, buf->addr);
+	assert_int_equal(buf->avail, 0);
+	assert_int_equal(buf->free, 10);
+
+	uint8_t bytes[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+	memcpy(buf->w_ptr, &bytes, 8);
+	comp_update_buffer_produce(buf, 8);
+	comp_update_buffer_consume(buf, 8);
+
+	assert_int_equal(buf->avail, 0);
+	assert_int_equal(buf->free, 10);
+
+	uint8_t more_bytes[4] = {8, 9, 10, 11};
+
+	/* write across the end of the buffer */
+	memcpy(buf->w_ptr, &more_bytes, 2);
+	memcpy(buf->addr, &more_bytes[2], 2);
+	comp_update_buffer_produce(buf, 4);
+
+	uint8_t ref[10] = {10, 11, 2, 3, 4, 5, 6, 7, 8, 9};
+
+	assert_int_equal(buf->avail, 4);
+	assert_int_equal(buf->free, 6);
+	assert_ptr_equal(buf->w_ptr, buf->addr + 2);
+	assert_ptr_equal(buf->r_ptr, buf->addr + 8);
+	assert_int_equal(memcmp(buf->addr, &ref, 10), 0);
+
+	comp_update_buffer_consume(buf, 4);
+
+	assert_int_equal(buf->avail, 0);
+	assert_ptr_equal(buf->r_ptr, buf->w_ptr);
+
+	buffer_free(buf);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_buffer_place_bank_wrap)
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -39,6 +39,9 @@
 #include <math.h>
 #include <cmocka.h>
 
+/* buffers are not connected to real components in these tests */
+static struct comp_dev test_dev;
+
 static void test_audio_buffer_write_10_bytes_out_of_256_and_read_back
 	(void **state)
 {
@@ -51,6 +54,8 @@ static void test_audio_buffer_write_10_bytes_out_of_256_and_read_back
 	struct comp_buffer *buf = buffer_new(&test_buf_desc);
 
 	assert_non_null(buf);
+	buf->source = &test_dev;
+	buf->sink = &test_dev;
 	assert_int_equal(buf->avail, 0);
 	assert_int_equal(buf->free, 256);
 	assert_ptr_equal(buf->w_ptr, buf->r_ptr);
@@ -86,6 +91,8 @@ static void test_audio_buffer_fill_10_bytes(void **state)
 	struct comp_buffer *buf = buffer_new(&test_buf_desc);
 
 	assert_non_null(buf);
+	buf->source = &test_dev;
+	buf->sink = &test_dev;
 	assert_int_equal(buf->avail, 0);
 	assert_int_equal(buf->free, 10);
 	assert_ptr_equal(buf->w_ptr, buf->r_ptr);
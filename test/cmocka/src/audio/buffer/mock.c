@@ -46,15 +46,31 @@ void *rzalloc(int zone, uint32_t caps, size_t bytes)
 	(void)zone;
 	(void)caps;
 
-	return malloc(bytes);
+	return calloc(1, bytes);
 }
 
 void *rballoc(int zone, uint32_t caps, size_t bytes)
 {
+	void *ptr;
+
 	(void)zone;
 	(void)caps;
 
-	return malloc(bytes);
+	/* buffers are cache line aligned like on the DSP */
+	if (posix_memalign(&ptr, 64, bytes))
+		return NULL;
+
+	return ptr;
+}
+
+/* host memory has no SRAM banks, any placement will do */
+void *rballoc_bank(int zone, uint32_t caps, size_t bytes, void *avoid,
+	size_t avoid_bytes)
+{
+	(void)avoid;
+	(void)avoid_bytes;
+
+	return rballoc(zone, caps, bytes);
 }
 
 void rfree(void *ptr)
@@ -0,0 +1,725 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Kernel A/B test. Every implementation of a kernel processes the same
+ * random and edge case vectors, the output is checked against the first
+ * implementation of the kernel, the reference, and the processing time of
+ * each implementation is reported. The reference is the generic C kernel
+ * built into the test for kernels with target optimised variants, or a
+ * model of the kernel arithmetic otherwise. Host builds configured with
+ * --with-hifi-emu test the HiFi kernels with emulated intrinsics.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include "volume.h"
+#include "src_config.h"
+#include "src.h"
+#include "fir.h"
+#include "iir.h"
+#include "mixer.h"
+#include "kernel_ref.h"
+
+#if SRC_SHORT
+#include <sof/audio/coefficients/src/src_tiny_int16_2_1_3281_5000.h>
+#include <sof/audio/coefficients/src/src_tiny_int16_3_2_3281_5000.h>
+#define SRC_STAGE_2_1	(&src_int16_2_1_3281_5000)
+#define SRC_STAGE_3_2	(&src_int16_3_2_3281_5000)
+#else
+#include <sof/audio/coefficients/src/src_std_int32_2_1_4583_5000.h>
+#include <sof/audio/coefficients/src/src_std_int32_3_2_4583_5000.h>
+#define SRC_STAGE_2_1	(&src_int32_2_1_4583_5000)
+#define SRC_STAGE_3_2	(&src_int32_3_2_4583_5000)
+#endif
+
+#define KERNEL_FRAMES		480	/* 10 ms at 48 kHz */
+#define KERNEL_CHANNELS		2
+#define KERNEL_SAMPLES		(KERNEL_FRAMES * KERNEL_CHANNELS)
+#define KERNEL_MAX_SOURCES	4
+#define KERNEL_MAX_IMPL		4
+#define KERNEL_MAX_OUT		(3 * KERNEL_SAMPLES)	/* SRC up to 1:3 */
+#define KERNEL_REPEAT		200	/* runs of the speed measurement */
+#define KERNEL_SEED		0x5eed1234
+
+#define FIR_TAPS		48
+#define IIR_BIQUADS		2
+
+struct kernel_case;
+
+/* implementation of a kernel */
+struct kernel_impl {
+	const char *name;
+	void (*run)(const struct kernel_case *kc, void *in, void *out);
+};
+
+/* kernel configuration, the first implementation is the reference */
+struct kernel_case {
+	const char *name;
+	struct kernel_impl impl[KERNEL_MAX_IMPL];
+	int32_t tolerance;		/* max abs error as Q1.31 */
+	uint32_t source_format;
+	uint32_t sink_format;
+	uint32_t volume;		/* volume */
+	struct src_stage *stage;	/* SRC */
+	int shift;			/* FIR output shift */
+	int sources;			/* mixer */
+};
+
+/* test vectors */
+enum kernel_vector {
+	VEC_RANDOM = 0,
+	VEC_MAX,
+	VEC_MIN,
+	VEC_ALTERNATE,
+	VEC_IMPULSE,
+	VEC_SMALL,
+	VEC_ZERO,
+	VEC_COUNT,
+};
+
+static const char * const vector_name[VEC_COUNT] = {
+	"random", "max", "min", "alternate", "impulse", "small", "zero",
+};
+
+static uint32_t rand_state;
+
+static int32_t rand32(void)
+{
+	/* xorshift32 */
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return (int32_t)rand_state;
+}
+
+/* fill n full scale Q1.31 samples */
+static void vector_fill(int32_t *x, int n, int type, uint32_t seed)
+{
+	int i;
+
+	rand_state = seed;
+
+	for (i = 0; i < n; i++) {
+		switch (type) {
+		case VEC_RANDOM:
+			x[i] = rand32();
+			break;
+		case VEC_MAX:
+			x[i] = INT32_MAX;
+			break;
+		case VEC_MIN:
+			x[i] = INT32_MIN;
+			break;
+		case VEC_ALTERNATE:
+			x[i] = (i / KERNEL_CHANNELS) & 1 ? INT32_MIN : INT32_MAX;
+			break;
+		case VEC_IMPULSE:
+			x[i] = i < KERNEL_CHANNELS ? INT32_MAX : 0;
+			break;
+		case VEC_SMALL:
+			x[i] = (rand32() % 3) - 1;
+			break;
+		default:
+			x[i] = 0;
+			break;
+		}
+	}
+}
+
+static int format_bytes(uint32_t format)
+{
+	return format == SOF_IPC_FRAME_S16_LE ? sizeof(int16_t) :
+		sizeof(int32_t);
+}
+
+/* store Q1.31 samples in the buffer format */
+static void format_store(void *buf, const int32_t *x, int n, uint32_t format)
+{
+	int16_t *x16 = buf;
+	int32_t *x32 = buf;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		switch (format) {
+		case SOF_IPC_FRAME_S16_LE:
+			x16[i] = x[i] >> 16;
+			break;
+		case SOF_IPC_FRAME_S24_4LE:
+			x32[i] = x[i] >> 8;
+			break;
+		default:
+			x32[i] = x[i];
+			break;
+		}
+	}
+}
+
+/* s24 samples are compared as 24 bit, the container MSBs are not used */
+static int32_t format_get(const void *buf, int i, uint32_t format)
+{
+	switch (format) {
+	case SOF_IPC_FRAME_S16_LE:
+		return ((const int16_t *)buf)[i];
+	case SOF_IPC_FRAME_S24_4LE:
+		return (int32_t)((uint32_t)((const int32_t *)buf)[i] << 8) >> 8;
+	default:
+		return ((const int32_t *)buf)[i];
+	}
+}
+
+/* Q1.31 tolerance in LSBs of the format */
+static int32_t format_tolerance(int32_t tolerance, uint32_t format)
+{
+	switch (format) {
+	case SOF_IPC_FRAME_S16_LE:
+		return tolerance >> 16;
+	case SOF_IPC_FRAME_S24_4LE:
+		return tolerance >> 8;
+	default:
+		return tolerance;
+	}
+}
+
+/* volume */
+
+static void vol_run(const struct kernel_case *kc, void *in, void *out,
+		    scale_vol (*get_func)(struct comp_dev *dev))
+{
+	struct comp_dev *dev;
+	struct comp_data *cd;
+	struct comp_buffer source;
+	struct comp_buffer sink;
+	scale_vol func;
+	int i;
+
+	dev = test_calloc(1, COMP_SIZE(struct sof_ipc_comp_volume));
+	cd = test_calloc(1, sizeof(*cd));
+	comp_set_drvdata(dev, cd);
+	dev->frames = KERNEL_FRAMES;
+	dev->params.channels = KERNEL_CHANNELS;
+	cd->source_format = kc->source_format;
+	cd->sink_format = kc->sink_format;
+	for (i = 0; i < KERNEL_CHANNELS; i++)
+		cd->volume[i] = kc->volume;
+
+	memset(&source, 0, sizeof(source));
+	source.r_ptr = in;
+	source.size = KERNEL_SAMPLES * format_bytes(kc->source_format);
+	memset(&sink, 0, sizeof(sink));
+	sink.w_ptr = out;
+	sink.size = KERNEL_SAMPLES * format_bytes(kc->sink_format);
+
+	func = get_func(dev);
+	assert_non_null(func);
+	func(dev, &sink, &source);
+
+	test_free(cd);
+	test_free(dev);
+}
+
+static void vol_ref(const struct kernel_case *kc, void *in, void *out)
+{
+	vol_run(kc, in, out, vol_ref_get_processing_function);
+}
+
+#if !defined(CONFIG_GENERIC)
+static void vol_target(const struct kernel_case *kc, void *in, void *out)
+{
+	vol_run(kc, in, out, vol_get_processing_function);
+}
+#endif
+
+/* SRC */
+
+static int src_times(const struct kernel_case *kc)
+{
+	return KERNEL_FRAMES / kc->stage->blk_in;
+}
+
+static void src_run(const struct kernel_case *kc, void *in, void *out,
+		    void (*func)(struct src_stage_prm *s))
+{
+	struct src_stage *st = kc->stage;
+	struct src_stage_prm prm;
+	struct src_state state;
+	int n_in = src_times(kc) * st->blk_in * KERNEL_CHANNELS;
+	int n_out = src_times(kc) * st->blk_out * KERNEL_CHANNELS;
+
+	/* delay lines as set up by src_polyphase_init() */
+	state.fir_delay_size = KERNEL_CHANNELS * (st->subfilter_length +
+		(st->num_of_subfilters - 1) * st->idm + st->blk_in);
+	state.out_delay_size = KERNEL_CHANNELS *
+		(1 + (st->num_of_subfilters - 1) * st->odm);
+	state.fir_delay = test_calloc(state.fir_delay_size, sizeof(int32_t));
+	state.out_delay = test_calloc(state.out_delay_size, sizeof(int32_t));
+	state.fir_wp = &state.fir_delay[state.fir_delay_size - 1];
+	state.out_rp = state.out_delay;
+
+	prm.nch = KERNEL_CHANNELS;
+	prm.times = src_times(kc);
+	prm.x_rptr = in;
+	prm.x_end_addr = (int32_t *)in + n_in;
+	prm.x_size = n_in * sizeof(int32_t);
+	prm.y_wptr = out;
+	prm.y_addr = out;
+	prm.y_end_addr = (int32_t *)out + n_out;
+	prm.y_size = n_out * sizeof(int32_t);
+	prm.state = &state;
+	prm.stage = st;
+
+	func(&prm);
+
+	test_free(state.fir_delay);
+	test_free(state.out_delay);
+}
+
+static void src_ref(const struct kernel_case *kc, void *in, void *out)
+{
+	if (kc->source_format == SOF_IPC_FRAME_S24_4LE)
+		src_run(kc, in, out, src_ref_polyphase_stage_cir_s24);
+	else
+		src_run(kc, in, out, src_ref_polyphase_stage_cir);
+}
+
+#if !SRC_GENERIC
+static void src_target(const struct kernel_case *kc, void *in, void *out)
+{
+	if (kc->source_format == SOF_IPC_FRAME_S24_4LE)
+		src_run(kc, in, out, src_polyphase_stage_cir_s24);
+	else
+		src_run(kc, in, out, src_polyphase_stage_cir);
+}
+#endif
+
+/* FIR */
+
+static int16_t fir_config[NHEADER_FIR_COEF_32x16 + FIR_TAPS];
+
+/* windowed sinc low pass, Q1.15 */
+static void fir_design(int shift)
+{
+	struct fir_coef_32x16 *setup = (struct fir_coef_32x16 *)fir_config;
+	int16_t *coef = &setup->coef;
+	double x;
+	double w;
+	int i;
+
+	setup->length = FIR_TAPS;
+	setup->in_shift = 0;
+	setup->out_shift = shift;
+	for (i = 0; i < FIR_TAPS; i++) {
+		x = i - (FIR_TAPS - 1) / 2.0;
+		w = 0.54 - 0.46 * cos(2 * M_PI * i / (FIR_TAPS - 1));
+		coef[i] = (int16_t)lround(32767 * 0.4 * w *
+					  (x ? sin(M_PI * 0.4 * x) /
+					   (M_PI * 0.4 * x) : 1));
+	}
+}
+
+static void fir_model(const struct kernel_case *kc, void *in, void *out)
+{
+	struct fir_coef_32x16 *setup = (struct fir_coef_32x16 *)fir_config;
+	int16_t *coef = &setup->coef;
+	int32_t *x = in;
+	int32_t *y = out;
+	int64_t acc;
+	int ch;
+	int i;
+	int k;
+
+	/* y(n) = sum c(k) x(n - k), Q1.15 x Q1.31 with Q17.47 sum */
+	for (ch = 0; ch < KERNEL_CHANNELS; ch++) {
+		for (i = 0; i < KERNEL_FRAMES; i++) {
+			acc = 0;
+			for (k = 0; k < FIR_TAPS && k <= i; k++)
+				acc += (int64_t)coef[k] *
+					(x[(i - k) * KERNEL_CHANNELS + ch] >>
+					 setup->in_shift);
+
+			y[i * KERNEL_CHANNELS + ch] =
+				sat_int32(acc >> (15 + setup->out_shift));
+		}
+	}
+}
+
+static void fir_target(const struct kernel_case *kc, void *in, void *out)
+{
+	struct fir_state_32x16 fir[KERNEL_CHANNELS];
+	int32_t *delay = test_calloc(KERNEL_CHANNELS * FIR_TAPS,
+				     sizeof(int32_t));
+	int32_t *dp = delay;
+	int32_t *x = in;
+	int32_t *y = out;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < KERNEL_CHANNELS; ch++) {
+		assert_int_equal(fir_init_coef(&fir[ch], fir_config), FIR_TAPS);
+		fir_init_delay(&fir[ch], &dp);
+	}
+
+	for (i = 0; i < KERNEL_SAMPLES; i++)
+		y[i] = fir_32x16(&fir[i % KERNEL_CHANNELS], x[i]);
+
+	test_free(delay);
+}
+
+/* IIR */
+
+static int32_t iir_config[NHEADER_DF2T + IIR_BIQUADS * NBIQUAD_DF2T];
+
+/* Butterworth low pass biquads in series, Q2.30 */
+static void iir_design(void)
+{
+	struct iir_header_df2t *hdr = (struct iir_header_df2t *)iir_config;
+	struct iir_biquad_df2t *bq;
+	double k = tan(M_PI * 0.1);
+	double norm = 1 / (1 + M_SQRT2 * k + k * k);
+	double one = 1 << 30;
+	int i;
+
+	hdr->num_sections = IIR_BIQUADS;
+	hdr->num_sections_in_series = IIR_BIQUADS;
+	for (i = 0; i < IIR_BIQUADS; i++) {
+		bq = (struct iir_biquad_df2t *)&iir_config[NHEADER_DF2T +
+							   i * NBIQUAD_DF2T];
+		bq->b0 = lround(one * k * k * norm);
+		bq->b1 = 2 * bq->b0;
+		bq->b2 = bq->b0;
+		/* feedback coefficients are stored negated */
+		bq->a1 = lround(-one * 2 * (k * k - 1) * norm);
+		bq->a2 = lround(-one * (1 - M_SQRT2 * k + k * k) * norm);
+		bq->output_shift = 0;
+		bq->output_gain = 1 << 14;
+	}
+}
+
+static double sat_double(double x)
+{
+	if (x > INT32_MAX)
+		return INT32_MAX;
+	if (x < INT32_MIN)
+		return INT32_MIN;
+	return x;
+}
+
+/* input is attenuated 6 dB in both for filter overshoot headroom */
+static void iir_model(const struct kernel_case *kc, void *in, void *out)
+{
+	struct iir_biquad_df2t *bq;
+	double s[IIR_BIQUADS][2];
+	double one = 1 << 30;
+	double v;
+	double t;
+	int32_t *x = in;
+	int32_t *y = out;
+	int ch;
+	int i;
+	int j;
+
+	for (ch = 0; ch < KERNEL_CHANNELS; ch++) {
+		memset(s, 0, sizeof(s));
+		for (i = ch; i < KERNEL_SAMPLES; i += KERNEL_CHANNELS) {
+			v = x[i] >> 1;
+			for (j = 0; j < IIR_BIQUADS; j++) {
+				bq = (struct iir_biquad_df2t *)
+					&iir_config[NHEADER_DF2T +
+						    j * NBIQUAD_DF2T];
+				t = bq->b0 / one * v + s[j][0];
+				s[j][0] = s[j][1] + bq->b1 / one * v +
+					bq->a1 / one * t;
+				s[j][1] = bq->b2 / one * v + bq->a2 / one * t;
+				v = sat_double(t * bq->output_gain / (1 << 14) /
+					       (1 << bq->output_shift));
+			}
+			y[i] = lround(v);
+		}
+	}
+}
+
+static void iir_target(const struct kernel_case *kc, void *in, void *out)
+{
+	struct iir_state_df2t iir[KERNEL_CHANNELS];
+	int64_t *delay = test_calloc(KERNEL_CHANNELS * 2 * IIR_BIQUADS,
+				     sizeof(int64_t));
+	int64_t *dp = delay;
+	int32_t *x = in;
+	int32_t *y = out;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < KERNEL_CHANNELS; ch++) {
+		assert_true(iir_init_coef_df2t(&iir[ch], iir_config) > 0);
+		iir_init_delay_df2t(&iir[ch], &dp);
+	}
+
+	for (i = 0; i < KERNEL_SAMPLES; i++)
+		y[i] = iir_df2t(&iir[i % KERNEL_CHANNELS], x[i] >> 1);
+
+	test_free(delay);
+}
+
+/* mixer, the sources are back to back in the input */
+
+static void mix_model(const struct kernel_case *kc, void *in, void *out)
+{
+	int32_t *x = in;
+	int32_t *y = out;
+	int64_t acc;
+	int i;
+	int j;
+
+	for (i = 0; i < KERNEL_SAMPLES; i++) {
+		acc = 0;
+		for (j = 0; j < kc->sources; j++)
+			acc += x[j * KERNEL_SAMPLES + i];
+
+		y[i] = acc >> (kc->sources >> 1);
+	}
+}
+
+static void mix_target(const struct kernel_case *kc, void *in, void *out)
+{
+	struct comp_buffer source[KERNEL_MAX_SOURCES];
+	struct comp_buffer *sources[KERNEL_MAX_SOURCES];
+	struct comp_buffer sink;
+	struct comp_dev dev;
+	int j;
+
+	memset(&dev, 0, sizeof(dev));
+	dev.params.channels = KERNEL_CHANNELS;
+	memset(&sink, 0, sizeof(sink));
+	sink.w_ptr = out;
+	for (j = 0; j < kc->sources; j++) {
+		memset(&source[j], 0, sizeof(source[j]));
+		source[j].r_ptr = (int32_t *)in + j * KERNEL_SAMPLES;
+		sources[j] = &source[j];
+	}
+
+	mix_n(&dev, &sink, sources, kc->sources, KERNEL_FRAMES);
+}
+
+/* the generic volume and SRC builds are the reference code, so those cases
+ * only have something to compare with an optimised kernel built in
+ */
+#if defined(CONFIG_GENERIC)
+#define VOL_IMPL {{"generic", vol_ref}}
+#else
+#define VOL_IMPL {{"generic", vol_ref}, {"target", vol_target}}
+#endif
+#if SRC_GENERIC
+#define SRC_IMPL {{"generic", src_ref}}
+#else
+#define SRC_IMPL {{"generic", src_ref}, {"target", src_target}}
+#endif
+#define FIR_IMPL {{"model", fir_model}, {"generic", fir_target}}
+#define IIR_IMPL {{"model", iir_model}, {"generic", iir_target}}
+#define MIX_IMPL {{"model", mix_model}, {"generic", mix_target}}
+
+/* HiFi3 volume scales the gain to Q1.31 by INT32_MAX / VOL_MAX that is
+ * 2^-15 less than unity.
+ */
+#define VOL_TOLERANCE	(1 << 16)
+
+#define VOL_CASE(name, src, sink, vol) \
+	{name, VOL_IMPL, VOL_TOLERANCE, SOF_IPC_FRAME_##src, \
+		SOF_IPC_FRAME_##sink, vol}
+
+/* HiFi SRC with 32 bit coefficients or HiFi EP SRC filters with 24 bits of
+ * the data.
+ */
+#define SRC_TOLERANCE	(1 << 10)
+
+static struct kernel_case cases[] = {
+	VOL_CASE("vol s16 s16", S16_LE, S16_LE, VOL_MAX),
+	VOL_CASE("vol s16 s16 -9.5dB", S16_LE, S16_LE, VOL_MAX / 3),
+	VOL_CASE("vol s16 s24", S16_LE, S24_4LE, VOL_MAX / 3),
+	VOL_CASE("vol s16 s32", S16_LE, S32_LE, VOL_MAX / 3),
+	VOL_CASE("vol s24 s16", S24_4LE, S16_LE, VOL_MAX / 3),
+	VOL_CASE("vol s24 s24", S24_4LE, S24_4LE, VOL_MAX),
+	VOL_CASE("vol s24 s24 -9.5dB", S24_4LE, S24_4LE, VOL_MAX / 3),
+	VOL_CASE("vol s24 s32", S24_4LE, S32_LE, VOL_MAX / 3),
+	VOL_CASE("vol s32 s16", S32_LE, S16_LE, VOL_MAX / 3),
+	VOL_CASE("vol s32 s24", S32_LE, S24_4LE, VOL_MAX / 3),
+	VOL_CASE("vol s32 s32", S32_LE, S32_LE, VOL_MAX),
+	VOL_CASE("vol s32 s32 -9.5dB", S32_LE, S32_LE, VOL_MAX / 3),
+
+	{"src 2:1 s32", SRC_IMPL, SRC_TOLERANCE, SOF_IPC_FRAME_S32_LE,
+		SOF_IPC_FRAME_S32_LE, 0, SRC_STAGE_2_1},
+	{"src 3:2 s32", SRC_IMPL, SRC_TOLERANCE, SOF_IPC_FRAME_S32_LE,
+		SOF_IPC_FRAME_S32_LE, 0, SRC_STAGE_3_2},
+	{"src 3:2 s24", SRC_IMPL, SRC_TOLERANCE, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S24_4LE, 0, SRC_STAGE_3_2},
+
+	{"fir s32", FIR_IMPL, 0, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE,
+		0, NULL, 0},
+	{"fir s32 shift", FIR_IMPL, 0, SOF_IPC_FRAME_S32_LE,
+		SOF_IPC_FRAME_S32_LE, 0, NULL, 2},
+
+	/* double precision model, rounding noise through the feedback */
+	{"iir s32", IIR_IMPL, 4, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE},
+
+	{"mix 2 s32", MIX_IMPL, 0, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE,
+		0, NULL, 0, 2},
+	{"mix 3 s32", MIX_IMPL, 0, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE,
+		0, NULL, 0, 3},
+	{"mix 4 s32", MIX_IMPL, 0, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE,
+		0, NULL, 0, 4},
+};
+
+static int kernel_out_samples(const struct kernel_case *kc)
+{
+	if (kc->stage)
+		return src_times(kc) * kc->stage->blk_out * KERNEL_CHANNELS;
+
+	return KERNEL_SAMPLES;
+}
+
+static int kernel_num_impl(const struct kernel_case *kc)
+{
+	int n = 0;
+
+	while (n < KERNEL_MAX_IMPL && kc->impl[n].run)
+		n++;
+
+	return n;
+}
+
+static int setup(void **state)
+{
+	struct kernel_case *kc = *state;
+
+	if (kc->impl[0].run == fir_model)
+		fir_design(kc->shift);
+	else if (kc->impl[0].run == iir_model)
+		iir_design();
+
+	return 0;
+}
+
+/* report time per frame of each implementation for the random vector */
+static void kernel_speed(const struct kernel_case *kc, void *in, void *out)
+{
+	clock_t start;
+	double ns;
+	int i;
+	int n;
+
+	for (i = 0; i < kernel_num_impl(kc); i++) {
+		start = clock();
+		for (n = 0; n < KERNEL_REPEAT; n++)
+			kc->impl[i].run(kc, in, out);
+
+		ns = 1e9 * (clock() - start) / CLOCKS_PER_SEC /
+			(KERNEL_REPEAT * KERNEL_FRAMES);
+		printf("# %-20s %-8s %8.2f ns/frame %8.2f Mframes/s\n",
+		       kc->name, kc->impl[i].name, ns, ns > 0 ? 1e3 / ns : 0);
+	}
+}
+
+static void test_kernel(void **state)
+{
+	struct kernel_case *kc = *state;
+	int num_impl = kernel_num_impl(kc);
+	int n_out = kernel_out_samples(kc);
+	int32_t x[KERNEL_MAX_SOURCES * KERNEL_SAMPLES];
+	int32_t in[KERNEL_MAX_SOURCES * KERNEL_SAMPLES];
+	int32_t out[KERNEL_MAX_IMPL][KERNEL_MAX_OUT];
+	int32_t tolerance = format_tolerance(kc->tolerance, kc->sink_format);
+	int32_t ref;
+	int32_t val;
+	int64_t err;
+	int vec;
+	int i;
+	int j;
+
+	if (num_impl < 2) {
+		printf("# %s: no optimised kernel built\n", kc->name);
+		skip();
+	}
+
+	for (vec = 0; vec < VEC_COUNT; vec++) {
+		/* each mixer source gets its own random vector */
+		for (j = 0; j < KERNEL_MAX_SOURCES; j++)
+			vector_fill(&x[j * KERNEL_SAMPLES], KERNEL_SAMPLES,
+				    vec, KERNEL_SEED + j);
+		format_store(in, x, KERNEL_MAX_SOURCES * KERNEL_SAMPLES,
+			     kc->source_format);
+
+		memset(out, 0, sizeof(out));
+		for (i = 0; i < num_impl; i++)
+			kc->impl[i].run(kc, in, out[i]);
+
+		for (i = 1; i < num_impl; i++) {
+			for (j = 0; j < n_out; j++) {
+				ref = format_get(out[0], j, kc->sink_format);
+				val = format_get(out[i], j, kc->sink_format);
+				err = (int64_t)val - ref;
+				if (err > tolerance || -err > tolerance)
+					fail_msg("%s %s %s sample %d: %d, %s %d",
+						 kc->name, kc->impl[i].name,
+						 vector_name[vec], j, val,
+						 kc->impl[0].name, ref);
+			}
+		}
+	}
+
+	vector_fill(x, KERNEL_MAX_SOURCES * KERNEL_SAMPLES, VEC_RANDOM,
+		    KERNEL_SEED);
+	format_store(in, x, KERNEL_MAX_SOURCES * KERNEL_SAMPLES,
+		     kc->source_format);
+	kernel_speed(kc, in, out[0]);
+}
+
+int main(void)
+{
+	struct CMUnitTest tests[ARRAY_SIZE(cases)];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cases); i++) {
+		tests[i].name = cases[i].name;
+		tests[i].test_func = test_kernel;
+		tests[i].setup_func = setup;
+		tests[i].teardown_func = NULL;
+		tests[i].initial_state = &cases[i];
+	}
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Builds the generic volume and SRC kernels whatever variant the target
+ * selects for libaudio. The kernel headers are included first so the
+ * variant selection can be overridden before the generic sources are
+ * included.
+ */
+
+#include "volume.h"
+#include "src_config.h"
+#include "kernel_ref.h"
+
+/* generic volume */
+#undef CONFIG_GENERIC
+#define CONFIG_GENERIC
+#define func_map vol_ref_func_map
+#define vol_get_processing_function vol_ref_get_processing_function
+#include "volume_generic.c"
+
+/* generic SRC */
+#undef SRC_GENERIC
+#undef SRC_HIFIEP
+#undef SRC_HIFI3
+#define SRC_GENERIC	1
+#define SRC_HIFIEP	0
+#define SRC_HIFI3	0
+#define src_polyphase_stage_cir src_ref_polyphase_stage_cir
+#define src_polyphase_stage_cir_s24 src_ref_polyphase_stage_cir_s24
+#include "src_generic.c"
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/bitmap.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+static void test_bitmap_next_set_when_start_at_bit_31_then_bit_31(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[2] = {0x80000001U, 0};
+
+	assert_int_equal(bitmap_next_set(bitmap, 64, 1), 31);
+	assert_int_equal(bitmap_next_set(bitmap, 64, 31), 31);
+}
+
+static void test_bitmap_next_set_when_set_in_next_word_then_found(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[2] = {0x1U, 0x10U};
+
+	assert_int_equal(bitmap_next_set(bitmap, 64, 1), 36);
+}
+
+static void test_bitmap_next_set_when_none_set_then_count(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[2] = {0x1U, 0};
+
+	assert_int_equal(bitmap_next_set(bitmap, 40, 1), 40);
+	assert_int_equal(bitmap_next_set(bitmap, 40, 40), 40);
+}
+
+static void test_bitmap_next_clear_when_clear_bit_31_then_bit_31(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[2] = {0x7fffffffU, 0xffffffffU};
+
+	assert_int_equal(bitmap_next_clear(bitmap, 64, 0), 31);
+}
+
+static void test_bitmap_next_clear_when_only_bits_past_count_clear_then_count(void **state)
+{
+	(void)state;
+
+	/* 40 bit map, all set, bits 40..63 are past the count */
+	uint32_t bitmap[2] = {0xffffffffU, 0xffU};
+
+	assert_int_equal(bitmap_next_clear(bitmap, 40, 0), 40);
+	assert_int_equal(bitmap_next_clear(bitmap, 40, 33), 40);
+}
+
+static void test_bitmap_next_clear_when_full_words_then_count(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[2] = {0xffffffffU, 0xffffffffU};
+
+	assert_int_equal(bitmap_next_clear(bitmap, 64, 5), 64);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_bitmap_next_set_when_start_at_bit_31_then_bit_31),
+		cmocka_unit_test(test_bitmap_next_set_when_set_in_next_word_then_found),
+		cmocka_unit_test(test_bitmap_next_set_when_none_set_then_count),
+		cmocka_unit_test(test_bitmap_next_clear_when_clear_bit_31_then_bit_31),
+		cmocka_unit_test(test_bitmap_next_clear_when_only_bits_past_count_clear_then_count),
+		cmocka_unit_test(test_bitmap_next_clear_when_full_words_then_count),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/bitmap.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+static void test_bitmap_update_when_set_31_bits_from_0_then_bit_31_clear(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[1] = {0};
+
+	bitmap_update(bitmap, 0, 31, 1);
+
+	assert_int_equal(bitmap[0], 0x7fffffffU);
+}
+
+static void test_bitmap_update_when_set_31_bits_from_1_then_bit_0_clear(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[1] = {0};
+
+	bitmap_update(bitmap, 1, 31, 1);
+
+	assert_int_equal(bitmap[0], 0xfffffffeU);
+}
+
+static void test_bitmap_update_when_set_bit_31_then_only_bit_31_set(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[1] = {0};
+
+	bitmap_update(bitmap, 31, 1, 1);
+
+	assert_int_equal(bitmap[0], 0x80000000U);
+}
+
+static void test_bitmap_update_when_set_32_bits_then_word_full(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[2] = {0, 0};
+
+	bitmap_update(bitmap, 0, 32, 1);
+
+	assert_int_equal(bitmap[0], 0xffffffffU);
+	assert_int_equal(bitmap[1], 0);
+}
+
+static void test_bitmap_update_when_set_across_words_then_both_words_set(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[3] = {0, 0, 0};
+
+	bitmap_update(bitmap, 30, 36, 1);
+
+	assert_int_equal(bitmap[0], 0xc0000000U);
+	assert_int_equal(bitmap[1], 0xffffffffU);
+	assert_int_equal(bitmap[2], 0x3U);
+}
+
+static void test_bitmap_update_when_clear_31_bits_from_1_then_bit_0_set(void **state)
+{
+	(void)state;
+
+	uint32_t bitmap[1] = {0xffffffffU};
+
+	bitmap_update(bitmap, 1, 31, 0);
+
+	assert_int_equal(bitmap[0], 0x1U);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_bitmap_update_when_set_31_bits_from_0_then_bit_31_clear),
+		cmocka_unit_test(test_bitmap_update_when_set_31_bits_from_1_then_bit_0_clear),
+		cmocka_unit_test(test_bitmap_update_when_set_bit_31_then_only_bit_31_set),
+		cmocka_unit_test(test_bitmap_update_when_set_32_bits_then_word_full),
+		cmocka_unit_test(test_bitmap_update_when_set_across_words_then_both_words_set),
+		cmocka_unit_test(test_bitmap_update_when_clear_31_bits_from_1_then_bit_0_set),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of the Intel Corporation nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sof/ipc.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#define HDR_SIZE	sizeof(struct sof_ipc_hdr)
+
+/* data is word aligned like the compound message buffer */
+static uint32_t data[64];
+
+static void put_hdr(uint32_t offset, uint32_t cmd, uint32_t size)
+{
+	struct sof_ipc_hdr hdr = { .cmd = cmd, .size = size };
+
+	memcpy((uint8_t *)data + offset, &hdr, sizeof(hdr));
+}
+
+static void test_ipc_compound_msg_when_valid_then_hdr(void **state)
+{
+	(void)state;
+
+	put_hdr(0, SOF_IPC_GLB_TPLG_MSG, 16);
+	put_hdr(16, SOF_IPC_GLB_TPLG_MSG, HDR_SIZE);
+
+	assert_ptr_equal(ipc_compound_msg((uint8_t *)data, 16 + HDR_SIZE, 0),
+			 data);
+	assert_ptr_equal(ipc_compound_msg((uint8_t *)data, 16 + HDR_SIZE, 16),
+			 (uint8_t *)data + 16);
+}
+
+static void test_ipc_compound_msg_when_hdr_truncated_then_null(void **state)
+{
+	(void)state;
+
+	put_hdr(0, SOF_IPC_GLB_TPLG_MSG, HDR_SIZE);
+
+	/* header only partly in data */
+	assert_null(ipc_compound_msg((uint8_t *)data, HDR_SIZE - 1, 0));
+	assert_null(ipc_compound_msg((uint8_t *)data, HDR_SIZE + 4, 8));
+}
+
+static void test_ipc_compound_msg_when_offset_at_end_then_null(void **state)
+{
+	(void)state;
+
+	assert_null(ipc_compound_msg((uint8_t *)data, 16, 16));
+	assert_null(ipc_compound_msg((uint8_t *)data, 16, 20));
+}
+
+static void test_ipc_compound_msg_when_size_too_small_then_null(void **state)
+{
+	(void)state;
+
+	put_hdr(0, SOF_IPC_GLB_TPLG_MSG, HDR_SIZE - 1);
+
+	assert_null(ipc_compound_msg((uint8_t *)data, sizeof(data), 0));
+}
+
+static void test_ipc_compound_msg_when_size_past_end_then_null(void **state)
+{
+	(void)state;
+
+	put_hdr(0, SOF_IPC_GLB_TPLG_MSG, 32);
+
+	assert_null(ipc_compound_msg((uint8_t *)data, 28, 0));
+	assert_non_null(ipc_compound_msg((uint8_t *)data, 32, 0));
+}
+
+static void test_ipc_compound_msg_when_size_over_max_then_null(void **state)
+{
+	(void)state;
+
+	put_hdr(0, SOF_IPC_GLB_TPLG_MSG, SOF_IPC_MSG_MAX_SIZE + 4);
+
+	assert_null(ipc_compound_msg((uint8_t *)data, sizeof(data), 0));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_ipc_compound_msg_when_valid_then_hdr),
+		cmocka_unit_test
+			(test_ipc_compound_msg_when_hdr_truncated_then_null),
+		cmocka_unit_test
+			(test_ipc_compound_msg_when_offset_at_end_then_null),
+		cmocka_unit_test
+			(test_ipc_compound_msg_when_size_too_small_then_null),
+		cmocka_unit_test
+			(test_ipc_compound_msg_when_size_past_end_then_null),
+		cmocka_unit_test
+			(test_ipc_compound_msg_when_size_over_max_then_null),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}